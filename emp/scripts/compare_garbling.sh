@@ -0,0 +1,48 @@
+#!/bin/bash
+set -e
+
+# Runs xtabs and hist2d under half-gates and three-halves garbling and
+# reports the global data sent and execution time of each
+
+usage() {
+    echo "Usage: $0 [-i <input_size>] [-n <num_runs>]"
+}
+
+input_size=1000
+num_runs=1
+
+while getopts "i:n:" opt; do
+    case $opt in
+        i)  input_size=$OPTARG ;;
+        n)  num_runs=$OPTARG ;;
+        \?) echo "Invalid flag"; usage; exit 1 ;;
+        :)  echo "Option -$OPTARG requires an argument"; usage; exit 1 ;;
+    esac
+done
+
+script_dir=$(dirname "$0")
+
+run() {
+    local garbling=$1
+    shift
+    local total_time=0
+    local output
+    for ((i=1; i<=num_runs; i++))
+    do
+        output=$("$script_dir/run.sh" -i "$input_size" -g "$garbling" "$@" 2>&1)
+        execution_time=$(echo "$output" | grep -oP 'Execution time: \K[0-9.]+' | tail -n 1)
+        total_time=$(echo "$total_time $execution_time" | awk '{print $1 + $2}')
+    done
+    avg_time=$(echo "$total_time $num_runs" | awk '{print $1 / $2}')
+    data_sent=$(echo "$output" | grep -oP 'Global data sent: \K[0-9.e+-]+')
+    printf "%-16s %-12s %12s MB %10s ms\n" "$*" "$garbling" "$data_sent" "$avg_time"
+}
+
+printf "%-16s %-12s %15s %13s\n" "program" "garbling" "data sent" "time"
+for args in "xtabs s 2" "xtabs a 2" "xtabs m 2" "hist2d i" "hist2d f"
+do
+    for garbling in halfgates threehalves
+    do
+        run $garbling $args
+    done
+done
@@ -0,0 +1,55 @@
+#!/bin/bash
+set -e
+
+# Runs input-heavy xtabs programs with IKNP and Ferret OT extension for
+# Bob's inputs and reports the global data sent and execution time of each.
+# Ferret's setup (base OTs and the first extension of ~10M COTs) runs in
+# setup_semi_honest, before the timed part.
+
+usage() {
+    echo "Usage: $0 [-i <input_size>] [-n <num_runs>]"
+}
+
+input_size=1000
+num_runs=1
+
+while getopts "i:n:" opt; do
+    case $opt in
+        i)  input_size=$OPTARG ;;
+        n)  num_runs=$OPTARG ;;
+        \?) echo "Invalid flag"; usage; exit 1 ;;
+        :)  echo "Option -$OPTARG requires an argument"; usage; exit 1 ;;
+    esac
+done
+
+script_dir=$(dirname "$0")
+
+run() {
+    local ot=$1
+    shift
+    local total_time=0
+    local total_wall=0
+    local output
+    for ((i=1; i<=num_runs; i++))
+    do
+        local start=$(date +%s%N)
+        output=$("$script_dir/run.sh" -i "$input_size" -o "$ot" "$@" 2>&1)
+        local end=$(date +%s%N)
+        execution_time=$(echo "$output" | grep -oP 'Execution time: \K[0-9.]+' | tail -n 1)
+        total_time=$(echo "$total_time $execution_time" | awk '{print $1 + $2}')
+        total_wall=$(echo "$total_wall $start $end" | awk '{print $1 + ($3 - $2) / 1000000}')
+    done
+    avg_time=$(echo "$total_time $num_runs" | awk '{print $1 / $2}')
+    avg_wall=$(echo "$total_wall $num_runs" | awk '{printf "%.0f", $1 / $2}')
+    data_sent=$(echo "$output" | grep -oP 'Global data sent: \K[0-9.e+-]+')
+    printf "%-16s %-8s %12s MB %10s ms %10s ms\n" "$*" "$ot" "$data_sent" "$avg_time" "$avg_wall"
+}
+
+printf "%-16s %-8s %15s %13s %13s\n" "program" "ot" "data sent" "time" "with setup"
+for args in "xtabs s 2" "xtabs f 2" "hist2d i"
+do
+    for ot in iknp ferret
+    do
+        run $ot $args
+    done
+done
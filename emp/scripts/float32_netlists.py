@@ -0,0 +1,195 @@
+"""Builds and inspects emp-tool/circuits/files/float32.bin, the float32
+netlists that emp-tool/circuits/float32.cpp embeds.
+
+The netlists are kept in Bristol format, one file per operation, named
+float32_<op>.txt as in OPS below: "num_gate num_wire", "n1 n2 n3", then one
+gate per line ("2 1 in1 in2 out AND|XOR" or "1 1 in out INV"). They can be
+loaded with BristolFormat for review or testing.
+
+  encode <netlist_dir> <float32.bin>   writes float32.bin from the netlists
+  decode <float32.bin> <netlist_dir>   writes the netlists of a float32.bin
+  from-cpp <cpp_dir> <netlist_dir>     converts the float32_<op>.cpp gate
+                                       arrays that float32.bin replaced
+
+The netlists came from those float32_<op>.cpp files, which are in the
+history of emp-tool (git log -- emp-tool/circuits/float32_add.cpp); encode
+reproduces float32.bin from them exactly.
+"""
+import argparse, os, re, sys
+
+MAGIC = b"EMPF32\0\1"
+# In the order of the enum in float32.cpp
+OPS = ["add", "sub", "mul", "div", "eq", "le", "leq", "sq", "sqrt",
+       "sin", "cos", "exp", "exp2", "ln", "log2"]
+AND, XOR, NOT = 0, 1, 2
+FLOAT_LEN = 32
+
+
+class Netlist:
+    def __init__(self, n1, n2, n3, gates):
+        self.n1, self.n2, self.n3 = n1, n2, n3
+        # (in1, in2, out, type), in2 0 for NOT as in execute_circuit
+        self.gates = gates
+
+    @property
+    def num_input(self):
+        return self.n1 + self.n2
+
+    @property
+    def num_wire(self):
+        return self.num_input + len(self.gates)
+
+    def check(self, name):
+        """float32.bin leaves outputs implicit: gate i writes wire num_input + i"""
+        for i, (a, b, out, t) in enumerate(self.gates):
+            if out != self.num_input + i:
+                sys.exit(f"{name}: gate {i} writes wire {out}, not {self.num_input + i}")
+            if t not in (AND, XOR, NOT):
+                sys.exit(f"{name}: gate {i} has type {t}")
+            if not 0 <= a < out or (t != NOT and not 0 <= b < out):
+                sys.exit(f"{name}: gate {i} reads a wire it does not follow")
+
+
+def write_varint(out, v):
+    while True:
+        byte = v & 0x7f
+        v >>= 7
+        if v:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return
+
+
+def read_varint(data, pos):
+    res, shift = 0, 0
+    while pos < len(data):
+        byte = data[pos]
+        pos += 1
+        res |= (byte & 0x7f) << shift
+        if not byte & 0x80:
+            return res, pos
+        shift += 7
+    sys.exit("truncated float32.bin")
+
+
+def encode(netlists):
+    out = bytearray(MAGIC)
+    write_varint(out, len(netlists))
+    for op, n in zip(OPS, netlists):
+        n.check(op)
+        write_varint(out, n.num_input)
+        write_varint(out, n.n3)
+        write_varint(out, len(n.gates))
+        for a, b, o, t in n.gates:
+            out.append(t)
+            write_varint(out, o - a)
+            if t != NOT:
+                write_varint(out, o - b)
+    return bytes(out)
+
+
+def decode(data):
+    if data[:8] != MAGIC:
+        sys.exit("not a float32.bin")
+    count, pos = read_varint(data, 8)
+    if count != len(OPS):
+        sys.exit(f"{count} netlists, expected {len(OPS)}")
+    res = []
+    for _ in OPS:
+        num_input, pos = read_varint(data, pos)
+        num_output, pos = read_varint(data, pos)
+        num_gate, pos = read_varint(data, pos)
+        gates = []
+        for i in range(num_gate):
+            if pos >= len(data):
+                sys.exit("truncated float32.bin")
+            out, t = num_input + i, data[pos]
+            pos += 1
+            d, pos = read_varint(data, pos)
+            b = 0
+            if t != NOT:
+                d2, pos = read_varint(data, pos)
+                b = out - d2
+            gates.append((out - d, b, out, t))
+        n2 = num_input - FLOAT_LEN
+        res.append(Netlist(num_input - n2, n2, num_output, gates))
+    if pos != len(data):
+        sys.exit("trailing bytes in float32.bin")
+    return res
+
+
+def write_bristol(path, n):
+    with open(path, "w") as f:
+        f.write(f"{len(n.gates)} {n.num_wire}\n{n.n1} {n.n2} {n.n3}\n\n")
+        for a, b, o, t in n.gates:
+            if t == NOT:
+                f.write(f"1 1 {a} {o} INV\n")
+            else:
+                f.write(f"2 1 {a} {b} {o} {'AND' if t == AND else 'XOR'}\n")
+
+
+def read_bristol(path):
+    with open(path) as f:
+        tokens = f.read().split()
+    num_gate, num_wire, n1, n2, n3 = map(int, tokens[:5])
+    pos, gates = 5, []
+    for _ in range(num_gate):
+        if tokens[pos] == "1":
+            a, o, name = int(tokens[pos + 2]), int(tokens[pos + 3]), tokens[pos + 4]
+            if name != "INV":
+                sys.exit(f"{path}: unknown gate {name}")
+            gates.append((a, 0, o, NOT))
+            pos += 5
+        else:
+            a, b, o, name = int(tokens[pos + 2]), int(tokens[pos + 3]), int(tokens[pos + 4]), tokens[pos + 5]
+            if name not in ("AND", "XOR"):
+                sys.exit(f"{path}: unknown gate {name}")
+            gates.append((a, b, o, AND if name == "AND" else XOR))
+            pos += 6
+    n = Netlist(n1, n2, n3, gates)
+    if n.num_wire != num_wire:
+        sys.exit(f"{path}: {num_wire} wires, expected {n.num_wire}")
+    return n
+
+
+def read_cpp(path):
+    """The gate array and the execute_float32_circuit call of a float32_<op>.cpp"""
+    with open(path) as f:
+        text = f.read()
+    body = re.search(r"gates\[\] = \{(.*?)\};", text, re.S).group(1)
+    v = [int(x) for x in re.findall(r"\d+", body)]
+    gates = [tuple(v[i:i + 4]) for i in range(0, len(v), 4)]
+    call = re.search(r"execute_float32_circuit\([^,]+, (\d+), value\.data\(\), (\S+), gates, [^,]+, (\d+)\)", text)
+    num_output, unary, num_wire = int(call.group(1)), call.group(2) == "nullptr", int(call.group(3))
+    n = Netlist(FLOAT_LEN, 0 if unary else FLOAT_LEN, num_output, gates)
+    if n.num_wire != num_wire:
+        sys.exit(f"{path}: {num_wire} wires, expected {n.num_wire}")
+    return n
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", choices=["encode", "decode", "from-cpp"])
+    parser.add_argument("src")
+    parser.add_argument("dst")
+    args = parser.parse_args()
+
+    if args.command == "encode":
+        netlists = [read_bristol(os.path.join(args.src, f"float32_{op}.txt")) for op in OPS]
+        with open(args.dst, "wb") as f:
+            f.write(encode(netlists))
+        return
+    if args.command == "decode":
+        with open(args.src, "rb") as f:
+            netlists = decode(f.read())
+    else:
+        netlists = [read_cpp(os.path.join(args.src, f"float32_{op}.cpp")) for op in OPS]
+    os.makedirs(args.dst, exist_ok=True)
+    for op, n in zip(OPS, netlists):
+        n.check(op)
+        write_bristol(os.path.join(args.dst, f"float32_{op}.txt"), n)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+#!/bin/bash
+set -e
+
+# Dumps the circuits of the example programs in Bristol format, runs the
+# optimizer on them and reports the AND gates before and after
+
+usage() {
+    echo "Usage: $0 [-i <input_size>] [-o <output_dir>]"
+}
+
+input_size=100
+output_dir=circuits
+
+while getopts "i:o:" opt; do
+    case $opt in
+        i)  input_size=$OPTARG ;;
+        o)  output_dir=$OPTARG ;;
+        \?) echo "Invalid flag"; usage; exit 1 ;;
+        :)  echo "Option -$OPTARG requires an argument"; usage; exit 1 ;;
+    esac
+done
+
+script_dir=$(dirname "$0")
+mkdir -p "$output_dir"
+
+optimize() {
+    local name=$(echo "$*" | tr ' ' '_')
+    EMP_DUMP_CIRCUIT="$output_dir/$name.txt" "$script_dir/run.sh" -i "$input_size" "$@" > /dev/null 2>&1
+    output=$(./build/bin/optimize_circuit "$output_dir/$name.txt" "$output_dir/${name}_opt.txt")
+    and_gates=$(echo "$output" | grep -oP 'AND gates: \K.*')
+    printf "%-16s %s\n" "$*" "$and_gates"
+}
+
+printf "%-16s %s\n" "program" "AND gates (before -> after)"
+for args in "xtabs s 1" "xtabs s 2" "xtabs a 2" "xtabs v 2" "xtabs m 2" "xtabs f 2" "linreg" "hist2d i" "hist2d f"
+do
+    optimize $args
+done
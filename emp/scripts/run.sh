@@ -33,15 +33,25 @@ alice=false
 bob=false
 address=127.0.0.1
 input_size=1000
+garbling=halfgates
+ot=iknp
+precompute=0
+ot_store=
+profile=
 
 usage() {
-    echo "Usage: $0 [-a] [-b <alice_address>] [-i <input_size>] <program_name> [<args>]"
+    echo "Usage: $0 [-a] [-b <alice_address>] [-i <input_size>] [-g <garbling>] [-o <ot>] [-c] [-s <dir>] [-p <file>] <program_name> [<args>]"
     echo ""
     echo "Options:"
     echo "  -a                Run as Alice"
     echo "  -b <address>      Run as Bob (connect to Alice at <address>)"
     echo "  -a -b             Run both Alice and Bob (default if no options are given)"
     echo "  -i <input_size>   Set the input size (default: $input_size)"
+    echo "  -g <garbling>     Set the garbling scheme, halfgates or threehalves (default: $garbling)"
+    echo "  -o <ot>           Set the OT extension for Bob's inputs, iknp or ferret (default: $ot)"
+    echo "  -c                Precompute the OTs for Bob's inputs in a background thread"
+    echo "  -s <dir>          Keep the OT state in <dir> so that the next run with the same peer skips the base OTs"
+    echo "  -p <file>         Print gates, communication and time per profiled region, and write them as JSON to <file>"
     echo ""
     echo "Programs:"
     echo "  millionaire                                                             Secure comparison of two numbers"
@@ -67,11 +77,16 @@ build_command() {
     fi
 }
 
-while getopts "ab:i:" opt; do
+while getopts "ab:i:g:o:cs:p:" opt; do
     case $opt in
         a)  alice=true ;;
         b)  bob=true; address=$OPTARG; echo "Address set to $address" ;;
         i)  input_size=$OPTARG; echo "Input size set to $input_size" ;;
+        g)  garbling=$OPTARG; echo "Garbling scheme set to $garbling" ;;
+        o)  ot=$OPTARG; echo "OT extension set to $ot" ;;
+        c)  precompute=1; echo "OT precomputation in the background" ;;
+        s)  ot_store=$OPTARG; echo "OT state kept in $ot_store" ;;
+        p)  profile=$OPTARG; echo "Profile written to $profile" ;;
         \?) echo "Invalid flag"; usage; exit 1 ;;
         :)  echo "Option -$OPTARG requires an argument"; usage; exit 1 ;;
     esac
@@ -79,6 +94,15 @@ done
 
 shift $((OPTIND -1))
 
+# Both parties must garble with the same scheme
+export EMP_GARBLING=$garbling
+export EMP_OT=$ot
+export EMP_PRECOMPUTE=$precompute
+export EMP_OT_STORE=$ot_store
+if [ -n "$profile" ]; then
+    export EMP_PROFILE=$profile
+fi
+
 program=$1
 
 if [ -z "$program" ]; then
@@ -15,6 +15,11 @@ class OTCO: public OT<IO> { public:
 	IO* io;
 	Group *G = nullptr;
 	bool delete_G = true;
+#ifdef EMP_HAS_P256
+	// Run on the P-256 code of p256.h instead of the OpenSSL Group; the
+	// messages are the same, so either side can use either one
+	bool use_p256 = true;
+#endif
 	OTCO(IO* io, Group * _G = nullptr) {
 		this->io = io;
 		if (_G == nullptr)
@@ -30,6 +35,10 @@ class OTCO: public OT<IO> { public:
 	}
 
 	void send(const block* data0, const block* data1, int64_t length) override {
+#ifdef EMP_HAS_P256
+		if(use_p256)
+			return send_p256(data0, data1, length);
+#endif
 		BigInt a;
 		Point A, AaInv;
 		block res[2];
@@ -60,6 +69,10 @@ class OTCO: public OT<IO> { public:
 	}
 
 	void recv(block* data, const bool* b, int64_t length) override {
+#ifdef EMP_HAS_P256
+		if(use_p256)
+			return recv_p256(data, b, length);
+#endif
 		BigInt * bb = new BigInt[length];
 		Point * B = new Point[length],
 				* As = new Point[length],
@@ -95,6 +108,106 @@ class OTCO: public OT<IO> { public:
 		delete[] B;
 		delete[] As;
 	}
+
+#ifdef EMP_HAS_P256
+	/*
+	 * The generator, and A on the receiver, go through fixed-base tables;
+	 * the sender multiplies A and all B[i] by a in one batch. Points are
+	 * turned to affine all at once before they are sent or hashed.
+	 */
+	void send_p256(const block* data0, const block* data1, int64_t length) {
+		PRG prg;
+		P256Scalar a;
+		p256_rand_scalar(a, prg);
+		// A, then the B[i]
+		std::vector<P256Affine> pts(length + 1);
+		std::vector<P256Point> aB(length + 1);
+		p256_generator().mul(aB[0], a);
+		p256_normalize(&pts[0], &aB[0], 1);
+		send_pts(&pts[0], 1);
+		recv_pts(&pts[1], length);
+		io->flush();
+
+		p256_mul(aB.data(), pts.data(), length + 1, a);
+		P256Affine AaInv;
+		p256_normalize(&AaInv, &aB[0], 1);
+		p256_fe_neg(AaInv.y, AaInv.y);
+		std::vector<P256Point> keys(2*length);
+		for(int64_t i = 0; i < length; ++i) {
+			keys[2*i] = aB[i+1];
+			p256_add(keys[2*i+1], aB[i+1], AaInv);
+		}
+		std::vector<P256Affine> keys_aff(2*length);
+		p256_normalize(keys_aff.data(), keys.data(), 2*length);
+
+		block res[2];
+		unsigned char buf[P256_POINT_SIZE];
+		for(int64_t i = 0; i < length; ++i) {
+			res[0] = Hash::KDF(buf, p256_encode(buf, keys_aff[2*i]), i) ^ data0[i];
+			res[1] = Hash::KDF(buf, p256_encode(buf, keys_aff[2*i+1]), i) ^ data1[i];
+			io->send_data(res, 2*sizeof(block));
+		}
+	}
+
+	void recv_p256(block* data, const bool* b, int64_t length) {
+		PRG prg;
+		std::vector<P256Scalar> bb(length);
+		for(int64_t i = 0; i < length; ++i)
+			p256_rand_scalar(bb[i], prg);
+
+		P256Affine A;
+		recv_pts(&A, 1);
+
+		std::vector<P256Point> pts(length);
+		std::vector<P256Affine> aff(length);
+		p256_generator().mul(pts.data(), bb.data(), length);
+		for(int64_t i = 0; i < length; ++i) {
+			P256Point BA;
+			p256_madd(BA, pts[i], A);
+			p256_point_cmov(pts[i], BA, (uint64_t)0 - b[i]);
+		}
+		p256_normalize(aff.data(), pts.data(), length);
+		send_pts(aff.data(), length);
+		io->flush();
+
+		P256Table(A).mul(pts.data(), bb.data(), length);
+		p256_normalize(aff.data(), pts.data(), length);
+
+		block res[2];
+		unsigned char buf[P256_POINT_SIZE];
+		for(int64_t i = 0; i < length; ++i) {
+			io->recv_data(res, 2*sizeof(block));
+			data[i] = Hash::KDF(buf, p256_encode(buf, aff[i]), i);
+			if(b[i])
+				data[i] = data[i] ^ res[1];
+			else
+				data[i] = data[i] ^ res[0];
+		}
+	}
+
+	// Points in the format of IOChannel::send_pt/recv_pt
+	void send_pts(const P256Affine * pts, int64_t n) {
+		unsigned char buf[P256_POINT_SIZE];
+		for(int64_t i = 0; i < n; ++i) {
+			uint32_t len = p256_encode(buf, pts[i]);
+			io->send_data(&len, 4);
+			io->send_data(buf, len);
+		}
+	}
+
+	void recv_pts(P256Affine * pts, int64_t n) {
+		unsigned char buf[P256_POINT_SIZE];
+		for(int64_t i = 0; i < n; ++i) {
+			uint32_t len = 0;
+			io->recv_data(&len, 4);
+			if(len != P256_POINT_SIZE)
+				error("invalid point");
+			io->recv_data(buf, len);
+			if(!p256_decode(pts[i], buf, len))
+				error("invalid point");
+		}
+	}
+#endif
 };
 
 }//namespace
@@ -9,7 +9,7 @@ FerretCOT<T>::FerretCOT(int party, int threads, T **ios,
 	one = makeBlock(0xFFFFFFFFFFFFFFFFLL,0xFFFFFFFFFFFFFFFELL);
 	ch[0] = zero_block;
 	base_cot = new BaseCot<T>(party, io, malicious);
-	pool = new ThreadPool(threads);
+	pool = new WorkStealingPool(threads - 1);
 	this->param = param;
 
 	this->extend_initialized = false;
@@ -42,7 +42,7 @@ FerretCOT<T>::~FerretCOT() {
 
 template<typename T>
 void FerretCOT<T>::extend_initialization() {
-	lpn_f2 = new LpnF2<T, 10>(party, param.n, param.k, pool, io, pool->size());
+	lpn_f2 = new LpnF2<T, 10>(party, param.n, param.k, pool, io);
 	mpcot = new MpcotReg<T>(party, threads, param.n, param.t, param.log_bin_sz, pool, ios);
 	if(is_malicious) mpcot->set_malicious();
 
@@ -120,7 +120,7 @@ void FerretCOT<T>::setup(std::string pre_file, bool *choice, block seed) {
 		MpcotReg<T> mpcot_ini(party, threads, param.n_pre, param.t_pre, param.log_bin_sz_pre, pool, ios);
 		if(is_malicious) mpcot_ini.set_malicious();
 		OTPre<T> pre_ot_ini(ios[0], mpcot_ini.tree_height-1, mpcot_ini.tree_n);
-		LpnF2<T, 10> lpn(party, param.n_pre, param.k_pre, pool, io, pool->size());
+		LpnF2<T, 10> lpn(party, param.n_pre, param.k_pre, pool, io);
 
 		block *pre_data_ini = new block[param.k_pre+mpcot_ini.consist_check_cot_num];
 		memset(this->ot_pre_data, 0, param.n_pre*16);
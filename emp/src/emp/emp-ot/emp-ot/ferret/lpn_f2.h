@@ -10,17 +10,18 @@ template<typename IO, int d = 10>
 class LpnF2 { public:
 	int party;
 	int64_t n;
-	ThreadPool * pool;
+	WorkStealingPool * pool;
 	IO *io;
-	int threads, k, mask;
+	int k, mask;
 	block seed;
-	LpnF2 (int party, int64_t n, int k, ThreadPool * pool, IO *io, int threads) {
+	// Rows per task; fixed, as the rows a task computes depend on where it starts
+	static const int64_t chunk = 1 << 14;
+	LpnF2 (int party, int64_t n, int k, WorkStealingPool * pool, IO *io) {
 		this->party = party;
 		this->k = k;
 		this->n = n;
 		this->pool = pool;
 		this->io = io;
-		this->threads = threads;
 		mask = 1;
 		while(mask < k) {
 			mask <<=1;
@@ -64,22 +65,9 @@ class LpnF2 { public:
 	}
 
 	void compute(block * nn, const block * kk, block s = zero_block) {
-		vector<std::future<void>> fut;
-		int64_t width = n/threads;
         if(!cmpBlock(&s, &zero_block, 1)) seed = s;
 		else seed = seed_gen();
-		for(int i = 0; i < threads - 1; ++i) {
-			int64_t start = i * width;
-			int64_t end = min((i+1)* width, n);
-			fut.push_back(pool->enqueue([this, nn, kk, start, end]() {
-				task(nn, kk, start, end);
-			}));
-		}
-		int64_t start = (threads - 1) * width;
-        	int64_t end = n;
-		task(nn, kk, start, end);
-
-		for (auto &f: fut) f.get();
+		bench(nn, kk);
 	}
 
 	block seed_gen() {
@@ -94,20 +82,9 @@ class LpnF2 { public:
 		return seed;
 	}
 	void bench(block * nn, const block * kk) {
-		vector<std::future<void>> fut;
-		int64_t width = n/threads;
-		for(int i = 0; i < threads - 1; ++i) {
-			int64_t start = i * width;
-			int64_t end = min((i+1)* width, n);
-			fut.push_back(pool->enqueue([this, nn, kk, start, end]() {
-				task(nn, kk, start, end);
-			}));
-		}
-		int64_t start = (threads - 1) * width;
-        	int64_t end = n;
-		task(nn, kk, start, end);
-
-		for (auto &f: fut) f.get();
+		pool->parallel_for(n, chunk, [this, nn, kk](int64_t start, int64_t end) {
+			task(nn, kk, start, end);
+		});
 	}
 
 };
@@ -25,12 +25,12 @@ public:
 	IO **ios;
 	block Delta_f2k;
 	block *consist_check_chi_alpha = nullptr, *consist_check_VW = nullptr;
-	ThreadPool *pool;
+	WorkStealingPool *pool;
 	
 	std::vector<uint32_t> item_pos_recver;
 	GaloisFieldPacking pack;
 
-	MpcotReg(int party, int threads, int n, int t, int log_bin_sz, ThreadPool * pool, IO **ios) {
+	MpcotReg(int party, int threads, int n, int t, int log_bin_sz, WorkStealingPool * pool, IO **ios) {
 		this->party = party;
 		this->threads = threads;
 		netio = ios[0];
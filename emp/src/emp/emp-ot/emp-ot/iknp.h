@@ -21,21 +21,19 @@ class IKNP: public COT<T> { public:
 	using COT<T>::Delta;
 
 	OTCO<T> * base_ot = nullptr;
-	bool setup = false, *extended_r = nullptr;
+	bool setup = false;
 
 	const static int64_t block_size = 1024*2;
 	block local_out[block_size];
-	bool s[128], local_r[256];
+	bool s[128];
+	// Choice bits of the extra COTs of the malicious check
+	BitVector local_r = BitVector(256);
 	PRG prg, G0[128], G1[128];
 	bool malicious = false;
 	block k0[128], k1[128]; 
 	IKNP(T * io, bool malicious = false): malicious(malicious) {
 		this->io = io;
 	}
-	~IKNP() {
-		delete_array_null(extended_r);
-	}
-
 	void setup_send(const bool* in_s = nullptr, block * in_k0 = nullptr) {
 		setup = true;
 		if(in_s == nullptr)
@@ -98,24 +96,29 @@ class IKNP: public COT<T> { public:
 			if (s[i])
 				xorBlocks_arr(t+(i*block_size/128), t+(i*block_size/128), tmp+(i*local_block_size/128), local_block_size/128);
 		}
-		sse_trans((uint8_t *)(out), (uint8_t*)t, 128, block_size);
+		bit_trans((uint8_t *)(out), (uint8_t*)t, 128, block_size);
 	}
 
 	void recv_pre(block * out, const bool* r, int64_t length) {
+		BitVector packed;
+		packed.from_bools(r, length);
+		recv_pre(out, packed, length);
+	}
+
+	// The first length bits of r are the choice bits, 128 to a block as sent
+	void recv_pre(block * out, const BitVector & r, int64_t length) {
 		if(not setup)
 			setup_recv();
-
-		block *block_r = new block[(length+127)/128];
-		for(int64_t i = 0; i < length/128; ++i)
-			block_r[i] = bool_to_block(r+i*128);
-		if (length%128 != 0) {
-			bool tmp_bool_array[128];
-			memset(tmp_bool_array, 0, 128);
-			int64_t start_point = (length / 128)*128;
-			memcpy(tmp_bool_array, r+start_point, length % 128);
-			block_r[length/128] = bool_to_block(tmp_bool_array);
+		if((int64_t)r.size() < length)
+			error("too few choice bits");
+		// bits past length would go out in the unused columns
+		BitVector trimmed;
+		if((int64_t)r.size() != length) {
+			trimmed.resize(length);
+			trimmed.copy(0, r, 0, length);
 		}
-		
+		const block * block_r = (int64_t)r.size() != length ? trimmed.blocks() : r.blocks();
+
 		int64_t j = 0;
 		for (; j < length/block_size; ++j)
 			recv_pre_block(out+j*block_size, block_r + (j*block_size/128), block_size);
@@ -125,15 +128,11 @@ class IKNP: public COT<T> { public:
 			memcpy(out+j*block_size, local_out, sizeof(block)*remain);
 		}
 		if(malicious) {
-			block local_r_block[2]; 
-			prg.random_bool(local_r, 256);
-			local_r_block[0] = bool_to_block(local_r);
-			local_r_block[1] = bool_to_block(local_r + 128);
-			recv_pre_block(local_out, local_r_block, 256);
+			prg.random_bits(local_r);
+			recv_pre_block(local_out, local_r.blocks(), 256);
 		}
-		delete[] block_r;
 	}
-	void recv_pre_block(block * out, block * r, int64_t len) {
+	void recv_pre_block(block * out, const block * r, int64_t len) {
 		block t[block_size];
 		block tmp[block_size];
 		int64_t local_block_size = (len+127)/128 * 128;
@@ -145,7 +144,7 @@ class IKNP: public COT<T> { public:
 			io->send_data(tmp, local_block_size/8);
 		}
 
-		sse_trans((uint8_t *)(out), (uint8_t*)t, 128, block_size);
+		bit_trans((uint8_t *)(out), (uint8_t*)t, 128, block_size);
 	}
 
 	void send_cot(block * data, int64_t length) override{
@@ -156,6 +155,13 @@ class IKNP: public COT<T> { public:
 				error("OT Extension check failed");
 	}
 	void recv_cot(block* data, const bool * b, int64_t length) override {
+		BitVector packed;
+		packed.from_bools(b, length);
+		recv_cot(data, packed, length);
+	}
+
+	// recv_cot with the choice bits packed, as IKNP sends them
+	void recv_cot(block* data, const BitVector & b, int64_t length) {
 		recv_pre(data, b, length);
 		if(malicious)
 			recv_check(data, b, length);
@@ -202,7 +208,7 @@ class IKNP: public COT<T> { public:
 
 		return cmpBlock(q, t, 2);	
 	}
-	void recv_check(block * out, const bool* r, int64_t length) {
+	void recv_check(block * out, const BitVector & r, int64_t length) {
 		block select[2] = {zero_block, all_one_block};
 		block seed2, x = makeBlock(0,0), t[2], tmp[2];
 		prg.random_block(&seed2,1);
@@ -5,6 +5,32 @@
 using namespace std;
 using namespace emp;
 
+// The same seed gives the same encoding on every pool size, and on a busy pool
+void test_pool_sizes(const block * kk, const block * nn, int k, int n) {
+	block seed = makeBlock(1, 2);
+	vector<block> expected;
+	auto check = [&](WorkStealingPool * pool, const char * name) {
+		vector<block> out(nn, nn + n);
+		LpnF2<NetIO, 10> lpn(ALICE, n, k, pool, nullptr);
+		lpn.compute(out.data(), kk, seed);
+		if(expected.empty())
+			expected = out;
+		else if(memcmp(out.data(), expected.data(), n * sizeof(block)) != 0) {
+			cout << "LPN output differs on " << name << endl;
+			error("LPN output depends on the pool");
+		}
+	};
+	for(int threads : {0, 1, 3}) {
+		WorkStealingPool pool(threads);
+		check(&pool, (to_string(threads) + " workers").c_str());
+		if(threads > 0)
+			pool.parallel_for(2, 1, [&](int64_t b, int64_t) {
+				if(b == 0)
+					check(&pool, "a busy pool");
+			});
+	}
+}
+
 int main(int argc, char** argv) {
 	PRG prg;
 	int k, n;
@@ -26,12 +52,13 @@ int main(int argc, char** argv) {
 	prg.random_block(&seed, 1);
 	prg.random_block(kk, 1<<k);
 	prg.random_block(nn, 1<<n);
+	test_pool_sizes(kk, nn, 1<<k, 1<<min(n, 17));
 
-	ThreadPool * pool = new ThreadPool(4);
+	WorkStealingPool * pool = new WorkStealingPool(4);
 	for (int kkk = 10; kkk < k; ++kkk) {	
 		auto t1 = clock_start();
 		for (int ttt = 0; ttt < 20; ttt++) {
-			LpnF2<NetIO, 10> lpn(ALICE, 1<<n, 1<<kkk, pool, nullptr, pool->size());
+			LpnF2<NetIO, 10> lpn(ALICE, 1<<n, 1<<kkk, pool, nullptr);
 			lpn.bench(nn, kk);
 			kk[0] = nn[0];
 		}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include "emp-tool/emp-tool.h"
+#include "emp-ot/emp-ot.h"
+using namespace std;
+using namespace emp;
+
+const char * kernel_name[] = {"sse", "avx2", "avx512"};
+
+// Checks a kernel against sse_trans on a random nrows x ncols matrix
+void check(TransKernel kernel, uint64_t nrows, uint64_t ncols) {
+	PRG prg;
+	vector<uint8_t> in(nrows*ncols/8), expected(nrows*ncols/8), out(nrows*ncols/8);
+	prg.random_data(in.data(), in.size());
+	sse_trans(expected.data(), in.data(), nrows, ncols);
+	bit_trans(out.data(), in.data(), nrows, ncols, kernel);
+	if(out != expected)
+		error("transpose mismatch");
+}
+
+int main(int argc, char** argv) {
+	int runs = argc > 1 ? atoi(argv[1]) : 20000;
+	TransKernel best = trans_kernel();
+	cout << "CPU kernel: " << kernel_name[best] << endl;
+
+	// The shape of an IKNP block, a larger one, and shapes the wide kernels leave to sse_trans
+	uint64_t shapes[][2] = {{128, IKNP<NetIO>::block_size}, {1024, 4096}, {128, 384}, {136, 2048}, {8, 24}};
+	for(int k = TRANS_SSE; k <= best; ++k)
+		for(auto & s : shapes)
+			check((TransKernel)k, s[0], s[1]);
+	cout << "all kernels match sse_trans" << endl;
+
+	uint64_t nrows = 128, ncols = IKNP<NetIO>::block_size;
+	vector<block> in(nrows*ncols/128), out(nrows*ncols/128);
+	PRG prg;
+	prg.random_block(in.data(), in.size());
+	double base = 0;
+	for(int k = TRANS_SSE; k <= best; ++k) {
+		auto start = clock_start();
+		for(int i = 0; i < runs; ++i) {
+			bit_trans((uint8_t *)out.data(), (uint8_t *)in.data(), nrows, ncols, (TransKernel)k);
+			in[i % in.size()] ^= out[0];
+		}
+		double t = time_from(start) / runs;
+		if(k == TRANS_SSE)
+			base = t;
+		cout << kernel_name[k] << "\t" << nrows << "x" << ncols << "\t" << t*1000 << " ns\t"
+			<< nrows*ncols/8 / t << " MB/s\t" << base / t << "x" << endl;
+	}
+	return 0;
+}
@@ -18,15 +18,27 @@ int main(int argc, char** argv) {
 	IKNP<NetIO> * iknp = new IKNP<NetIO>(io);
 	cout <<"Passive IKNP OT\t"<<double(length)/test_ot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	cout <<"Passive IKNP COT\t"<<double(length)/test_cot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
+	cout <<"Passive IKNP COT, packed\t"<<double(length)/test_cot_packed<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	cout <<"Passive IKNP ROT\t"<<double(length)/test_rot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	delete iknp;
 
 	OTCO<NetIO> * co = new OTCO<NetIO>(io);
+#ifdef EMP_HAS_P256
+	co->use_p256 = false;
+	cout <<"128 COOTs, OpenSSL:\t"<<test_ot<OTCO<NetIO>>(co, io, party, 128)<<" us"<<endl;
+	co->use_p256 = true;
+	cout <<"128 COOTs, P-256:\t"<<test_ot<OTCO<NetIO>>(co, io, party, 128)<<" us"<<endl;
+	// Sender on OpenSSL and receiver on P-256
+	co->use_p256 = party == BOB;
+	cout <<"128 COOTs, mixed:\t"<<test_ot<OTCO<NetIO>>(co, io, party, 128)<<" us"<<endl;
+#else
 	cout <<"128 COOTs:\t"<<test_ot<OTCO<NetIO>>(co, io, party, 128)<<" us"<<endl;
+#endif
 	delete co;
 	iknp = new IKNP<NetIO>(io, true);
 	cout <<"Active IKNP OT\t"<<double(length)/test_ot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	cout <<"Active IKNP COT\t"<<double(length)/test_cot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
+	cout <<"Active IKNP COT, packed\t"<<double(length)/test_cot_packed<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	cout <<"Active IKNP ROT\t"<<double(length)/test_rot<IKNP<NetIO>>(iknp, io, party, length)*1e6<<" OTps"<<endl;
 	delete iknp;
 
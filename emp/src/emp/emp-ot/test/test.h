@@ -88,6 +88,45 @@ double test_cot(T * ot, NetIO *io, int party, int64_t length) {
 	return t;
 }
 
+// test_cot with the choice bits in a BitVector
+template <typename T>
+double test_cot_packed(T * ot, NetIO *io, int party, int64_t length) {
+	block *b0 = new block[length], *r = new block[length];
+	BitVector b(length);
+	block delta;
+	PRG prg;
+	prg.random_bits(b);
+
+	io->sync();
+	auto start = clock_start();
+	if (party == ALICE) {
+		ot->send_cot(b0, length);
+		delta = ot->Delta;
+	} else {
+		ot->recv_cot(r, b, length);
+	}
+	io->flush();
+	long long t = time_from(start);
+	if (party == ALICE) {
+		io->send_block(&delta, 1);
+		io->send_block(b0, length);
+	}
+	else if (party == BOB) {
+		io->recv_block(&delta, 1);
+		io->recv_block(b0, length);
+		for (int64_t i = 0; i < length; ++i) {
+			block expected = b[i] ? b0[i] ^ delta : b0[i];
+			if (!cmpBlock(&r[i], &expected, 1))
+				error("COT failed!");
+		}
+	}
+	std::cout << "Tests passed.\t";
+	io->flush();
+	delete[] b0;
+	delete[] r;
+	return t;
+}
+
 template <typename T>
 double test_rot(T* ot, NetIO *io, int party, int64_t length) {
 	block *b0 = new block[length], *r = new block[length];
@@ -1,4 +1,6 @@
 #include "emp-sh2pc/semihonest.h"
+#include "emp-sh2pc/ot_store.h"
 #include "emp-sh2pc/sh_party.h"
 #include "emp-sh2pc/sh_gen.h"
-#include "emp-sh2pc/sh_eva.h"
\ No newline at end of file
+#include "emp-sh2pc/sh_eva.h"
+#include "emp-sh2pc/sh_offline.h"
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef EMP_SH_OT_STORE_H__
+#define EMP_SH_OT_STORE_H__
+#include "emp-tool/emp-tool.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+// The last character is the version: states of another one are not taken
+const static char ot_store_magic[8] = {'E', 'M', 'P', 'O', 'T', 'S', 'T', '2'};
+
+/*
+ * COT extension state kept on disk between two runs with the same peer: the
+ * base-OT seeds of IKNP, or the reserved correlations of Ferret, which let
+ * the next run skip its base OTs. The file holds key material, so only its
+ * owner can read it, and it is removed as soon as it is read: a state is
+ * never used twice, even if the run that took it is aborted. Each run agrees
+ * on a tag for the state it leaves, and both parties use their stored states
+ * only if the tags match.
+ *
+ * The state holds Alice's COT delta, which is also the garbling delta: a run
+ * that restores it garbles with the same delta as the run that saved it. The
+ * labels of the two sessions are then correlated by the same offset, so a
+ * store should only link runs that may share a delta, e.g. of one
+ * application with one peer.
+ */
+class OTStore { public:
+	struct Header {
+		char magic[8];
+		int32_t scheme, party;
+		block tag;
+		uint64_t size;
+	};
+	std::string filename;
+
+	OTStore(const std::string & filename): filename(filename) {}
+
+	// Reads and removes the state; false if there is none for scheme and party
+	bool take(int scheme, int party, block & tag, std::vector<unsigned char> & state) {
+		FILE * f = fopen(filename.c_str(), "rb");
+		if(f == nullptr)
+			return false;
+		std::remove(filename.c_str());
+		Header h;
+		bool ok = fread(&h, sizeof(h), 1, f) == 1
+			and memcmp(h.magic, ot_store_magic, sizeof(h.magic)) == 0
+			and h.scheme == scheme and h.party == party;
+		if(ok) {
+			state.resize(h.size);
+			ok = fread(state.data(), 1, h.size, f) == h.size;
+			tag = h.tag;
+		}
+		fclose(f);
+		return ok;
+	}
+
+	/* Replaces the state, atomically and readable by the owner only: it is
+	 * written to a new file of a unique name next to filename, never one that
+	 * exists, and renamed over it
+	 */
+	void save(int scheme, int party, const block & tag, const void * state, size_t size) {
+		std::vector<char> tmp(filename.begin(), filename.end());
+		const char suffix[] = ".XXXXXX";
+		tmp.insert(tmp.end(), suffix, suffix + sizeof(suffix));
+		int fd = mkstemp(tmp.data());
+		if(fd < 0)
+			error("cannot open OT store");
+		FILE * f = fchmod(fd, 0600) == 0 ? fdopen(fd, "wb") : nullptr;
+		if(f == nullptr) {
+			close(fd);
+			std::remove(tmp.data());
+			error("cannot open OT store");
+		}
+		Header h;
+		memcpy(h.magic, ot_store_magic, sizeof(h.magic));
+		h.scheme = scheme;
+		h.party = party;
+		h.tag = tag;
+		h.size = size;
+		bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+			and fwrite(state, 1, size, f) == size
+			and fflush(f) == 0 and fsync(fd) == 0;
+		if(fclose(f) != 0 or !ok or rename(tmp.data(), filename.c_str()) != 0) {
+			std::remove(tmp.data());
+			error("cannot write OT store");
+		}
+	}
+};
+}
+#endif// EMP_SH_OT_STORE_H__
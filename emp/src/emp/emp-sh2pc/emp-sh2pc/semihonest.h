@@ -5,20 +5,85 @@
 
 namespace emp {
 
+// Garbling scheme for AND gates; THREE_HALVES sends 25 instead of 32 bytes per gate
+enum GarbleScheme { HALF_GATES, THREE_HALVES };
+
+/* ot selects the COT extension behind the evaluator's inputs; Ferret runs on
+ * ot_threads threads with one NetIO of ot_ios each (see SemiHonestParty).
+ * With ot_store, the parties skip the base OTs if they kept a matching state
+ * from their last run, and garble with its delta.
+ */
 template<typename IO>
-inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, int batch_size = 1024*16) {
+inline SemiHonestParty<IO>* setup_semi_honest(IO* io, int party, int batch_size = 1024*16, GarbleScheme scheme = HALF_GATES,
+		OTScheme ot = IKNP_OT, int ot_threads = 1, NetIO ** ot_ios = nullptr, const std::string & ot_store = "") {
 	if(party == ALICE) {
-		HalfGateGen<IO> * t = new HalfGateGen<IO>(io);
-		CircuitExecution::circ_exec = t;
-		ProtocolExecution::prot_exec = new SemiHonestGen<IO>(io, t);
+		ThreeHalvesGen<IO> * t3 = nullptr;
+		HalfGateGen<IO> * t2 = nullptr;
+		if(scheme == THREE_HALVES)
+			CircuitExecution::circ_exec = t3 = new ThreeHalvesGen<IO>(io);
+		else
+			CircuitExecution::circ_exec = t2 = new HalfGateGen<IO>(io);
+		block delta = t3 != nullptr ? t3->delta : t2->delta;
+		SemiHonestGen<IO> * gen = new SemiHonestGen<IO>(io, delta, ot, ot_threads, ot_ios, ot_store);
+		if(gen->restored) {
+			if(t3 != nullptr)
+				t3->set_delta(gen->delta);
+			else t2->set_delta(gen->delta);
+		}
+		ProtocolExecution::prot_exec = gen;
 	} else {
-		HalfGateEva<IO> * t = new HalfGateEva<IO>(io);
-		CircuitExecution::circ_exec = t;
-		ProtocolExecution::prot_exec = new SemiHonestEva<IO>(io, t);
+		ThreeHalvesEva<IO> * t3 = nullptr;
+		HalfGateEva<IO> * t2 = nullptr;
+		if(scheme == THREE_HALVES)
+			CircuitExecution::circ_exec = t3 = new ThreeHalvesEva<IO>(io);
+		else
+			CircuitExecution::circ_exec = t2 = new HalfGateEva<IO>(io);
+		SemiHonestEva<IO> * eva = new SemiHonestEva<IO>(io, ot, ot_threads, ot_ios, ot_store);
+		if(eva->restored) {
+			if(t3 != nullptr)
+				t3->set_delta();
+			else t2->set_delta();
+		}
+		ProtocolExecution::prot_exec = eva;
 	}
 	return (SemiHonestParty<IO>*)ProtocolExecution::prot_exec;
 }
 
+/* Replays a captured circuit on the backend set up by setup_semi_honest,
+ * through the devirtualized loop of the garbling scheme in use
+ */
+template<typename IO>
+inline void execute_semi_honest(const CapturedCircuit & circuit, const bool * in, bool * out) {
+	CircuitExecution * exec = CircuitExecution::circ_exec;
+	if(auto t = dynamic_cast<HalfGateGen<IO>*>(exec))
+		circuit.execute(t, in, out);
+	else if(auto t = dynamic_cast<HalfGateEva<IO>*>(exec))
+		circuit.execute(t, in, out);
+	else if(auto t = dynamic_cast<ThreeHalvesGen<IO>*>(exec))
+		circuit.execute(t, in, out);
+	else if(auto t = dynamic_cast<ThreeHalvesEva<IO>*>(exec))
+		circuit.execute(t, in, out);
+	else circuit.execute(exec, in, out);
+}
+
+/* Same, with the gates run by level; wide levels of half-gates are garbled
+ * and evaluated on the pool. Both parties must use the leveled circuit.
+ */
+template<typename IO>
+inline void execute_semi_honest(const CapturedCircuit & circuit, const LeveledCircuit & leveled,
+		const bool * in, bool * out, WorkStealingPool * pool = nullptr) {
+	CircuitExecution * exec = CircuitExecution::circ_exec;
+	if(auto t = dynamic_cast<HalfGateGen<IO>*>(exec))
+		leveled.execute(circuit, t, in, out, pool);
+	else if(auto t = dynamic_cast<HalfGateEva<IO>*>(exec))
+		leveled.execute(circuit, t, in, out, pool);
+	else if(auto t = dynamic_cast<ThreeHalvesGen<IO>*>(exec))
+		leveled.execute(circuit, t, in, out, pool);
+	else if(auto t = dynamic_cast<ThreeHalvesEva<IO>*>(exec))
+		leveled.execute(circuit, t, in, out, pool);
+	else leveled.execute(circuit, exec, in, out, pool);
+}
+
 inline void finalize_semi_honest() {
 	delete CircuitExecution::circ_exec;
 	delete ProtocolExecution::prot_exec;
@@ -5,20 +5,14 @@
 namespace emp {
 template<typename IO>
 class SemiHonestEva: public SemiHonestParty<IO> { public:
-	HalfGateEva<IO> * gc;
-	PRG prg;
-	SemiHonestEva(IO *io, HalfGateEva<IO> * gc): SemiHonestParty<IO>(io, BOB) {
-		this->gc = gc;	
-		this->ot->setup_recv();
+	SemiHonestEva(IO *io, OTScheme scheme = IKNP_OT, int threads = 1, NetIO ** ot_ios = nullptr,
+			const std::string & ot_store = "")
+		: SemiHonestParty<IO>(io, BOB, scheme, threads, ot_ios, ot_store) {
+		this->setup_ot();
 		block seed; this->io->recv_block(&seed, 1);
 		this->shared_prg.reseed(&seed);
-		refill();
-	}
-
-	void refill() {
-		prg.random_bool(this->buff, this->batch_size);
-		this->ot->recv_cot(this->buf, this->buff, this->batch_size);
-		this->top = 0;
+		if(this->top == this->batch_size)
+			this->refill();
 	}
 
 	void feed(block * label, int party, const bool* b, int length) {
@@ -26,28 +20,27 @@ class SemiHonestEva: public SemiHonestParty<IO> { public:
 			this->shared_prg.random_block(label, length);
 		} else {
 			if (length > this->batch_size) {
-				this->ot->recv_cot(label, b, length);
+				this->recv_cot(label, b, length);
 			} else {
-				bool * tmp = new bool[length];
+				BitVector & tmp = this->wire;
+				tmp.resize(length);
 				if(length > this->batch_size - this->top) {
 					memcpy(label, this->buf + this->top, (this->batch_size-this->top)*sizeof(block));
-					memcpy(tmp, this->buff + this->top, (this->batch_size-this->top));
+					tmp.copy(0, this->buff, this->top, this->batch_size-this->top);
 					int filled = this->batch_size - this->top;
-					refill();
+					this->refill();
 					memcpy(label+filled, this->buf, (length - filled)*sizeof(block));
-					memcpy(tmp+ filled, this->buff, length - filled);
+					tmp.copy(filled, this->buff, 0, length - filled);
 					this->top = length - filled;
 				} else {
 					memcpy(label, this->buf+this->top, length*sizeof(block));
-					memcpy(tmp, this->buff+this->top, length);
+					tmp.copy(0, this->buff, this->top, length);
 					this->top+=length;
 				}
 
-				for(int i = 0; i < length; ++i)
-					tmp[i] = (tmp[i] != b[i]); 
-				this->io->send_data(tmp, length);
-
-				delete[] tmp;
+				this->local.from_bools(b, length);
+				tmp ^= this->local;
+				this->send_bits(tmp);
 			}
 		}
 	}
@@ -58,18 +51,18 @@ class SemiHonestEva: public SemiHonestParty<IO> { public:
 				b[i] = getLSB(label[i]);
 			return;
 		}
-		for (int i = 0; i < length; ++i) {
-			bool lsb = getLSB(label[i]), tmp;
-			if (party == BOB or party == PUBLIC) {
-				this->io->recv_data(&tmp, 1);
-				b[i] = (tmp != lsb);
-			} else if (party == ALICE) {
-				this->io->send_data(&lsb, 1);
-				b[i] = false;
-			}
+		if (party == BOB or party == PUBLIC) {
+			this->recv_bits(this->wire, length);
+			this->local.from_lsbs(label, length);
+			this->wire ^= this->local;
+			this->wire.to_bools(b);
+			if(party == PUBLIC)
+				this->send_bits(this->wire);
+		} else if (party == ALICE) {
+			this->wire.from_lsbs(label, length);
+			this->send_bits(this->wire);
+			memset(b, 0, length);
 		}
-		if(party == PUBLIC)
-			this->io->send_data(b, length);
 	}
 
 };
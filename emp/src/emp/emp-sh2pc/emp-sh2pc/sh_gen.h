@@ -6,23 +6,21 @@ namespace emp {
 
 template<typename IO>
 class SemiHonestGen: public SemiHonestParty<IO> { public:
-	HalfGateGen<IO> * gc;
-	SemiHonestGen(IO* io, HalfGateGen<IO>* gc): SemiHonestParty<IO>(io, ALICE) {
-		this->gc = gc;
-		bool delta_bool[128];
-		block_to_bool(delta_bool, gc->delta);
-		this->ot->setup_send(delta_bool);
+	block delta;
+	/* Garbles with delta, unless the COT state is restored from ot_store:
+	 * then delta is the stored one, which the garbling backend must adopt
+	 */
+	SemiHonestGen(IO* io, const block & delta, OTScheme scheme = IKNP_OT, int threads = 1, NetIO ** ot_ios = nullptr,
+			const std::string & ot_store = "")
+		: SemiHonestParty<IO>(io, ALICE, scheme, threads, ot_ios, ot_store) {
+		this->delta = this->setup_ot(&delta);
 		block seed;
 		PRG prg;
 		prg.random_block(&seed, 1);
 		this->io->send_block(&seed, 1);
 		this->shared_prg.reseed(&seed);
-		refill();
-	}
-
-	void refill() {
-		this->ot->send_cot(this->buf, this->batch_size);
-		this->top = 0;
+		if(this->top == this->batch_size)
+			this->refill();
 	}
 
 	void feed(block * label, int party, const bool* b, int length) {
@@ -30,17 +28,16 @@ class SemiHonestGen: public SemiHonestParty<IO> { public:
 			this->shared_prg.random_block(label, length);
 			for (int i = 0; i < length; ++i) {
 				if(b[i])
-					label[i] = label[i] ^ gc->delta;
+					label[i] = label[i] ^ delta;
 			}
 		} else {
 			if (length > this->batch_size) {
-				this->ot->send_cot(label, length);
+				this->send_cot(label, length);
 			} else {
-				bool * tmp = new bool[length];
 				if(length > this->batch_size - this->top) {
 					memcpy(label, this->buf + this->top, (this->batch_size-this->top)*sizeof(block));
 					int filled = this->batch_size - this->top;
-					refill();
+					this->refill();
 					memcpy(label + filled, this->buf, (length - filled)*sizeof(block));
 					this->top = (length - filled);
 				} else {
@@ -48,11 +45,10 @@ class SemiHonestGen: public SemiHonestParty<IO> { public:
 					this->top+=length;
 				}
 				
-				this->io->recv_data(tmp, length);
+				this->recv_bits(this->wire, length);
 				for (int i = 0; i < length; ++i)
-					if(tmp[i])
-						label[i] = label[i] ^ gc->delta;
-				delete[] tmp;
+					if(this->wire[i])
+						label[i] = label[i] ^ delta;
 			}
 		}
 	}
@@ -63,19 +59,20 @@ class SemiHonestGen: public SemiHonestParty<IO> { public:
 				b[i] = getLSB(label[i]);
 			return;
 		}
-		for (int i = 0; i < length; ++i) {
-			bool lsb = getLSB(label[i]);
-			if (party == BOB or party == PUBLIC) {
-				this->io->send_data(&lsb, 1);
-				b[i] = false;
-			} else if(party == ALICE) {
-				bool tmp;
-				this->io->recv_data(&tmp, 1);
-				b[i] = (tmp != lsb);
-			}
+		// All the bits go in one packed message each way
+		if (party == BOB or party == PUBLIC) {
+			this->local.from_lsbs(label, length);
+			this->send_bits(this->local);
+			if(party == PUBLIC) {
+				this->recv_bits(this->wire, length);
+				this->wire.to_bools(b);
+			} else memset(b, 0, length);
+		} else if(party == ALICE) {
+			this->recv_bits(this->wire, length);
+			this->local.from_lsbs(label, length);
+			this->wire ^= this->local;
+			this->wire.to_bools(b);
 		}
-		if(party == PUBLIC)
-			this->io->recv_data(b, length);
 	}
 };
 }
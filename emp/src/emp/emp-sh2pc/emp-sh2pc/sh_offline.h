@@ -0,0 +1,232 @@
+#ifndef EMP_SEMIHONEST_OFFLINE_H__
+#define EMP_SEMIHONEST_OFFLINE_H__
+#include "emp-tool/emp-tool.h"
+#include "emp-ot/emp-ot.h"
+#include "emp-sh2pc/semihonest.h"
+#include <vector>
+
+namespace emp {
+
+/*
+ * Offline/online split of the semi-honest protocol, for circuits whose shape
+ * is known before the inputs. Offline, Alice runs the program with dummy
+ * inputs and garbles it into a local channel (MemIO or FileIO): `tables`
+ * gets the garbled tables and the decoding bits of outputs revealed to Bob,
+ * and Bob downloads it; `state` gets delta, the seed of the input labels and
+ * the decoding bits of outputs revealed to Alice, and stays with her.
+ * Online, both parties run the same program again on the real inputs. Alice
+ * only sends her input labels and the OTs for Bob's inputs, Bob evaluates
+ * with the tables streamed from his local copy. The control flow of the
+ * program must not depend on revealed values. The tables start with the
+ * garbling scheme, which Bob's evaluator is chosen by.
+ */
+
+// Alice's offline phase: garbles into tables, every input wire gets a fresh zero-label
+template<typename T>
+class SemiHonestOfflineGen: public ProtocolExecution { public:
+	T * tables, * state;
+	PRG label_prg;
+	SemiHonestOfflineGen(T * tables, T * state, const block & delta): ProtocolExecution(ALICE) {
+		this->tables = tables;
+		this->state = state;
+		block seed;
+		PRG().random_block(&seed, 1);
+		label_prg.reseed(&seed);
+		state->send_block(&delta, 1);
+		state->send_block(&seed, 1);
+	}
+
+	void feed(block * label, int party, const bool* b, int length) override {
+		label_prg.random_block(label, length);
+	}
+
+	void reveal(bool* b, int party, const block * label, int length) override {
+		T * to = (party == BOB or party == PUBLIC) ? tables : state;
+		for (int i = 0; i < length; ++i) {
+			bool lsb = getLSB(label[i]);
+			to->send_data(&lsb, 1);
+			b[i] = false;
+		}
+	}
+};
+
+// Alice's online phase: no gates, the tables are already at Bob's
+class IdleCircExec: public CircuitExecution { public:
+	block and_gate(const block& a, const block& b) override {
+		return zero_block;
+	}
+	block xor_gate(const block& a, const block& b) override {
+		return zero_block;
+	}
+	block not_gate(const block& a) override {
+		return zero_block;
+	}
+	block public_label(bool b) override {
+		return zero_block;
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		memset(out, 0, n*sizeof(block));
+	}
+};
+
+template<typename IO, typename T>
+class SemiHonestOnlineGen: public ProtocolExecution { public:
+	IO * io;
+	T * state;
+	IKNP<IO> * ot;
+	block delta;
+	PRG label_prg;
+	SemiHonestOnlineGen(IO * io, T * state): ProtocolExecution(ALICE) {
+		this->io = io;
+		this->state = state;
+		block seed;
+		state->recv_block(&delta, 1);
+		state->recv_block(&seed, 1);
+		label_prg.reseed(&seed);
+		bool delta_bool[128];
+		block_to_bool(delta_bool, delta);
+		ot = new IKNP<IO>(io);
+		ot->setup_send(delta_bool);
+	}
+	~SemiHonestOnlineGen() {
+		delete ot;
+	}
+
+	// Translates the labels Bob gets online to the zero-labels used offline
+	void feed(block * label, int party, const bool* b, int length) override {
+		block * zero = new block[length];
+		label_prg.random_block(zero, length);
+		if(party == ALICE) {
+			for (int i = 0; i < length; ++i)
+				label[i] = b[i] ? zero[i] ^ delta : zero[i];
+		} else {
+			ot->send_cot(label, length);
+			for (int i = 0; i < length; ++i)
+				label[i] = label[i] ^ zero[i];
+		}
+		io->send_block(label, length);
+		delete[] zero;
+	}
+
+	void reveal(bool* b, int party, const block * label, int length) override {
+		for (int i = 0; i < length; ++i) {
+			b[i] = false;
+			if(party == ALICE or party == XOR) {
+				bool lsb = false, decode;
+				state->recv_data(&decode, 1);
+				if(party == ALICE)
+					io->recv_data(&lsb, 1);
+				b[i] = (lsb != decode);
+			}
+		}
+		if(party == PUBLIC)
+			io->recv_data(b, length);
+	}
+};
+
+template<typename IO, typename T>
+class SemiHonestOnlineEva: public ProtocolExecution { public:
+	IO * io;
+	T * tables;
+	IKNP<IO> * ot;
+	SemiHonestOnlineEva(IO * io, T * tables): ProtocolExecution(BOB) {
+		this->io = io;
+		this->tables = tables;
+		ot = new IKNP<IO>(io);
+		ot->setup_recv();
+	}
+	~SemiHonestOnlineEva() {
+		delete ot;
+	}
+
+	void feed(block * label, int party, const bool* b, int length) override {
+		if(party == ALICE) {
+			io->recv_block(label, length);
+		} else {
+			block * correction = new block[length];
+			ot->recv_cot(label, b, length);
+			io->recv_block(correction, length);
+			for (int i = 0; i < length; ++i)
+				label[i] = label[i] ^ correction[i];
+			delete[] correction;
+		}
+	}
+
+	void reveal(bool * b, int party, const block * label, int length) override {
+		for (int i = 0; i < length; ++i) {
+			bool lsb = getLSB(label[i]), decode;
+			b[i] = false;
+			if(party == BOB or party == PUBLIC) {
+				tables->recv_data(&decode, 1);
+				b[i] = (lsb != decode);
+			} else if(party == ALICE) {
+				io->send_data(&lsb, 1);
+			} else if(party == XOR) {
+				b[i] = lsb;
+			}
+		}
+		if(party == PUBLIC)
+			io->send_data(b, length);
+	}
+};
+
+template<typename T>
+inline void setup_offline_semi_honest(T * tables, T * state, GarbleScheme scheme = HALF_GATES) {
+	int32_t s = scheme;
+	tables->send_data(&s, sizeof(s));
+	block delta;
+	if(scheme == THREE_HALVES) {
+		ThreeHalvesGen<T> * t = new ThreeHalvesGen<T>(tables);
+		CircuitExecution::circ_exec = t;
+		delta = t->delta;
+	} else {
+		HalfGateGen<T> * t = new HalfGateGen<T>(tables);
+		CircuitExecution::circ_exec = t;
+		delta = t->delta;
+	}
+	ProtocolExecution::prot_exec = new SemiHonestOfflineGen<T>(tables, state, delta);
+}
+
+// stored is Alice's state or Bob's tables from setup_offline_semi_honest
+template<typename IO, typename T>
+inline void setup_online_semi_honest(IO * io, int party, T * stored) {
+	if(party == ALICE) {
+		CircuitExecution::circ_exec = new IdleCircExec();
+		ProtocolExecution::prot_exec = new SemiHonestOnlineGen<IO, T>(io, stored);
+	} else {
+		int32_t scheme = -1;
+		stored->recv_data(&scheme, sizeof(scheme));
+		if(scheme == THREE_HALVES)
+			CircuitExecution::circ_exec = new ThreeHalvesEva<T>(stored);
+		else if(scheme == HALF_GATES)
+			CircuitExecution::circ_exec = new HalfGateEva<T>(stored);
+		else error("unknown garbling scheme in the garbled tables");
+		ProtocolExecution::prot_exec = new SemiHonestOnlineEva<IO, T>(io, stored);
+	}
+}
+
+// Offline download of the garbled tables
+template<typename IO>
+inline void send_garbled_tables(IO * io, const MemIO * tables) {
+	int64_t size = tables->unread_size();
+	io->send_data(&size, sizeof(size));
+	io->send_data(tables->unread_data(), size);
+	io->flush();
+}
+
+// Replaces the contents of tables with the tables Alice sends
+template<typename IO>
+inline void recv_garbled_tables(IO * io, MemIO * tables) {
+	int64_t size;
+	io->recv_data(&size, sizeof(size));
+	tables->clear();
+	std::vector<char> chunk(std::min<int64_t>(size, 1 << 20));
+	for(int64_t done = 0; done < size; ) {
+		int64_t len = std::min<int64_t>(size - done, chunk.size());
+		io->recv_data(chunk.data(), len);
+		tables->send_data(chunk.data(), len);
+		done += len;
+	}
+}
+}
+#endif// EMP_SEMIHONEST_OFFLINE_H__
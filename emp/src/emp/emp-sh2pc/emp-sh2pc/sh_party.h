@@ -2,39 +2,388 @@
 #define EMP_SH_PARTY_H__
 #include "emp-tool/emp-tool.h"
 #include "emp-ot/emp-ot.h"
+#include "emp-sh2pc/ot_store.h"
 
 namespace emp {
 
+/* COT extension for the input labels of the evaluator: IKNP sends about 128
+ * bits per input bit; Ferret (silent OT) sends a fraction of a bit once set
+ * up, at the cost of a heavier setup and memory for ~10M COTs per extension
+ */
+enum OTScheme { IKNP_OT, FERRET_OT };
+
+inline NetIO * as_net_io(NetIO * io) {
+	return io;
+}
+
+template<typename IO>
+inline NetIO * as_net_io(IO * io) {
+	return nullptr;
+}
+
 template<typename IO>
 class SemiHonestParty: public ProtocolExecution { public:
 	IO* io = nullptr;
 	IKNP<IO> * ot = nullptr;
-	PRG shared_prg;
+	/* Ferret needs NetIO channels: its explicit flushes are not matched on
+	 * both sides, which HighSpeedNetIO requires
+	 */
+	FerretCOT<NetIO> * ferret = nullptr;
+	PRG shared_prg, prg;
 
 	block * buf = nullptr;
-	bool * buff = nullptr;
+	// Bob's choice bits of the COTs in buf
+	BitVector buff;
 	int top = 0;
 	int batch_size = 1024*16;
 
-	SemiHonestParty(IO * io, int party) : ProtocolExecution(party) {
+	/* With precompute(), a thread extends the next batch of COTs into
+	 * next_buf while feed consumes buf, and refill swaps them
+	 */
+	block * next_buf = nullptr;
+	BitVector next_buff;
+
+	/* Packed bits of a feed or reveal, kept between calls: wire for those
+	 * sent or received, local for this party's own
+	 */
+	BitVector wire, local;
+
+	// Sends bits packed 8 to a byte, in one message
+	void send_bits(const BitVector & b) {
+		io->send_data(b.bytes(), b.byte_size());
+	}
+
+	void recv_bits(BitVector & b, int length) {
+		b.resize(length);
+		io->recv_data(b.bytes(), b.byte_size());
+		b.clear_tail();
+	}
+
+	// Whether setup_ot took the COT state from the store instead of base OTs
+	bool restored = false;
+
+	/* Ferret runs its extension on threads threads with a channel of ot_ios
+	 * each; without ot_ios, a single thread uses io if it is a NetIO. With
+	 * ot_store, the COT state is taken from and left in that file (see
+	 * OTStore), which should be specific to the peer.
+	 */
+	SemiHonestParty(IO * io, int party, OTScheme scheme = IKNP_OT, int threads = 1, NetIO ** ot_ios = nullptr,
+			const std::string & ot_store = "") : ProtocolExecution(party) {
 		this->io = io;
-		ot = new IKNP<IO>(io);
+		if(ot_store != "")
+			store = new OTStore(ot_store);
+		if(scheme == FERRET_OT) {
+			if(ot_ios != nullptr)
+				this->ot_ios.assign(ot_ios, ot_ios + threads);
+			else if(threads == 1 and as_net_io(io) != nullptr)
+				this->ot_ios.push_back(as_net_io(io));
+			else error("Ferret needs a NetIO channel per thread");
+			ferret = new FerretCOT<NetIO>(party, threads, this->ot_ios.data(), false, false);
+		} else ot = new IKNP<IO>(io);
 		buf = new block[batch_size];
-		buff = new bool[batch_size];
+		buff.resize(batch_size);
+		// empty until setup_ot restores COTs or the first refill
+		top = batch_size;
 	}
 	void set_batch_size(int size) {
+		wait_precompute();
 		delete[] buf;
-		delete[] buff;
 		batch_size = size;
 		buf = new block[batch_size];
-		buff = new bool[batch_size];
+		buff.resize(batch_size);
+		// the new buffer holds no COTs yet, the next feed refills it
+		top = batch_size;
+		if(pre_pool != nullptr) {
+			delete[] next_buf;
+			next_buf = new block[batch_size];
+			next_buff.resize(batch_size);
+			start_precompute();
+		}
 	}
 
 	~SemiHonestParty() {
+		wait_precompute();
+		if(store != nullptr)
+			save_state();
+		else if(ferret != nullptr) {
+			// takes the leftover pre-OT state, which Ferret would otherwise write to a file
+			std::vector<unsigned char> state(ferret->state_size());
+			ferret->assemble_state(state.data(), state.size());
+		}
+		delete pre_pool;
+		delete pre_ot;
+		delete[] next_buf;
 		delete[] buf;
-		delete[] buff;
+		delete ferret;
+		delete store;
 		delete ot;
 	}
+
+	/* Sets up the COT extension, with the garbler's delta on Alice's side.
+	 * Returns the delta in use, which is the stored one if restored.
+	 */
+	block setup_ot(const block * delta = nullptr) {
+		block d = delta != nullptr ? *delta : zero_block;
+		std::vector<unsigned char> state;
+		if(store != nullptr)
+			restored = take_state(state);
+		size_t offset = restored ? restore_buffer(state) : 0;
+		if(ferret != nullptr) {
+			io->flush();
+			if(restored) {
+				if((int64_t)(state.size() - offset) != ferret->state_size()
+						or ferret->disassemble_state(state.data() + offset, ferret->state_size()) != 0)
+					error("stored Ferret state does not match");
+				d = ferret->Delta;
+			} else if(delta != nullptr) {
+				ferret->setup(*delta, ferret_pre_file());
+				if(!cmpBlock(&ferret->Delta, delta, 1))
+					error("Ferret does not use the garbler's delta");
+			} else ferret->setup(ferret_pre_file());
+			flush_ot();
+		} else if(restored) {
+			if(state.size() - offset != 257*sizeof(block))
+				error("stored IKNP state does not match");
+			block k[257];
+			memcpy(k, state.data() + offset, sizeof(k));
+			if(cur_party == ALICE) {
+				d = k[0];
+				bool delta_bool[128];
+				block_to_bool(delta_bool, d);
+				ot->setup_send(delta_bool, k + 1);
+			} else ot->setup_recv(k + 1, k + 129);
+		} else if(delta != nullptr) {
+			bool delta_bool[128];
+			block_to_bool(delta_bool, *delta);
+			ot->setup_send(delta_bool);
+		} else ot->setup_recv();
+		if(store != nullptr)
+			share_next_tag();
+		return d;
+	}
+
+	/* Moves COT extension for the input buffer off the critical path: from
+	 * now on, a background thread extends the next batch while the current
+	 * one is consumed, so a refill only waits if feeding outpaces it. IKNP
+	 * runs a second instance on channel, which nothing else may use; Ferret
+	 * runs on its own channels, which must not include io. Both parties call
+	 * it at the same point.
+	 */
+	void precompute(NetIO * channel = nullptr) {
+		if(pre_pool != nullptr)
+			return;
+		// the other party may be waiting for the last refill on io
+		io->flush();
+		if(ferret != nullptr) {
+			if(std::find(ot_ios.begin(), ot_ios.end(), as_net_io(io)) != ot_ios.end())
+				error("background Ferret needs channels other than io");
+		} else {
+			if(channel == nullptr)
+				error("background IKNP needs a channel");
+			// keys drawn from ot, so that the second instance needs no base OTs
+			block k0[128], k1[128];
+			next_iknp_keys(k0, k1);
+			pre_ot = new IKNP<NetIO>(channel);
+			if(cur_party == ALICE)
+				pre_ot->setup_send(ot->s, k0);
+			else pre_ot->setup_recv(k0, k1);
+		}
+		next_buf = new block[batch_size];
+		next_buff.resize(batch_size);
+		pre_pool = new ThreadPool(1);
+		start_precompute();
+	}
+
+	/* Fills buf with batch_size COTs, and buff with Bob's choice bits; with
+	 * precompute(), takes the batch extended in the background instead
+	 */
+	void refill() {
+		if(pending.valid()) {
+			pending.get();
+			std::swap(buf, next_buf);
+			std::swap(buff, next_buff);
+			start_precompute();
+		} else if(ferret != nullptr) {
+			random_cot(buf, batch_size);
+			if(cur_party == BOB)
+				buff.from_lsbs(buf, batch_size);
+		} else if(cur_party == ALICE)
+			send_cot(buf, batch_size);
+		else {
+			prg.random_bits(buff);
+			ot->recv_cot(buf, buff, batch_size);
+		}
+		top = 0;
+	}
+
+	// COTs with the garbler's delta; the receiver's choice bits are the LSBs
+	void random_cot(block * data, int length) {
+		io->flush();
+		ferret->rcot(data, length);
+		flush_ot();
+	}
+
+	void send_cot(block * data, int length) {
+		if(ferret != nullptr) {
+			wait_precompute();
+			io->flush();
+			ferret->send_cot(data, length);
+			flush_ot();
+		} else ot->send_cot(data, length);
+	}
+
+	void recv_cot(block * data, const bool * b, int length) {
+		if(ferret != nullptr) {
+			wait_precompute();
+			io->flush();
+			ferret->recv_cot(data, b, length);
+			flush_ot();
+		} else ot->recv_cot(data, b, length);
+	}
+
+private:
+	std::vector<NetIO*> ot_ios;
+	OTStore * store = nullptr;
+	block next_tag;
+	IKNP<NetIO> * pre_ot = nullptr;
+	ThreadPool * pre_pool = nullptr;
+	std::future<void> pending;
+	PRG pre_prg;
+
+	// Extends the next batch on the background thread, off io
+	void start_precompute() {
+		pending = pre_pool->enqueue([this]() {
+			if(ferret != nullptr) {
+				ferret->rcot(next_buf, batch_size);
+				flush_ot();
+				if(cur_party == BOB)
+					next_buff.from_lsbs(next_buf, batch_size);
+			} else if(cur_party == ALICE)
+				pre_ot->send_cot(next_buf, batch_size);
+			else {
+				pre_prg.random_bits(next_buff);
+				pre_ot->recv_cot(next_buf, next_buff, batch_size);
+				pre_ot->io->flush();
+			}
+		});
+	}
+
+	/* Lets a pending background batch finish, before anything else uses
+	 * Ferret or the buffers; the batch stays available to refill
+	 */
+	void wait_precompute() {
+		if(pending.valid())
+			pending.wait();
+	}
+
+	/* Each party flushes io before and Ferret's channels after every Ferret
+	 * call, so that neither waits for data the other one still buffers
+	 */
+	void flush_ot() {
+		for(auto c : ot_ios)
+			c->flush();
+	}
+
+	/* Base-OT keys of a new IKNP instance, drawn from the PRGs of ot: both
+	 * parties draw them at the same point, so each of Alice's keys is the one
+	 * of her choice bit among Bob's two, and no extension has used them yet
+	 */
+	void next_iknp_keys(block * k0, block * k1) {
+		for(int i = 0; i < 128; ++i) {
+			ot->G0[i].random_block(k0 + i, 1);
+			if(cur_party == BOB)
+				ot->G1[i].random_block(k1 + i, 1);
+		}
+	}
+
+	OTScheme scheme() const {
+		return ferret != nullptr ? FERRET_OT : IKNP_OT;
+	}
+
+	/* Leaves the unused COTs of the input buffer, and what the extension
+	 * needs to go on without base OTs: the reserved correlations of Ferret,
+	 * or fresh IKNP keys and Alice's delta
+	 */
+	void save_state() {
+		int64_t n = batch_size - top;
+		BitVector bits(n);
+		bits.copy(0, buff, top, n);
+		std::vector<unsigned char> state(sizeof(n) + n*sizeof(block) + bits.byte_size());
+		memcpy(state.data(), &n, sizeof(n));
+		memcpy(state.data() + sizeof(n), buf + top, n*sizeof(block));
+		memcpy(state.data() + sizeof(n) + n*sizeof(block), bits.bytes(), bits.byte_size());
+		size_t offset = state.size();
+		if(ferret != nullptr) {
+			state.resize(offset + ferret->state_size());
+			ferret->assemble_state(state.data() + offset, ferret->state_size());
+		} else {
+			// delta and the keys of Alice, or both keys of each base OT of Bob
+			block k[257];
+			memset(k, 0, sizeof(k));
+			next_iknp_keys(k + 1, k + 129);
+			if(cur_party == ALICE)
+				k[0] = ot->Delta;
+			state.resize(offset + sizeof(k));
+			memcpy(state.data() + offset, k, sizeof(k));
+		}
+		store->save(scheme(), cur_party, next_tag, state.data(), state.size());
+	}
+
+	/* Puts the stored COTs at the end of the input buffer, as many as fit,
+	 * and returns the offset of the extension state
+	 */
+	size_t restore_buffer(const std::vector<unsigned char> & state) {
+		int64_t n = -1;
+		if(state.size() >= sizeof(n))
+			memcpy(&n, state.data(), sizeof(n));
+		if(n < 0 or (state.size() - sizeof(n)) / sizeof(block) < (size_t)n
+				or state.size() - sizeof(n) - n*sizeof(block) < (size_t)(n + 7) / 8)
+			error("stored COTs do not match");
+		BitVector bits(n);
+		memcpy(bits.bytes(), state.data() + sizeof(n) + n*sizeof(block), bits.byte_size());
+		bits.clear_tail();
+		int64_t used = std::min(n, (int64_t)batch_size);
+		top = batch_size - used;
+		memcpy(buf + top, state.data() + sizeof(n), used*sizeof(block));
+		buff.copy(top, bits, 0, used);
+		return sizeof(n) + n*sizeof(block) + bits.byte_size();
+	}
+
+	// Takes the stored state, and keeps it only if the peer has the same one
+	bool take_state(std::vector<unsigned char> & state) {
+		block tag = zero_block, peer_tag;
+		if(!store->take(scheme(), cur_party, tag, state))
+			tag = zero_block;
+		if(cur_party == ALICE) {
+			io->send_block(&tag, 1);
+			io->recv_block(&peer_tag, 1);
+		} else {
+			io->recv_block(&peer_tag, 1);
+			io->send_block(&tag, 1);
+		}
+		return !cmpBlock(&tag, &zero_block, 1) and cmpBlock(&tag, &peer_tag, 1);
+	}
+
+	// Alice picks the tag of the state both parties store at the end
+	void share_next_tag() {
+		if(cur_party == ALICE) {
+			prg.random_block(&next_tag, 1);
+			io->send_block(&next_tag, 1);
+		} else io->recv_block(&next_tag, 1);
+	}
+
+	/* Ferret skips its base OTs if both parties find this file, and takes
+	 * Alice's delta from it. The name is new for every setup, so that there
+	 * is never such a file (the destructor takes the state Ferret would
+	 * write); states are kept by OTStore instead
+	 */
+	std::string ferret_pre_file() const {
+		unsigned long long r[2];
+		PRG().random_data(r, sizeof(r));
+		char name[64];
+		snprintf(name, sizeof(name), "./sh2pc_ferret_%s_%016llx%016llx.pre", cur_party == ALICE ? "alice" : "bob", r[0], r[1]);
+		return name;
+	}
 };
 }
 #endif
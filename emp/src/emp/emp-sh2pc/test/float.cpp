@@ -170,6 +170,20 @@ void fp_abs(double a) {
 	cout << z.reveal<string>() << endl;
 }
 
+void fp_reveal_batch() {
+	cout << "reveal_batch: ";
+	float in[4] = {52.21875, -24.4332565, 0, 1e-3};
+	Float x[4];
+	feed_batch(x, 4, in, BOB);
+	double out[4];
+	reveal_batch(out, x, 4);
+	for (int i = 0; i < 4; ++i) {
+		assert(out[i] == x[i].reveal<double>());
+		cout << out[i] << " ";
+	}
+	cout << endl;
+}
+
 int main(int argc, char** argv) {
 	int port, party;
 	parse_party_and_port(argv, &party, &port);
@@ -183,6 +197,7 @@ int main(int argc, char** argv) {
 	fp_if(24.4332565, 52.21875);
 	fp_abs(-24.422432);
 	fp_abs(24.422432);
+	fp_reveal_batch();
 
 	cout << endl << "Test accuracy:" << endl;
 	test_float<std::plus<float>, std::plus<Float>>(0.0);
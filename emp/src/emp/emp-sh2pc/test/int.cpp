@@ -32,6 +32,39 @@ void test_int(int party, int range1 = 1<<20, int range2 = 1<<20, int runs = 1000
 	cout << typeid(Op2).name()<<"\t\t\tDONE"<<endl;
 }
 
+void test_reveal_batch(int party, int n = 1000) {
+	PRG prg(fix_key);
+	vector<int64_t> in(n);
+	prg.random_data(in.data(), n * sizeof(int64_t));
+	vector<Integer> a(n);
+	feed_batch(a.data(), n, 32, in.data(), ALICE);
+	for (int p : {PUBLIC, ALICE, BOB}) {
+		vector<int> out(n);
+		reveal_batch(out.data(), a.data(), n, p);
+		for (int i = 0; i < n; ++i)
+			if (p == PUBLIC or p == party)
+				assert(out[i] == (int)in[i]);
+	}
+
+	// Integers of different lengths in one call
+	Integer mixed[3] = {Integer(8, 200, BOB), Integer(64, -5, ALICE), Integer(1, 1, PUBLIC)};
+	int64_t m[3];
+	reveal_batch(m, mixed, 3);
+	assert(m[0] == 200 and m[1] == -5 and m[2] == 1);
+
+	vector<Bit> bits(n);
+	vector<bool> expected(n);
+	for (int i = 0; i < n; ++i) {
+		expected[i] = in[i] & 1;
+		bits[i] = Bit(expected[i], i % 2 ? ALICE : BOB);
+	}
+	unique_ptr<bool[]> revealed(new bool[n]);
+	reveal_batch(revealed.get(), bits.data(), n);
+	for (int i = 0; i < n; ++i)
+		assert(revealed[i] == expected[i]);
+	cout << "reveal_batch\t\t\tDONE"<<endl;
+}
+
 void scratch_pad() {
 	Integer a(32, 9, ALICE);
 	cout << "HW "<<a.hamming_weight().reveal<string>(PUBLIC)<<endl;
@@ -55,6 +88,8 @@ int main(int argc, char** argv) {
 	test_int<std::bit_or<int>, std::bit_or<Integer>>(party);
 	test_int<std::bit_xor<int>, std::bit_xor<Integer>>(party);
 
+	test_reveal_batch(party);
+
 	finalize_semi_honest();
 	delete io;
 }
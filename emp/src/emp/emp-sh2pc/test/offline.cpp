@@ -0,0 +1,86 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int runs = 100;
+
+// The circuit; inputs are ignored in the offline phase
+void compute(int64_t * ia, int64_t * ib, int64_t * out_public, int64_t * out_alice, int64_t * out_bob) {
+	for(int i = 0; i < runs; ++i) {
+		Integer a(32, ia[i], ALICE);
+		Integer b(32, ib[i], BOB);
+		Integer zero(32, 0, PUBLIC);
+		out_public[i] = (a * b + a - b).reveal<int32_t>(PUBLIC);
+		out_alice[i] = (a ^ b).reveal<int32_t>(ALICE);
+		out_bob[i] = a.select(a > b, zero).reveal<int32_t>(BOB);
+	}
+}
+
+template<typename T>
+void test_online(NetIO * io, int party, T * stored, int64_t * ia, int64_t * ib) {
+	int64_t out_public[runs], out_alice[runs], out_bob[runs];
+	uint64_t sent = io->counter;
+	setup_online_semi_honest(io, party, stored);
+	compute(ia, ib, out_public, out_alice, out_bob);
+	finalize_semi_honest();
+	for(int i = 0; i < runs; ++i) {
+		int32_t a = ia[i], b = ib[i];
+		if(out_public[i] != (int32_t)((uint32_t)a * b + a - b)) error("wrong public output");
+		if(party == ALICE and out_alice[i] != (a ^ b)) error("wrong output for Alice");
+		if(party == BOB and out_bob[i] != (a > b ? 0 : a)) error("wrong output for Bob");
+	}
+	cout << "online bytes sent: " << io->counter - sent << endl;
+}
+
+void test(NetIO * io, int party, GarbleScheme scheme, const char * name) {
+	int64_t ia[runs], ib[runs], dummy[runs];
+	PRG prg(fix_key);
+	prg.random_data(ia, sizeof(ia));
+	prg.random_data(ib, sizeof(ib));
+	memset(dummy, 0, sizeof(dummy));
+
+	MemIO * tables = new MemIO(), * state = new MemIO();
+	if(party == ALICE) {
+		int64_t out[runs];
+		setup_offline_semi_honest(tables, state, scheme);
+		compute(dummy, dummy, out, out, out);
+		finalize_semi_honest();
+		cout << name << ": garbled " << tables->size << " bytes offline" << endl;
+	}
+
+	if(party == ALICE)
+		send_garbled_tables(io, tables);
+	else
+		recv_garbled_tables(io, tables);
+
+	test_online(io, party, party == ALICE ? state : tables, ia, ib);
+
+	// Bob keeps the tables on disk and streams them during evaluation. A garbled
+	// circuit must be evaluated only once, it is replayed here only for the test
+	if(party == ALICE) {
+		state->read_pos = 0;
+		test_online(io, party, state, ia, ib);
+	} else {
+		{
+			FileIO file("garbled_tables.bin", false);
+			tables->read_pos = 0;
+			file.send_data(tables->unread_data(), tables->unread_size());
+		}
+		FileIO * file = new FileIO("garbled_tables.bin", true);
+		test_online(io, party, file, ia, ib);
+		delete file;
+		remove("garbled_tables.bin");
+	}
+	delete tables;
+	delete state;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	test(io, party, HALF_GATES, "half-gates");
+	test(io, party, THREE_HALVES, "three-halves");
+	cout << "offline/online\t\t\tDONE" << endl;
+	delete io;
+}
@@ -0,0 +1,121 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+#include <sys/stat.h>
+using namespace emp;
+using namespace std;
+
+const int threads = 2;
+// Larger than the COT buffer, so that feeding refills it several times
+const int num_inputs = 4096;
+
+// Bytes sent on the main channel and the extra channels
+uint64_t bytes_sent(NetIO * io, NetIO ** ios) {
+	uint64_t sent = io->counter;
+	for(int i = 0; i < threads; ++i)
+		sent += ios[i]->counter;
+	return sent;
+}
+
+/* ot_ios are Ferret's channels; with background, COTs are precomputed on
+ * ios[0] for IKNP, or on Ferret's channels. Returns whether the COT state
+ * was restored from store.
+ */
+bool test(NetIO * io, NetIO ** ios, NetIO ** ot_ios, int party, OTScheme ot, int ot_threads, bool background, const char * name,
+		const string & store = "") {
+	uint64_t sent_setup = bytes_sent(io, ios);
+	auto start = clock_start();
+	SemiHonestParty<NetIO> * sh = setup_semi_honest(io, party, 1024*16, HALF_GATES, ot, ot_threads, ot_ios, store);
+	bool restored = sh->restored;
+	if(background)
+		sh->precompute(ot == IKNP_OT ? ios[0] : nullptr);
+	double t_setup = time_from(start);
+	sent_setup = bytes_sent(io, ios) - sent_setup;
+
+	PRG prg(fix_key);
+	vector<int32_t> a(num_inputs), b(num_inputs);
+	prg.random_data(a.data(), num_inputs * sizeof(int32_t));
+	prg.random_data(b.data(), num_inputs * sizeof(int32_t));
+	start = clock_start();
+	uint64_t sent_feed = bytes_sent(io, ios);
+	vector<Integer> ib(num_inputs);
+	for(int i = 0; i < num_inputs; ++i)
+		ib[i] = Integer(32, b[i], BOB);
+	// A single feed longer than the buffer bypasses it
+	vector<bool> bits(32 * num_inputs);
+	Integer wide(32 * num_inputs, 0, PUBLIC);
+	for(int i = 0; i < 32 * num_inputs; ++i)
+		bits[i] = (b[i / 32] >> (i % 32)) & 1;
+	{
+		unique_ptr<bool[]> in(new bool[32 * num_inputs]);
+		for(int i = 0; i < 32 * num_inputs; ++i)
+			in[i] = bits[i];
+		ProtocolExecution::prot_exec->feed((block*)wide.bits.data(), BOB, in.get(), 32 * num_inputs);
+	}
+	sent_feed = bytes_sent(io, ios) - sent_feed;
+	double t_feed = time_from(start);
+
+	for(int i = 0; i < num_inputs; ++i) {
+		Integer ia(32, a[i], ALICE);
+		if((ia + ib[i]).reveal<int32_t>(PUBLIC) != (int32_t)((uint32_t)a[i] + b[i]))
+			error("wrong sum");
+	}
+	for(int i = 0; i < num_inputs; i += 97) {
+		Integer w(32, 0, PUBLIC);
+		memcpy(w.bits.data(), wide.bits.data() + 32 * i, 32 * sizeof(Bit));
+		if(w.reveal<int32_t>(PUBLIC) != b[i])
+			error("wrong long feed");
+	}
+
+	/* Inputs fed between gates, where background COTs hide the refills; one
+	 * fewer, so that some COTs are left for the store
+	 */
+	start = clock_start();
+	Integer sum(32, 0, PUBLIC);
+	for(int i = 0; i < num_inputs - 1; ++i)
+		sum = sum + Integer(32, b[i], BOB);
+	uint32_t expected = 0;
+	for(int i = 0; i < num_inputs - 1; ++i)
+		expected += b[i];
+	if(sum.reveal<uint32_t>(PUBLIC) != expected)
+		error("wrong sum of inputs");
+	double t_interleaved = time_from(start);
+	finalize_semi_honest();
+	cout << name << ": setup " << t_setup / 1000 << " ms with " << sent_setup << " bytes sent, " << 64 * num_inputs << " input bits fed in "
+		<< t_feed / 1000 << " ms with " << sent_feed << " bytes sent, " << 32 * (num_inputs - 1) << " between gates in " << t_interleaved / 1000 << " ms" << endl;
+	return restored;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	// One channel per Ferret thread, the first one also for background IKNP
+	NetIO * ios[threads];
+	for(int i = 0; i < threads; ++i)
+		ios[i] = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port + 1 + i, true);
+
+	test(io, ios, nullptr, party, IKNP_OT, 1, false, "IKNP");
+	test(io, ios, nullptr, party, FERRET_OT, 1, false, "Ferret");
+	test(io, ios, ios, party, FERRET_OT, threads, false, "Ferret, 2 threads");
+	test(io, ios, nullptr, party, IKNP_OT, 1, true, "IKNP, background");
+	test(io, ios, ios, party, FERRET_OT, threads, true, "Ferret, 2 threads, background");
+
+	// The second run of each scheme takes the state the first one stored
+	string store = party == ALICE ? "./sh2pc_ot_test_alice.ots" : "./sh2pc_ot_test_bob.ots";
+	std::remove(store.c_str());
+	if(test(io, ios, nullptr, party, IKNP_OT, 1, false, "IKNP, first run", store))
+		error("IKNP state restored on the first run");
+	// the state holds key material, so the file is the owner's only
+	struct stat st;
+	if(stat(store.c_str(), &st) != 0 or (st.st_mode & 0777) != 0600)
+		error("OT store not private");
+	if(!test(io, ios, nullptr, party, IKNP_OT, 1, true, "IKNP, stored", store))
+		error("IKNP state not restored");
+	if(test(io, ios, ios, party, FERRET_OT, threads, false, "Ferret, first run", store)
+			or !test(io, ios, ios, party, FERRET_OT, threads, false, "Ferret, stored", store))
+		error("Ferret state not restored");
+	std::remove(store.c_str());
+	cout << "ot\t\t\tDONE" << endl;
+	for(int i = 0; i < threads; ++i)
+		delete ios[i];
+	delete io;
+}
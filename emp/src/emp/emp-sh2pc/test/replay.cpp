@@ -0,0 +1,103 @@
+#include "emp-sh2pc/emp-sh2pc.h"
+using namespace emp;
+using namespace std;
+
+const int runs = 100;
+
+void compute(int64_t * ia, int64_t * ib, int64_t * out_public, int64_t * out_alice, int64_t * out_bob) {
+	for(int i = 0; i < runs; ++i) {
+		Integer a(32, ia[i], ALICE);
+		Integer b(32, ib[i], BOB);
+		Integer zero(32, 0, PUBLIC);
+		out_public[i] = (a * b + a - b).reveal<int32_t>(PUBLIC);
+		out_alice[i] = (a ^ b).reveal<int32_t>(ALICE);
+		out_bob[i] = a.select(a > b, zero).reveal<int32_t>(BOB);
+	}
+}
+
+void check(int party, int64_t * ia, int64_t * ib, int64_t * out_public, int64_t * out_alice, int64_t * out_bob) {
+	for(int i = 0; i < runs; ++i) {
+		int32_t a = ia[i], b = ib[i];
+		if(out_public[i] != (int32_t)((uint32_t)a * b + a - b)) error("wrong public output");
+		if(party == ALICE and out_alice[i] != (a ^ b)) error("wrong output for Alice");
+		if(party == BOB and out_bob[i] != (a > b ? 0 : a)) error("wrong output for Bob");
+	}
+}
+
+// Inputs in feed order: a[i] then b[i]; outputs in reveal order
+void replay(const CapturedCircuit & circuit, int party, int64_t * ia, int64_t * ib,
+		const LeveledCircuit * leveled = nullptr, WorkStealingPool * pool = nullptr) {
+	vector<uint8_t> in(circuit.input_size()), out(circuit.output_size());
+	bool * pin = (bool*)in.data(), * pout = (bool*)out.data();
+	for(int i = 0; i < runs; ++i) {
+		int_to_bool<int32_t>(pin + 64*i, ia[i], 32);
+		int_to_bool<int32_t>(pin + 64*i + 32, ib[i], 32);
+	}
+	if(leveled != nullptr)
+		execute_semi_honest<NetIO>(circuit, *leveled, pin, pout, pool);
+	else execute_semi_honest<NetIO>(circuit, pin, pout);
+	int64_t out_public[runs], out_alice[runs], out_bob[runs];
+	for(int i = 0; i < runs; ++i) {
+		out_public[i] = bool_to_int<int32_t>(pout + 96*i);
+		out_alice[i] = bool_to_int<int32_t>(pout + 96*i + 32);
+		out_bob[i] = bool_to_int<int32_t>(pout + 96*i + 64);
+	}
+	check(party, ia, ib, out_public, out_alice, out_bob);
+}
+
+void test(NetIO * io, int party, GarbleScheme scheme) {
+	int64_t ia[runs], ib[runs], out_public[runs], out_alice[runs], out_bob[runs];
+	PRG prg(fix_key);
+	setup_semi_honest(io, party, 1024*16, scheme);
+
+	auto start = clock_start();
+	prg.random_data(ia, sizeof(ia));
+	prg.random_data(ib, sizeof(ib));
+	compute(ia, ib, out_public, out_alice, out_bob);
+	check(party, ia, ib, out_public, out_alice, out_bob);
+	double direct = time_from(start);
+
+	// Capturing needs no communication, and the circuit is reused for every run
+	CapturedCircuit circuit;
+	CircuitCapture capture;
+	capture.start(&circuit);
+	compute(ia, ib, out_public, out_alice, out_bob);
+	capture.finish();
+	if(circuit.input_size() != 64*runs or circuit.output_size() != 96*runs)
+		error("wrong captured inputs or outputs");
+
+	start = clock_start();
+	for(int k = 0; k < 10; ++k) {
+		prg.random_data(ia, sizeof(ia));
+		prg.random_data(ib, sizeof(ib));
+		replay(circuit, party, ia, ib);
+	}
+	double replayed = time_from(start) / 10;
+
+	string filename = "replay_" + to_string(party) + ".bin";
+	circuit.to_file(filename.c_str());
+	CapturedCircuit loaded;
+	loaded.from_file(filename.c_str());
+	remove(filename.c_str());
+	replay(loaded, party, ia, ib);
+
+	LeveledCircuit leveled(circuit);
+	leveled.min_chunk = 4;
+	WorkStealingPool pool(2);
+	replay(circuit, party, ia, ib, &leveled, party == ALICE ? &pool : nullptr);
+	replay(circuit, party, ia, ib, &leveled, party == BOB ? &pool : nullptr);
+
+	finalize_semi_honest();
+	cout << circuit.num_gate() << " gates, " << circuit.num_and << " AND; direct "
+		<< direct << " us, replayed " << replayed << " us" << endl;
+}
+
+int main(int argc, char** argv) {
+	int port, party;
+	parse_party_and_port(argv, &party, &port);
+	NetIO * io = new NetIO(party==ALICE ? nullptr : "127.0.0.1", port);
+	test(io, party, HALF_GATES);
+	test(io, party, THREE_HALVES);
+	cout << "capture/replay\t\t\tDONE" << endl;
+	delete io;
+}
@@ -0,0 +1,9 @@
+# Writes INPUT to OUTPUT as a C array, named like xxd -i does:
+#   cmake -DINPUT=dir/file.bin -DOUTPUT=file.bin.cpp -DNAME=dir_file_bin -P embed_file.cmake
+file(READ ${INPUT} hex HEX)
+string(LENGTH "${hex}" len)
+math(EXPR len "${len} / 2")
+# 16 bytes per line
+string(REGEX REPLACE "(................................)" "\\1\n" hex "${hex}")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," hex "${hex}")
+file(WRITE ${OUTPUT} "unsigned char ${NAME}[] = {\n${hex}\n};\nunsigned int ${NAME}_len = ${len};\n")
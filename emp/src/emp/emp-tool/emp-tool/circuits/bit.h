@@ -39,6 +39,10 @@ class Bit : public Swappable<Bit>{ public:
 		b[0] = data;
 	}
 };
+
+// Reveals n Bits in a single call: one message each way with the semi-honest protocol
+void reveal_batch(bool * out, const Bit * in, size_t n, int party = PUBLIC);
+
 #include "emp-tool/circuits/bit.hpp"
 }
 #endif
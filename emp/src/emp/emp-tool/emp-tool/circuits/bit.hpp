@@ -18,6 +18,10 @@ inline O Bit::reveal(int party) const {
 	return res;
 }
 
+inline void reveal_batch(bool * out, const Bit * in, size_t n, int party) {
+	ProtocolExecution::prot_exec->reveal(out, party, (const block *)in, n);
+}
+
 template<>
 inline string Bit::reveal<string>(int party) const {
 	bool res;
@@ -0,0 +1,140 @@
+#ifndef EMP_CIRCUIT_BINARY_H__
+#define EMP_CIRCUIT_BINARY_H__
+#include "emp-tool/circuits/circuit_file.h"
+#include "emp-tool/utils/utils.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace emp {
+
+/*
+ * Binary circuit format: a fixed header followed by num_gate records of four
+ * 32-bit ints (in1, in2, out, type), the layout of BristolFormat::gates. The
+ * file is memory-mapped and the gates are executed in place, so loading
+ * costs no parsing. Bristol Fashion circuits are stored with all inputs in
+ * n1 and n2 = 0.
+ */
+struct BinaryCircuitHeader {
+	char magic[8];
+	int64_t num_gate, num_wire, n1, n2, n3;
+};
+
+const static char binary_circuit_magic[8] = {'E', 'M', 'P', 'C', 'I', 'R', 'C', '1'};
+
+inline void write_binary_circuit(const char * filename, int64_t num_gate, int64_t num_wire,
+		int64_t n1, int64_t n2, int64_t n3, const int * gates) {
+	BinaryCircuitHeader h;
+	memcpy(h.magic, binary_circuit_magic, sizeof(h.magic));
+	h.num_gate = num_gate;
+	h.num_wire = num_wire;
+	h.n1 = n1;
+	h.n2 = n2;
+	h.n3 = n3;
+	FILE * f = fopen(filename, "wb");
+	if(f == nullptr)
+		error("cannot open circuit file");
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+		and fwrite(gates, 4*sizeof(int), num_gate, f) == (size_t)num_gate;
+	if(fclose(f) != 0 or !ok)
+		error("cannot write circuit file");
+}
+
+inline void to_binary_circuit(const BristolFormat & c, const char * filename) {
+	write_binary_circuit(filename, c.num_gate, c.num_wire, c.n1, c.n2, c.n3, c.gates.data());
+}
+
+inline void to_binary_circuit(const BristolFashion & c, const char * filename) {
+	write_binary_circuit(filename, c.num_gate, c.num_wire, c.num_input, 0, c.num_output, c.gates.data());
+}
+
+class BinaryCircuit { public:
+	int64_t num_gate = 0, num_wire = 0, n1 = 0, n2 = 0, n3 = 0;
+	const int * gates = nullptr;
+	vector<block> wires;
+
+	BinaryCircuit(const char * filename) {
+		int fd = open(filename, O_RDONLY);
+		if(fd < 0)
+			error("cannot open circuit file");
+		struct stat st;
+		if(fstat(fd, &st) != 0 or st.st_size < (off_t)sizeof(BinaryCircuitHeader)) {
+			close(fd);
+			error("truncated circuit file");
+		}
+		size = st.st_size;
+		int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+		flags |= MAP_POPULATE;
+#endif
+		map = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+		close(fd);
+		if(map == MAP_FAILED)
+			error("cannot map circuit file");
+
+		const BinaryCircuitHeader * h = (const BinaryCircuitHeader *)map;
+		if(memcmp(h->magic, binary_circuit_magic, sizeof(h->magic)) != 0)
+			error("not a binary circuit file");
+		if(h->num_gate < 0 or (size - sizeof(*h)) % (4*sizeof(int)) != 0
+				or (size - sizeof(*h)) / (4*sizeof(int)) != (size_t)h->num_gate)
+			error("circuit file size does not match its gate count");
+		if(h->num_wire < 0 or h->num_wire > INT32_MAX or h->n1 < 0 or h->n2 < 0 or h->n3 < 0
+				or h->n1 + h->n2 > h->num_wire or h->n3 > h->num_wire)
+			error("invalid circuit header");
+		num_gate = h->num_gate;
+		num_wire = h->num_wire;
+		n1 = h->n1;
+		n2 = h->n2;
+		n3 = h->n3;
+		gates = (const int *)(h + 1);
+		check_gates();
+		wires.resize(num_wire);
+	}
+
+	BinaryCircuit(const BinaryCircuit &) = delete;
+	BinaryCircuit & operator=(const BinaryCircuit &) = delete;
+
+	~BinaryCircuit() {
+		munmap(map, size);
+	}
+
+	void compute(Bit * out, const Bit * in1, const Bit * in2) {
+		compute((block*)out, (block *)in1, (block*)in2);
+	}
+
+	void compute(block * out, const block * in1, const block * in2) {
+		memcpy(wires.data(), in1, n1*sizeof(block));
+		if(n2 > 0)
+			memcpy(wires.data()+n1, in2, n2*sizeof(block));
+		execute_circuit(wires.data(), gates, num_gate);
+		memcpy(out, wires.data()+(num_wire-n3), n3*sizeof(block));
+	}
+
+	// Bristol Fashion circuits, all inputs in one array
+	void compute(Bit * out, const Bit * in) {
+		compute((block*)out, (block *)in, nullptr);
+	}
+
+	void compute(block * out, const block * in) {
+		compute(out, in, nullptr);
+	}
+
+private:
+	void * map = nullptr;
+	size_t size = 0;
+
+	// Every wire a gate reads or writes is in [0, num_wire); NOT gates have no second input
+	void check_gates() const {
+		for(int64_t i = 0; i < num_gate; ++i) {
+			const int * g = gates + 4*i;
+			bool in2 = g[3] != NOT_GATE;
+			if(g[0] < 0 or g[0] >= num_wire or g[2] < 0 or g[2] >= num_wire
+					or (in2 and (g[1] < 0 or g[1] >= num_wire)))
+				error("circuit file has a wire index out of range");
+		}
+	}
+};
+}
+#endif// EMP_CIRCUIT_BINARY_H__
@@ -78,6 +78,21 @@ class BristolFormat { public:
 		fout.close();
 	}
 
+	// Writes the circuit back in the text format read by from_file
+	void to_bristol(const char * filename) {
+		fout.open(filename);
+		fout << num_gate << " " << num_wire << "\n";
+		fout << n1 << " " << n2 << " " << n3 << "\n\n";
+		for(int i = 0; i < num_gate; ++i) {
+			const int * g = gates.data() + 4*i;
+			if(g[3] == NOT_GATE)
+				fout << "1 1 " << g[0] << " " << g[2] << " INV\n";
+			else
+				fout << "2 1 " << g[0] << " " << g[1] << " " << g[2] << (g[3] == AND_GATE ? " AND\n" : " XOR\n");
+		}
+		fout.close();
+	}
+
 
 	void from_file(FILE * f) {
 		int tmp;
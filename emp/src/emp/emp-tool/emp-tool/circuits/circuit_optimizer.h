@@ -0,0 +1,324 @@
+#ifndef EMP_CIRCUIT_OPTIMIZER_H__
+#define EMP_CIRCUIT_OPTIMIZER_H__
+#include "emp-tool/circuits/circuit_file.h"
+#include "emp-tool/utils/utils.h"
+#include <vector>
+#include <unordered_map>
+
+namespace emp {
+
+/*
+ * Offline optimizer for Bristol circuits. The circuit is rebuilt as an
+ * AND/XOR graph over literals (a node and a negation bit), so NOT gates are
+ * absorbed into the literals and only materialize in front of AND inputs and
+ * outputs. Building the graph folds constants and trivial gates and shares
+ * structurally equal gates; passes then rewrite (a&b)^(a&c) into a&(b^c)
+ * when both ANDs have no other use, and the circuit is written back with the
+ * gates that do not reach an output removed.
+ */
+class CircuitOptimizer { public:
+	struct Stats {
+		size_t num_and = 0, num_xor = 0, num_not = 0;
+	};
+	// Literal 0 / 1 is constant false / true; node 0 is the constant
+	enum : uint32_t { FALSE_LIT = 0, TRUE_LIT = 1 };
+	const static int INPUT = -1;
+	// XOR inputs are never negated; neg is the polarity the node is written in
+	struct Node {
+		int type;
+		uint32_t a, b;
+		uint8_t neg;
+	};
+	std::vector<Node> nodes;
+	std::vector<uint32_t> outputs;
+	int n1 = 0, n2 = 0;
+	int max_pass = 8;
+
+	static Stats count(const BristolFormat & c) {
+		Stats s;
+		for(int i = 0; i < c.num_gate; ++i) {
+			if(c.gates[4*i+3] == AND_GATE) ++s.num_and;
+			else if(c.gates[4*i+3] == XOR_GATE) ++s.num_xor;
+			else ++s.num_not;
+		}
+		return s;
+	}
+
+	BristolFormat optimize(const BristolFormat & c) {
+		load(c);
+		size_t num_and = live_and();
+		for(int i = 0; i < max_pass; ++i) {
+			rewrite();
+			size_t now = live_and();
+			if(now >= num_and)
+				break;
+			num_and = now;
+		}
+		return to_bristol();
+	}
+
+	void load(const BristolFormat & c) {
+		reset(c.n1, c.n2);
+		std::vector<uint32_t> lit(c.num_wire, FALSE_LIT);
+		for(int i = 0; i < n1 + n2; ++i)
+			lit[i] = 2*(i+1);
+		for(int i = 0; i < c.num_gate; ++i) {
+			const int * g = c.gates.data() + 4*i;
+			if(g[3] == AND_GATE)
+				lit[g[2]] = make_and(lit[g[0]], lit[g[1]]);
+			else if(g[3] == XOR_GATE)
+				lit[g[2]] = make_xor(lit[g[0]], lit[g[1]]);
+			else lit[g[2]] = lit[g[0]] ^ 1;
+		}
+		for(int i = c.num_wire - c.n3; i < c.num_wire; ++i)
+			outputs.push_back(lit[i]);
+	}
+
+	uint32_t make_xor(uint32_t a, uint32_t b) {
+		uint32_t neg = (a ^ b) & 1;
+		a &= ~1u;
+		b &= ~1u;
+		if(a == b)
+			return FALSE_LIT ^ neg;
+		if(a == FALSE_LIT)
+			return b ^ neg;
+		if(b == FALSE_LIT)
+			return a ^ neg;
+		if(a > b) std::swap(a, b);
+		return lookup(XOR_GATE, a, b, neg) ^ neg;
+	}
+
+	uint32_t make_and(uint32_t a, uint32_t b) {
+		if(a == FALSE_LIT or b == FALSE_LIT or a == (b ^ 1))
+			return FALSE_LIT;
+		if(a == TRUE_LIT or a == b)
+			return b;
+		if(b == TRUE_LIT)
+			return a;
+		// a & (a & c) = a & c, and ~a & (a & c) = 0
+		for(int k = 0; k < 2; ++k, std::swap(a, b)) {
+			const Node & n = nodes[b >> 1];
+			if((b & 1) == 0 and n.type == AND_GATE) {
+				if(a == n.a or a == n.b)
+					return b;
+				if(a == (n.a ^ 1) or a == (n.b ^ 1))
+					return FALSE_LIT;
+			}
+		}
+		if(a > b) std::swap(a, b);
+		return lookup(AND_GATE, a, b, 0);
+	}
+
+	size_t live_and() {
+		std::vector<bool> live = live_nodes();
+		size_t n = 0;
+		for(size_t i = 0; i < nodes.size(); ++i)
+			if(live[i] and nodes[i].type == AND_GATE)
+				++n;
+		return n;
+	}
+
+	// Rebuilds the graph, applying (a&b)^(a&c) -> a&(b^c) on single-use ANDs
+	void rewrite() {
+		std::vector<bool> live = live_nodes();
+		std::vector<uint32_t> uses(nodes.size(), 0);
+		for(size_t i = 0; i < nodes.size(); ++i) {
+			if(live[i] and nodes[i].type != INPUT) {
+				++uses[nodes[i].a >> 1];
+				++uses[nodes[i].b >> 1];
+			}
+		}
+		for(auto o : outputs)
+			++uses[o >> 1];
+
+		std::vector<Node> old;
+		old.swap(nodes);
+		std::vector<uint32_t> old_outputs;
+		old_outputs.swap(outputs);
+		reset(n1, n2);
+		std::vector<uint32_t> map(old.size(), FALSE_LIT);
+		for(int i = 0; i <= n1 + n2; ++i)
+			map[i] = 2*i;
+		auto m = [&](uint32_t l) -> uint32_t {
+			return map[l >> 1] ^ (l & 1);
+		};
+		for(size_t i = n1 + n2 + 1; i < old.size(); ++i) {
+			if(!live[i])
+				continue;
+			const Node & n = old[i];
+			if(n.type == AND_GATE) {
+				map[i] = make_and(m(n.a), m(n.b));
+				continue;
+			}
+			const Node & x = old[n.a >> 1], & y = old[n.b >> 1];
+			if(x.type == AND_GATE and y.type == AND_GATE and uses[n.a >> 1] == 1 and uses[n.b >> 1] == 1) {
+				uint32_t common = FALSE_LIT, rx = 0, ry = 0;
+				if(x.a == y.a or x.a == y.b) {
+					common = x.a;
+					rx = x.b;
+					ry = (x.a == y.a) ? y.b : y.a;
+				} else if(x.b == y.a or x.b == y.b) {
+					common = x.b;
+					rx = x.a;
+					ry = (x.b == y.a) ? y.b : y.a;
+				}
+				if(common != FALSE_LIT) {
+					map[i] = make_and(m(common), make_xor(m(rx), m(ry)));
+					continue;
+				}
+			}
+			size_t size = nodes.size();
+			map[i] = make_xor(m(n.a), m(n.b));
+			// a new node keeps the polarity the old one was written in
+			if(nodes.size() > size)
+				nodes.back().neg = n.neg ^ (map[i] & 1);
+		}
+		for(auto o : old_outputs)
+			outputs.push_back(m(o));
+	}
+
+	/* Writes the live gates in topological order. The wire of an XOR node
+	 * carries the polarity the node was first built with, which follows the
+	 * NOT placement of the input circuit; other NOT gates are only added where
+	 * an AND input or an output needs the other polarity. Outputs take the
+	 * last n3 wires, copied through a zero wire when they are constants,
+	 * inputs, or repeated.
+	 */
+	BristolFormat to_bristol() {
+		const uint32_t OUT = 1u << 31, NONE = ~0u;
+		int n_in = n1 + n2, n3 = outputs.size();
+		std::vector<bool> live = live_nodes();
+		std::vector<uint32_t> wire(nodes.size(), NONE), not_wire(nodes.size(), NONE);
+		std::vector<uint8_t> pol(nodes.size(), 0);
+		std::vector<bool> placed(n3, false);
+		for(int i = 0; i < n_in; ++i)
+			wire[i+1] = i;
+		for(size_t i = n_in + 1; i < nodes.size(); ++i)
+			pol[i] = nodes[i].neg;
+		// nodes whose other polarity is needed by an AND input or an output anyway
+		std::vector<bool> needs_not(nodes.size(), false);
+		for(size_t i = n_in + 1; i < nodes.size(); ++i) {
+			if(live[i] and nodes[i].type == AND_GATE) {
+				if((nodes[i].a & 1) != pol[nodes[i].a >> 1]) needs_not[nodes[i].a >> 1] = true;
+				if((nodes[i].b & 1) != pol[nodes[i].b >> 1]) needs_not[nodes[i].b >> 1] = true;
+			}
+		}
+		for(auto o : outputs)
+			if(o > TRUE_LIT and (o & 1) != pol[o >> 1])
+				needs_not[o >> 1] = true;
+		for(int k = 0; k < n3; ++k) {
+			uint32_t node = outputs[k] >> 1;
+			if((outputs[k] & 1) == pol[node] and nodes[node].type != INPUT and wire[node] == NONE) {
+				wire[node] = OUT | k;
+				placed[k] = true;
+			}
+		}
+
+		std::vector<uint32_t> gates;
+		uint32_t next = n_in;
+		auto emit = [&](uint32_t a, uint32_t b, uint32_t out, int type) -> void {
+			uint32_t g[4] = {a, b, out, (uint32_t)type};
+			gates.insert(gates.end(), g, g+4);
+		};
+		// Wire carrying literal l
+		auto wire_of = [&](uint32_t l) -> uint32_t {
+			uint32_t node = l >> 1;
+			if((l & 1) == pol[node])
+				return wire[node];
+			if(not_wire[node] == NONE) {
+				not_wire[node] = next++;
+				emit(wire[node], 0, not_wire[node], NOT_GATE);
+			}
+			return not_wire[node];
+		};
+		for(size_t i = n_in + 1; i < nodes.size(); ++i) {
+			if(!live[i])
+				continue;
+			uint32_t a, b;
+			if(nodes[i].type == XOR_GATE) {
+				// flip an input to match the polarity, preferring one whose NOT is needed anyway
+				uint32_t na = nodes[i].a >> 1, nb = nodes[i].b >> 1;
+				uint32_t la = 2*na | pol[na], lb = 2*nb | pol[nb];
+				if((pol[na] ^ pol[nb]) != pol[i]) {
+					bool ra = not_wire[na] != NONE or needs_not[na];
+					bool rb = not_wire[nb] != NONE or needs_not[nb];
+					if(ra and !rb)
+						la ^= 1;
+					else lb ^= 1;
+				}
+				a = wire_of(la);
+				b = wire_of(lb);
+			} else {
+				a = wire_of(nodes[i].a);
+				b = wire_of(nodes[i].b);
+			}
+			if(wire[i] == NONE)
+				wire[i] = next++;
+			emit(a, b, wire[i], nodes[i].type);
+		}
+
+		uint32_t zero = NONE;
+		for(int k = 0; k < n3; ++k) {
+			if(placed[k])
+				continue;
+			uint32_t l = outputs[k];
+			if(zero == NONE) {
+				if(n_in == 0)
+					error("cannot write constant outputs of a circuit without inputs");
+				zero = next++;
+				emit(0, 0, zero, XOR_GATE);
+			}
+			if(l == FALSE_LIT or l == TRUE_LIT)
+				emit(zero, l == TRUE_LIT ? 0 : zero, OUT | k, l == TRUE_LIT ? NOT_GATE : XOR_GATE);
+			else if((l & 1) != pol[l >> 1])
+				emit(wire[l >> 1], 0, OUT | k, NOT_GATE);
+			else
+				emit(wire[l >> 1], zero, OUT | k, XOR_GATE);
+		}
+
+		std::vector<int> arr(gates.size());
+		for(size_t i = 0; i < gates.size(); ++i) {
+			uint32_t w = gates[i];
+			arr[i] = (i % 4 != 3 and (w & OUT)) ? next + (w & ~OUT) : w;
+		}
+		return BristolFormat(gates.size()/4, next + n3, n1, n2, n3, arr.data());
+	}
+
+private:
+	std::unordered_map<uint64_t, uint32_t> table[2];
+
+	void reset(int n1, int n2) {
+		this->n1 = n1;
+		this->n2 = n2;
+		nodes.assign(n1 + n2 + 1, Node{INPUT, 0, 0, 0});
+		outputs.clear();
+		table[0].clear();
+		table[1].clear();
+	}
+
+	uint32_t lookup(int type, uint32_t a, uint32_t b, uint8_t neg) {
+		uint64_t key = ((uint64_t)a << 32) | b;
+		auto it = table[type].find(key);
+		if(it != table[type].end())
+			return it->second;
+		uint32_t l = 2*nodes.size();
+		nodes.push_back(Node{type, a, b, neg});
+		table[type][key] = l;
+		return l;
+	}
+
+	std::vector<bool> live_nodes() {
+		std::vector<bool> live(nodes.size(), false);
+		for(auto o : outputs)
+			live[o >> 1] = true;
+		for(size_t i = nodes.size(); i-- > 0; ) {
+			if(live[i] and nodes[i].type != INPUT) {
+				live[nodes[i].a >> 1] = true;
+				live[nodes[i].b >> 1] = true;
+			}
+		}
+		return live;
+	}
+};
+}
+#endif// EMP_CIRCUIT_OPTIMIZER_H__
@@ -0,0 +1,197 @@
+#include "emp-tool/circuits/float32.h"
+#include <vector>
+#include <stdexcept>
+
+// emp-tool/circuits/files/float32.bin, embedded at build time by cmake/embed_file.cmake
+extern unsigned char emp_tool_circuits_files_float32_bin[];
+extern unsigned int emp_tool_circuits_files_float32_bin_len;
+
+namespace emp {
+namespace {
+/* float32.bin holds the float32 netlists in the order below, after an 8-byte
+ * magic. All integers are LEB128 varints: the number of netlists, then for
+ * each one the number of inputs, outputs and gates, followed by the gates.
+ * A gate is a type byte (0 AND, 1 XOR, 2 NOT) and, for each input wire, the
+ * distance back from its output wire. Outputs are implicit, since gate i
+ * always writes wire num_input + i, and the last num_output wires are the
+ * result. emp/scripts/float32_netlists.py writes the file from the netlists
+ * in Bristol format, and back.
+ */
+enum { ADD, SUB, MUL, DIV, EQ, LT, LEQ, SQR, SQRT, SIN, COS, EXP, EXP2, LN, LOG2, NUM_NETLIST };
+
+struct Netlist {
+	std::vector<uint16_t> gates; // in1, in2, out, type, as in execute_circuit
+	size_t num_gate, num_wire;
+	int num_input, num_output;
+};
+
+uint64_t read_varint(const unsigned char *& p, const unsigned char * end) {
+	uint64_t res = 0;
+	for(int shift = 0; p < end and shift < 64; shift += 7) {
+		unsigned char byte = *p++;
+		res |= (uint64_t)(byte & 0x7f) << shift;
+		if((byte & 0x80) == 0)
+			return res;
+	}
+	throw std::runtime_error("truncated float32 netlist");
+}
+
+// Distance back from wire out to an input of its gate, which is an earlier wire
+uint16_t read_distance(const unsigned char *& p, const unsigned char * end, uint16_t out) {
+	uint64_t d = read_varint(p, end);
+	if(d == 0 or d > out)
+		throw std::runtime_error("invalid float32 netlist gate");
+	return d;
+}
+
+std::vector<Netlist> decode_netlists(const unsigned char * data, size_t len) {
+	const unsigned char * p = data + 8, * end = data + len;
+	if(len < 8 or memcmp(data, "EMPF32\0\1", 8) != 0 or read_varint(p, end) != NUM_NETLIST)
+		throw std::runtime_error("invalid float32 netlist file");
+	std::vector<Netlist> res(NUM_NETLIST);
+	for(Netlist & n : res) {
+		uint64_t num_input = read_varint(p, end), num_output = read_varint(p, end),
+			num_gate = read_varint(p, end);
+		// wires are uint16_t, the inputs one or two Floats
+		if((num_input != FLOAT_LEN and num_input != 2*FLOAT_LEN) or num_output > FLOAT_LEN
+				or num_gate > UINT16_MAX - num_input or num_output > num_input + num_gate)
+			throw std::runtime_error("invalid float32 netlist");
+		n.num_input = num_input;
+		n.num_output = num_output;
+		n.num_gate = num_gate;
+		n.num_wire = n.num_input + n.num_gate;
+		n.gates.resize(4*n.num_gate);
+		for(size_t i = 0; i < n.num_gate; ++i) {
+			uint16_t out = n.num_input + i;
+			if(p == end)
+				throw std::runtime_error("truncated float32 netlist");
+			uint16_t type = *p++;
+			if(type != AND_GATE and type != XOR_GATE and type != NOT_GATE)
+				throw std::runtime_error("invalid float32 netlist gate");
+			n.gates[4*i] = out - read_distance(p, end, out);
+			n.gates[4*i+1] = (type == NOT_GATE) ? 0 : out - read_distance(p, end, out);
+			n.gates[4*i+2] = out;
+			n.gates[4*i+3] = type;
+		}
+	}
+	if(p != end)
+		throw std::runtime_error("invalid float32 netlist file");
+	return res;
+}
+
+const Netlist & netlist(int id) {
+	static const std::vector<Netlist> table = decode_netlists(
+			emp_tool_circuits_files_float32_bin, emp_tool_circuits_files_float32_bin_len);
+	return table[id];
+}
+
+/* lhs (and rhs for binary operations) fill the first wires and out receives
+ * the last wires. Wires are always written before they are read, so the
+ * buffer is shared by every netlist run on this thread and only ever grows.
+ */
+void execute_float32_circuit(Bit * out, int id, const Bit * lhs, const Bit * rhs = nullptr) {
+	static thread_local std::vector<block> wires;
+	const Netlist & n = netlist(id);
+	if(wires.size() < n.num_wire)
+		wires.resize(n.num_wire);
+	memcpy(wires.data(), lhs, sizeof(block)*FLOAT_LEN);
+	if(rhs != nullptr)
+		memcpy(wires.data()+FLOAT_LEN, rhs, sizeof(block)*FLOAT_LEN);
+	execute_circuit<uint16_t>(wires.data(), n.gates.data(), n.num_gate);
+	memcpy((block*)out, wires.data()+n.num_wire-n.num_output, sizeof(block)*n.num_output);
+}
+}
+
+Float Float::operator+(const Float& rhs) const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), ADD, value.data(), rhs.value.data());
+	return res;
+}
+
+Float Float::operator-(const Float& rhs) const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), SUB, value.data(), rhs.value.data());
+	return res;
+}
+
+Float Float::operator*(const Float& rhs) const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), MUL, value.data(), rhs.value.data());
+	return res;
+}
+
+Float Float::operator/(const Float& rhs) const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), DIV, value.data(), rhs.value.data());
+	return res;
+}
+
+Bit Float::equal(const Float & rhs) const {
+	Bit ret;
+	execute_float32_circuit(&ret, EQ, value.data(), rhs.value.data());
+	return ret;
+}
+
+Bit Float::less_than(const Float & rhs) const {
+	Bit ret;
+	execute_float32_circuit(&ret, LT, value.data(), rhs.value.data());
+	return ret;
+}
+
+Bit Float::less_equal(const Float & rhs) const {
+	Bit ret;
+	execute_float32_circuit(&ret, LEQ, value.data(), rhs.value.data());
+	return ret;
+}
+
+Float Float::sqr() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), SQR, value.data());
+	res[31] = Bit(false, PUBLIC);
+	return res;
+}
+
+Float Float::sqrt() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), SQRT, value.data());
+	return res;
+}
+
+Float Float::sin() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), SIN, value.data());
+	return res;
+}
+
+Float Float::cos() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), COS, value.data());
+	return res;
+}
+
+Float Float::exp() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), EXP, value.data());
+	res[31] = Bit(false, PUBLIC);
+	return res;
+}
+
+Float Float::exp2() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), EXP2, value.data());
+	res[31] = Bit(false, PUBLIC);
+	return res;
+}
+
+Float Float::ln() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), LN, value.data());
+	return res;
+}
+
+Float Float::log2() const {
+	Float res(*this);
+	execute_float32_circuit(res.value.data(), LOG2, value.data());
+	return res;
+}
+}
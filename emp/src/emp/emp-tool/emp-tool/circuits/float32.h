@@ -67,6 +67,12 @@ class Float: Swappable<Float> { public:
 	size_t size() const {return 32;};
 };
 
+// n Floats, out[i] holding input[i], fed in a single call (see feed_batch of Integer)
+void feed_batch(Float * out, size_t n, const float * input, int party);
+
+// Reveals n Floats in a single call, out[i] being in[i].reveal<double>()
+void reveal_batch(double * out, const Float * in, size_t n, int party = PUBLIC);
+
 #include "emp-tool/circuits/float32.hpp"
 }
 #endif// DOUBLE_H__
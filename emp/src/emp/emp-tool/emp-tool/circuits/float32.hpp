@@ -5,26 +5,46 @@ inline Float::Float(float input, int party) {
 		value[i] = val.bits[i];
 }
 
-template<>
-inline string Float::reveal<string>(int party) const {
-	int out = 0;
-	for(int i = FLOAT_LEN-1; i >= 0; --i) {
-		out <<= 1;
-		out += value[i].reveal<bool>(party);
+inline void feed_batch(Float * out, size_t n, const float * input, int party) {
+	std::unique_ptr<bool[]> b(new bool[n*FLOAT_LEN]());
+	if(input != nullptr)
+		for(size_t i = 0; i < n; ++i) {
+			int32_t in;
+			memcpy(&in, input + i, sizeof(in));
+			int_to_bool<int32_t>(b.get() + i*FLOAT_LEN, in, FLOAT_LEN);
+		}
+	vector<block> labels(n*FLOAT_LEN);
+	feed_bits(labels.data(), b.get(), n*FLOAT_LEN, party);
+	for(size_t i = 0; i < n; ++i)
+		std::copy((Bit *)labels.data() + i*FLOAT_LEN, (Bit *)labels.data() + (i+1)*FLOAT_LEN, out[i].value.begin());
+}
+
+inline void reveal_batch(double * out, const Float * in, size_t n, int party) {
+	vector<block> labels(n*FLOAT_LEN);
+	for(size_t i = 0; i < n; ++i)
+		memcpy(labels.data() + i*FLOAT_LEN, in[i].value.data(), FLOAT_LEN*sizeof(block));
+	std::unique_ptr<bool[]> b(new bool[n*FLOAT_LEN]);
+	ProtocolExecution::prot_exec->reveal(b.get(), party, labels.data(), n*FLOAT_LEN);
+	for(size_t i = 0; i < n; ++i) {
+		uint32_t bits = 0;
+		for(int j = 0; j < FLOAT_LEN; ++j)
+			bits |= (uint32_t)b[i*FLOAT_LEN + j] << j;
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		out[i] = f;
 	}
-	float *fp = (float*)(&out);
-	return std::to_string(*fp);
 }
 
 template<>
 inline double Float::reveal<double>(int party) const {
-	int out = 0;
-	for(int i = 0; i < FLOAT_LEN; ++i) {	
-		int tmp = value[i].reveal<bool>(party);
-		out += (tmp << i);
-	}
-	float *fp = (float*)(&out);
-	return (double)*fp;
+	double out;
+	reveal_batch(&out, this, 1, party);
+	return out;
+}
+
+template<>
+inline string Float::reveal<string>(int party) const {
+	return std::to_string(reveal<double>(party));
 }
 
 inline Float Float::abs() const {
@@ -35,8 +55,7 @@ inline Float Float::abs() const {
 
 inline Float Float::If(const Bit& select, const Float & d) {
 	Float res(*this);
-	for(int i = 0; i < 32; ++i)
-		res.value[i] = value[i].If(select, d.value[i]);
+	ifThenElse(res.value.data(), d.value.data(), value.data(), FLOAT_LEN, select);
 	return res;
 }
 
@@ -72,8 +91,7 @@ inline Float Float::operator^=(const Float& rhs) {
 
 inline Float Float::operator&(const Float& rhs) const {
 	Float res(*this);
-	for(int i = 0; i < 32; ++i)
-		res[i] = res[i] & rhs[i];
+	and_batch(res.value.data(), value.data(), rhs.value.data(), FLOAT_LEN);
 	return res;
 }
 
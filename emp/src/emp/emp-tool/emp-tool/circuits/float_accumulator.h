@@ -0,0 +1,44 @@
+#ifndef EMP_FLOAT_ACCUMULATOR_H__
+#define EMP_FLOAT_ACCUMULATOR_H__
+
+#include "emp-tool/circuits/bit.h"
+#include "emp-tool/circuits/integer.h"
+#include "emp-tool/circuits/float32.h"
+#include <vector>
+#include <algorithm>
+using std::max;
+
+namespace emp {
+
+/* Kulisch-style exact accumulator for Float values.
+ * Every addend is converted once into a two's complement fixed-point number
+ * whose least significant bit weighs 2^min_exp and added with a plain integer
+ * adder; rounding to a Float happens only in value(). With the default window
+ * every finite float32 fits, so sums are exact up to 2^carry_bits addends.
+ * A narrower window makes each add cheaper: bits below 2^min_exp are dropped
+ * and addends at or above 2^(max_exp+1) overflow.
+ */
+class FloatAccumulator { public:
+	Integer acc;
+	int min_exp;
+	int max_exp;
+
+	FloatAccumulator(int min_exp = -149, int max_exp = 127, int carry_bits = 32);
+
+	void add(const Float& x);
+	void add(const Bit& b);
+	void add_product(const Float& x, const Float& y);
+
+	Float value() const;
+	size_t size() const {return acc.size();};
+
+	/* Adds (-1)^sign * sig * 2^(shamt + base), where shamt is an unsigned
+	 * secret shift amount; the building block of the add methods.
+	 */
+	void add_shifted(const Bit* sig, int sig_len, const Bit* shamt, int shamt_len,
+			int base, const Bit& sign);
+};
+
+#include "emp-tool/circuits/float_accumulator.hpp"
+}
+#endif// EMP_FLOAT_ACCUMULATOR_H__
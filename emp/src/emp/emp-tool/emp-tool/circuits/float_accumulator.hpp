@@ -0,0 +1,193 @@
+inline Bit or_full(const Bit * src, int size) {
+	Bit res(false);
+	if(size > 0)
+		res = src[0];
+	for(int i = 1; i < size; ++i)
+		res = res | src[i];
+	return res;
+}
+
+inline FloatAccumulator::FloatAccumulator(int min_exp, int max_exp, int carry_bits):
+	acc(max_exp - min_exp + 1 + carry_bits, 0, PUBLIC), min_exp(min_exp), max_exp(max_exp) {
+}
+
+/* The significand is shifted LSB-first by one stage per bit of shamt. Only the
+ * positions that are still reachable from the significand and that can still
+ * land inside [2^min_exp, 2^max_exp] are computed, every other bit is zero.
+ * The shifted value is added as (sig ^ sign) + sign, so negation is free.
+ */
+inline void FloatAccumulator::add_shifted(const Bit* sig, int sig_len, const Bit* shamt, int shamt_len,
+		int base, const Bit& sign) {
+	int width = size();
+	int value_bits = max_exp - min_exp + 1;
+	int lo = min_exp - base, hi = lo + value_bits;
+
+	vector<int> need_lo(shamt_len+1);
+	need_lo[shamt_len] = lo;
+	for(int k = shamt_len-1; k >= 0; --k)
+		need_lo[k] = need_lo[k+1] - (1<<k);
+
+	vector<Bit> cur(sig, sig + sig_len);
+	int cur_lo = 0, live_hi = sig_len;
+	for(int k = 0; k < shamt_len; ++k) {
+		int s = 1<<k;
+		int cur_hi = cur_lo + (int)cur.size();
+		int out_lo = max(cur_lo, need_lo[k+1]);
+		int out_hi = min(live_hi + s, hi);
+		vector<Bit> next(max(out_hi - out_lo, 0));
+		for(int j = out_lo; j < out_hi; ++j) {
+			bool has_a = j >= cur_lo and j < cur_hi;
+			bool has_b = j - s >= cur_lo and j - s < cur_hi;
+			if(has_a and has_b) {
+				const Bit & a = cur[j - cur_lo], & b = cur[j - s - cur_lo];
+				next[j - out_lo] = a ^ (shamt[k] & (a ^ b));
+			} else if(has_a)
+				next[j - out_lo] = cur[j - cur_lo] & !shamt[k];
+			else if(has_b)
+				next[j - out_lo] = cur[j - s - cur_lo] & shamt[k];
+		}
+		cur.swap(next);
+		cur_lo = out_lo;
+		live_hi += s;
+	}
+
+	vector<Bit> op(width, sign);
+	for(int i = 0; i < value_bits; ++i) {
+		int j = lo + i;
+		if(j >= cur_lo and j < cur_lo + (int)cur.size())
+			op[i] = cur[j - cur_lo] ^ sign;
+	}
+	add_full(acc.bits.data(), nullptr, acc.bits.data(), op.data(), &sign, width);
+}
+
+/* Splits x into its significand, including the hidden bit, and a shift
+ * amount such that |x| = sig * 2^(shamt - 150).
+ */
+inline void float_to_scaled(Bit * sig, Bit * shamt, const Float& x) {
+	for(int i = 0; i < SGNFC_LEN; ++i)
+		sig[i] = x[i];
+	for(int i = 0; i < EXPNT_LEN; ++i)
+		shamt[i] = x[SGNFC_LEN+i];
+	Bit hidden = or_full(shamt, EXPNT_LEN);
+	sig[SGNFC_LEN] = hidden;
+	// subnormals share the scale of exponent 1; exp[0] is zero whenever hidden is
+	shamt[0] = shamt[0] ^ !hidden;
+}
+
+inline void FloatAccumulator::add(const Float& x) {
+	Bit sig[SGNFC_LEN+1], shamt[EXPNT_LEN];
+	float_to_scaled(sig, shamt, x);
+	add_shifted(sig, SGNFC_LEN+1, shamt, EXPNT_LEN, 1-BIAS-SGNFC_LEN-1, x[FLOAT_LEN-1]);
+}
+
+/* Adds x * y exactly: the significands are multiplied at full width and the
+ * exponents added, without normalizing or rounding the product. Products of
+ * floats reach down to 2^-298 and up to 2^255, see dot_product for a window
+ * that holds all of them.
+ */
+inline void FloatAccumulator::add_product(const Float& x, const Float& y) {
+	const int sig_len = SGNFC_LEN+1;
+	Bit sig_x[sig_len], sig_y[sig_len], shamt_x[EXPNT_LEN], shamt_y[EXPNT_LEN];
+	float_to_scaled(sig_x, shamt_x, x);
+	float_to_scaled(sig_y, shamt_y, y);
+	Bit sig[2*sig_len], shamt[EXPNT_LEN+1];
+	mul_wide(sig, sig_x, sig_y, sig_len);
+	add_full(shamt, shamt+EXPNT_LEN, shamt_x, shamt_y, nullptr, EXPNT_LEN);
+	add_shifted(sig, 2*sig_len, shamt, EXPNT_LEN+1, 2*(1-BIAS-SGNFC_LEN-1),
+			x[FLOAT_LEN-1] ^ y[FLOAT_LEN-1]);
+}
+
+// Adds 1 if b is set, e.g. for counting; requires min_exp <= 0
+inline void FloatAccumulator::add(const Bit& b) {
+	assert(min_exp <= 0 and -min_exp < (int)size());
+	Bit carry = b;
+	for(size_t i = -min_exp; i < size(); ++i) {
+		Bit t = acc[i] & carry;
+		acc[i] = acc[i] ^ carry;
+		carry = t;
+	}
+}
+
+/* Rounds the accumulator to the nearest Float (ties to even), saturating to
+ * infinity. The normal result is found by normalizing the magnitude with a
+ * leading zero count; results below 2^-126 are read off the register directly.
+ */
+inline Float FloatAccumulator::value() const {
+	int mag_len = size() - 1;
+	Bit sign = acc[mag_len];
+	vector<Bit> mag(mag_len);
+	condNeg(sign, mag.data(), acc.bits.data(), mag_len);
+	auto weight = [&](int w) {
+		int i = w - min_exp;
+		return (i >= 0 and i < mag_len) ? mag[i] : Bit(false);
+	};
+
+	// subnormal candidate
+	int min_normal = 1 - BIAS - min_exp;
+	Bit tiny = !or_full(mag.data() + max(min_normal, 0), mag_len - min(max(min_normal, 0), mag_len));
+	Bit sub[SGNFC_LEN+EXPNT_LEN+2];
+	for(int i = 0; i < SGNFC_LEN+EXPNT_LEN; ++i)
+		sub[i] = (i < SGNFC_LEN) ? weight(1 - BIAS - SGNFC_LEN + i) : Bit(false);
+	sub[SGNFC_LEN+EXPNT_LEN] = weight(-BIAS - SGNFC_LEN);
+	int sticky_len = min(max(-BIAS - SGNFC_LEN - min_exp, 0), mag_len);
+	sub[SGNFC_LEN+EXPNT_LEN+1] = or_full(mag.data(), sticky_len);
+
+	// normal candidate, keeping at least a guard bit below the significand
+	int pad = max(SGNFC_LEN + 3 - mag_len, 0);
+	int len = mag_len + pad;
+	vector<Bit> x(len, Bit(false));
+	for(int i = 0; i < mag_len; ++i)
+		x[pad + i] = mag[i];
+	int stages = 0;
+	while((1<<stages) < len)
+		++stages;
+	const int ew = 16;
+	Integer lzc(ew, 0, PUBLIC);
+	for(int k = stages-1; k >= 0; --k) {
+		int s = 1<<k;
+		Bit z = !or_full(x.data() + len - s, s);
+		for(int t = len-1; t >= s; --t)
+			x[t] = x[t] ^ (z & (x[t] ^ x[t-s]));
+		for(int t = s-1; t >= 0; --t)
+			x[t] = x[t] & !z;
+		lzc[k] = z;
+	}
+	int top_exp = min_exp - pad + len - 1 + BIAS;
+	Integer e = Integer(ew, top_exp, PUBLIC) - lzc;
+	Bit norm[SGNFC_LEN+EXPNT_LEN+2];
+	for(int i = 0; i < SGNFC_LEN; ++i)
+		norm[i] = x[len - 1 - SGNFC_LEN + i];
+	for(int i = 0; i < EXPNT_LEN; ++i)
+		norm[SGNFC_LEN+i] = e[i];
+	norm[SGNFC_LEN+EXPNT_LEN] = x[len - 2 - SGNFC_LEN];
+	norm[SGNFC_LEN+EXPNT_LEN+1] = or_full(x.data(), len - 2 - SGNFC_LEN);
+	Bit overflow(false);
+	if(top_exp >= (1<<EXPNT_LEN) - 1)
+		overflow = (e >= Integer(ew, (1<<EXPNT_LEN) - 1, PUBLIC)) & !tiny;
+
+	Bit field[SGNFC_LEN+EXPNT_LEN+2];
+	ifThenElse(field, sub, norm, SGNFC_LEN+EXPNT_LEN+2, tiny);
+	Bit guard = field[SGNFC_LEN+EXPNT_LEN], sticky = field[SGNFC_LEN+EXPNT_LEN+1];
+	Bit carry = guard & (sticky | field[0]);
+	for(int i = 0; i < SGNFC_LEN+EXPNT_LEN; ++i) {
+		Bit t = field[i] & carry;
+		field[i] = field[i] ^ carry;
+		carry = t;
+	}
+
+	Float res;
+	for(int i = 0; i < SGNFC_LEN+EXPNT_LEN; ++i)
+		res[i] = field[i].If(overflow, Bit(i >= SGNFC_LEN));
+	res[FLOAT_LEN-1] = sign;
+	return res;
+}
+
+/* Fused dot product: every product is accumulated exactly and the sum is
+ * rounded once, instead of rounding after each multiply and add.
+ */
+inline Float dot_product(const Float * a, const Float * b, int n, int carry_bits = 32) {
+	FloatAccumulator acc(2*(1-BIAS-SGNFC_LEN), 2*BIAS+1, carry_bits);
+	for(int i = 0; i < n; ++i)
+		acc.add_product(a[i], b[i]);
+	return acc.value();
+}
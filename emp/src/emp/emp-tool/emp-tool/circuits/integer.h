@@ -6,9 +6,11 @@
 #include "emp-tool/circuits/comparable.h"
 #include "emp-tool/circuits/swappable.h"
 #include <vector>
+#include <memory>
 #include <bitset>
 #include <algorithm>
 #include <math.h>
+#include <stdexcept>
 using std::vector;
 using std::min;
 namespace emp {
@@ -58,6 +60,8 @@ class Integer : public Swappable<Integer>, public Comparable<Integer> { public:
 	Integer operator*(const Integer& rhs)const;
 	Integer operator/(const Integer& rhs)const;
 	Integer operator%(const Integer& rhs)const;
+	Integer udiv(const Integer& rhs, size_t quot_width = 0)const;
+	Integer umod(const Integer& rhs)const;
 	Integer operator&(const Integer& rhs)const;
 	Integer operator|(const Integer& rhs)const;
 
@@ -68,6 +72,21 @@ class Integer : public Swappable<Integer>, public Comparable<Integer> { public:
 	void revealBools(bool *bools, int party=PUBLIC) const;
 };
 
+// Labels of n input bits, fed by party in a single call unless public
+void feed_bits(block * labels, const bool * b, size_t n, int party);
+
+/* n Integers of len bits, out[i] holding input[i], fed in a single call:
+ * one OT batch and one message of correction bits for the whole column.
+ * Only party reads input, which may be nullptr for the other one.
+ */
+void feed_batch(Integer * out, size_t n, int len, const int64_t * input, int party);
+
+/* Reveals n Integers, possibly of different lengths, in a single call: out[i]
+ * is the value reveal<T>() would give for in[i].
+ */
+template<typename T>
+void reveal_batch(T * out, const Integer * in, size_t n, int party = PUBLIC);
+
 #include "emp-tool/circuits/integer.hpp"
 }
 #endif// INTEGER_H__
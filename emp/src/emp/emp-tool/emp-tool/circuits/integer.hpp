@@ -71,16 +71,35 @@ inline void mul_full(Bit * dest, const Bit * op1, const Bit * op2, int size) {
 	delete[] temp;
 }
 
+// Unsigned size x size -> 2*size bit product
+inline void mul_wide(Bit * dest, const Bit * op1, const Bit * op2, int size) {
+	Bit * sum = new Bit[2*size];
+	Bit * temp = new Bit[size];
+	for(int i = 0; i < 2*size; ++i)sum[i]=false;
+	for(int i=0;i<size;++i) {
+		for (int k = 0; k < size; ++k)
+			temp[k] = op1[k] & op2[i];
+		add_full(sum+i, sum+i+size, sum+i, temp, nullptr, size);
+	}
+	memcpy(dest, sum, sizeof(Bit)*2*size);
+	delete[] sum;
+	delete[] temp;
+}
+
+// size independent AND gates, handed to the circuit as one batch
+inline void and_batch(Bit * dest, const Bit * op1, const Bit * op2, int size) {
+	if(size > 0)
+		CircuitExecution::circ_exec->and_gate_batch((const block*)op1, (const block*)op2, (block*)dest, size);
+}
+
 inline void ifThenElse(Bit * dest, const Bit * tsrc, const Bit * fsrc, 
 		int size, Bit cond) {
-	Bit x, a;
-	int i = 0;
-	while(size-- > 0) {
-		x = tsrc[i] ^ fsrc[i];
-		a = cond & x;
-		dest[i] = a ^ fsrc[i];
-		++i;
-	}
+	vector<Bit> x(size), c(size, cond);
+	for(int i = 0; i < size; ++i)
+		x[i] = tsrc[i] ^ fsrc[i];
+	and_batch(x.data(), c.data(), x.data(), size);
+	for(int i = 0; i < size; ++i)
+		dest[i] = x[i] ^ fsrc[i];
 }
 inline void condNeg(Bit cond, Bit * dest, const Bit * src, int size) {
 	int i;
@@ -120,18 +139,78 @@ inline void div_full(Bit * vquot, Bit * vrem, const Bit * op1, const Bit * op2,
 	delete[] quot;
 }
 
+/* Non-restoring unsigned division of a size1-bit dividend by a size2-bit divisor.
+ * Only the lowest quot_size quotient bits are produced, which requires
+ * op1 < op2 * 2^quot_size (always true for quot_size == size1); the quotient
+ * bits above quot_size are zero. The partial remainder is size2+1 bits wide and
+ * every quotient bit costs a single add-or-subtract, with no restoring mux.
+ * vquot receives size1 bits, vrem receives size2 bits.
+ */
+inline void udiv_full(Bit * vquot, Bit * vrem, const Bit * op1, int size1,
+		const Bit * op2, int size2, int quot_size) {
+	int width = size2 + 1;
+	Bit * rem = new Bit[width];
+	Bit * divisor = new Bit[width];
+	Bit * temp = new Bit[width];
+	Bit * quot = new Bit[size1];
+	memcpy(divisor, op2, size2*sizeof(Bit));
+	divisor[size2] = false;
+	// bits of op1 above quot_size form the initial (non-negative) partial remainder
+	for(int i = 0; i < width; ++i)
+		rem[i] = (quot_size + i < size1) ? op1[quot_size + i] : Bit(false);
+	for(int i = quot_size; i < size1; ++i)
+		quot[i] = false;
+	Bit positive = true;
+	for(int i = quot_size-1; i >= 0; --i) {
+		for(int k = width-1; k > 0; --k)
+			rem[k] = rem[k-1];
+		rem[0] = op1[i];
+		// subtract while the partial remainder is non-negative, add it back otherwise
+		for(int k = 0; k < width; ++k)
+			temp[k] = divisor[k] ^ positive;
+		add_full(rem, nullptr, rem, temp, &positive, width);
+		positive = !rem[width-1];
+		quot[i] = positive;
+	}
+	if(vrem != nullptr) {
+		Bit negative = !positive;
+		for(int k = 0; k < width; ++k)
+			temp[k] = divisor[k] & negative;
+		add_full(rem, nullptr, rem, temp, nullptr, width);
+		memcpy(vrem, rem, size2*sizeof(Bit));
+	}
+	if(vquot != nullptr) memcpy(vquot, quot, size1*sizeof(Bit));
+	delete[] rem;
+	delete[] divisor;
+	delete[] temp;
+	delete[] quot;
+}
+
 
 inline void Integer::init(bool * b, int len, int party) {
 	bits.resize(len);
+	feed_bits((block *)bits.data(), b, len, party);
+}
+
+inline void feed_bits(block * labels, const bool * b, size_t n, int party) {
 	if (party == PUBLIC) {
 		block one = CircuitExecution::circ_exec->public_label(true);
 		block zero = CircuitExecution::circ_exec->public_label(false);
-		for(int i = 0; i < len; ++i)
-			bits[i] = b[i] ? one : zero;
-	}
-	else {
-		ProtocolExecution::prot_exec->feed((block *)bits.data(), party, b, len); 
+		for(size_t i = 0; i < n; ++i)
+			labels[i] = b[i] ? one : zero;
 	}
+	else ProtocolExecution::prot_exec->feed(labels, party, b, n);
+}
+
+inline void feed_batch(Integer * out, size_t n, int len, const int64_t * input, int party) {
+	std::unique_ptr<bool[]> b(new bool[n*len]());
+	if(input != nullptr)
+		for(size_t i = 0; i < n; ++i)
+			int_to_bool<int64_t>(b.get() + i*len, input[i], len);
+	vector<block> labels(n*len);
+	feed_bits(labels.data(), b.get(), n*len, party);
+	for(size_t i = 0; i < n; ++i)
+		out[i].bits.assign((Bit *)labels.data() + i*len, (Bit *)labels.data() + (i+1)*len);
 }
 
 inline Integer::Integer(int len, int64_t input, int party) {
@@ -162,8 +241,7 @@ inline Integer::Integer(T * input, int party) {
 inline Integer Integer::select(const Bit & select, const Integer & a) const{
 	assert(size() == a.size());
 	Integer res(*this);
-	for(size_t i = 0; i < size(); ++i)
-		res[i] = bits[i].select(select, a[i]);
+	ifThenElse(res.bits.data(), a.bits.data(), bits.data(), size(), select);
 	return res;
 }
 
@@ -222,6 +300,29 @@ inline string Integer::reveal<string>(int party) const {
 	return res;
 }
 
+template<typename T>
+inline void reveal_batch(T * out, const Integer * in, size_t n, int party) {
+	size_t total = 0;
+	for(size_t i = 0; i < n; ++i)
+		total += in[i].size();
+	vector<block> labels(total);
+	block * l = labels.data();
+	for(size_t i = 0; i < n; ++i) {
+		memcpy(l, in[i].bits.data(), in[i].size()*sizeof(block));
+		l += in[i].size();
+	}
+	std::unique_ptr<bool[]> b(new bool[total]);
+	ProtocolExecution::prot_exec->reveal(b.get(), party, labels.data(), total);
+	const bool * bi = b.get();
+	for(size_t i = 0; i < n; ++i) {
+		uint64_t v = 0;
+		for(size_t j = 0; j < min((size_t)64, in[i].size()); ++j)
+			v |= (uint64_t)bi[j] << j;
+		out[i] = (T)v;
+		bi += in[i].size();
+	}
+}
+
 // write the bits of this integer directly into memory wherever output points. 
 template<typename T>
 inline void Integer::reveal(T * output, const int party) const {
@@ -268,15 +369,15 @@ inline Integer Integer::operator^=(const Integer& rhs) {
 
 inline Integer Integer::operator|(const Integer& rhs) const {
 	Integer res(*this);
+	and_batch(res.bits.data(), bits.data(), rhs.bits.data(), size());
 	for(size_t i = 0; i < size(); ++i)
-		res.bits[i] = res.bits[i] | rhs.bits[i];
+		res.bits[i] = res.bits[i] ^ bits[i] ^ rhs.bits[i];
 	return res;
 }
 
 inline Integer Integer::operator&(const Integer& rhs) const {
 	Integer res(*this);
-	for(size_t i = 0; i < size(); ++i)
-		res.bits[i] = res.bits[i] & rhs.bits[i];
+	and_batch(res.bits.data(), bits.data(), rhs.bits.data(), size());
 	return res;
 }
 
@@ -336,10 +437,13 @@ inline Bit Integer::geq (const Integer& rhs) const {
 
 inline Bit Integer::equal(const Integer& rhs) const {
 	assert(size() == rhs.size());
-	Bit res(true);
+	vector<Bit> eq(size());
 	for(size_t i = 0; i < size(); ++i)
-		res = res & (bits[i] == rhs[i]);
-	return res;
+		eq[i] = (bits[i] == rhs[i]);
+	// AND tree, one batch per level
+	for(size_t n = size(); n > 1; n -= n/2)
+		and_batch(eq.data(), eq.data(), eq.data() + n - n/2, n/2);
+	return size() == 0 ? Bit(true) : eq[0];
 }
 
 /* Arithmethics
@@ -371,7 +475,7 @@ inline Integer Integer::operator/(const Integer& rhs) const {
 	Integer i1 = abs();
 	Integer i2 = rhs.abs();
 	Bit sign = bits[size()-1] ^ rhs[size()-1];
-	div_full(res.bits.data(), nullptr, i1.bits.data(), i2.bits.data(), size());
+	udiv_full(res.bits.data(), nullptr, i1.bits.data(), size(), i2.bits.data(), size(), size());
 	condNeg(sign, res.bits.data(), res.bits.data(), size());
 	return res;
 }
@@ -381,11 +485,27 @@ inline Integer Integer::operator%(const Integer& rhs) const {
 	Integer i1 = abs();
 	Integer i2 = rhs.abs();
 	Bit sign = bits[size()-1];
-	div_full(nullptr, res.bits.data(), i1.bits.data(), i2.bits.data(), size());
+	udiv_full(nullptr, res.bits.data(), i1.bits.data(), size(), i2.bits.data(), size(), size());
 	condNeg(sign, res.bits.data(), res.bits.data(), size());
 	return res;
 }
 
+// Unsigned division, skipping the abs/condNeg of operator/. rhs may be narrower
+// than *this; quot_width (if set) bounds the quotient, see udiv_full.
+inline Integer Integer::udiv(const Integer& rhs, size_t quot_width) const {
+	Integer res(*this);
+	if(quot_width == 0 or quot_width > size())
+		quot_width = size();
+	udiv_full(res.bits.data(), nullptr, bits.data(), size(), rhs.bits.data(), rhs.size(), quot_width);
+	return res;
+}
+
+inline Integer Integer::umod(const Integer& rhs) const {
+	Integer res(rhs);
+	udiv_full(nullptr, res.bits.data(), bits.data(), size(), rhs.bits.data(), rhs.size(), size());
+	return res;
+}
+
 inline Integer Integer::operator-() const {
 	return Integer(size(), 0, PUBLIC)-(*this);
 }
@@ -436,3 +556,32 @@ inline Integer Integer::modExp(Integer p, Integer q) {
 	}
 	return res;
 }
+
+/* Fixed-point dot product of n pairs of equally sized signed integers with
+ * frac_bits fractional bits. Products are kept at double width and summed
+ * exactly; the sum is scaled back (rounding toward negative infinity) once.
+ * The width comes from a[0], so n must be positive.
+ */
+inline Integer dot_product(const Integer * a, const Integer * b, int n, int frac_bits = 0) {
+	if(n <= 0)
+		throw std::invalid_argument("dot_product of no pairs has no width");
+	int size = a[0].size();
+	int carry_bits = 1;
+	while((1<<carry_bits) < n)
+		++carry_bits;
+	int width = 2*size + carry_bits;
+	Integer acc(width, 0, PUBLIC);
+	vector<Bit> prod(2*size), op(width);
+	for(int i = 0; i < n; ++i) {
+		Bit sign = a[i][size-1] ^ b[i][size-1];
+		Integer x = a[i].abs(), y = b[i].abs();
+		mul_wide(prod.data(), x.bits.data(), y.bits.data(), size);
+		for(int j = 0; j < width; ++j)
+			op[j] = (j < 2*size) ? prod[j] ^ sign : sign;
+		add_full(acc.bits.data(), nullptr, acc.bits.data(), op.data(), &sign, width);
+	}
+	Integer res(size, 0, PUBLIC);
+	for(int i = 0; i < size; ++i)
+		res[i] = acc[min(i + frac_bits, width - 1)];
+	return res;
+}
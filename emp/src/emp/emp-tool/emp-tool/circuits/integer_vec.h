@@ -0,0 +1,76 @@
+#ifndef EMP_INTEGER_VEC_H__
+#define EMP_INTEGER_VEC_H__
+
+#include "emp-tool/circuits/bit.h"
+#include "emp-tool/circuits/integer.h"
+#include <vector>
+#include <type_traits>
+using std::vector;
+namespace emp {
+
+/* A column of `length` Integers of the same width, for running one circuit
+ * over many rows. Storage is bit-sliced: bit i of every lane is contiguous,
+ * so each operator issues one batched gate call per bit position across all
+ * lanes instead of one gate call per lane and bit. Comparisons return a
+ * 1-bit IntegerVec, which doubles as a column of Bits for select, & and sum.
+ */
+class IntegerVec { public:
+	size_t length = 0;
+	vector<Bit> bits; // bit i of lane j is bits[i*length + j]
+
+	IntegerVec() {
+	}
+	// every lane holds the public constant input
+	IntegerVec(int width, size_t length, int64_t input);
+	// lane j holds input[j], fed by party in a single call
+	IntegerVec(int width, size_t length, const int64_t * input, int party);
+	// lane j is src[j]; all src[j] must have the same size
+	IntegerVec(const Integer * src, size_t length);
+	// every lane is a copy of src
+	IntegerVec(const Integer & src, size_t length);
+
+	size_t size() const {return length == 0 ? 0 : bits.size() / length;}
+	Bit * bit(size_t i) {return bits.data() + i*length;}
+	const Bit * bit(size_t i) const {return bits.data() + i*length;}
+
+	Integer operator[](size_t lane) const;
+	void set(size_t lane, const Integer & x);
+	IntegerVec lanes(size_t begin, size_t n) const;
+	void set_lanes(size_t begin, const IntegerVec & x);
+
+	IntegerVec& resize(size_t width, bool signed_extend = true);
+	// lanes where sel is set take rhs, the others keep this; sel is 1 bit wide
+	IntegerVec select(const IntegerVec & sel, const IntegerVec & rhs) const;
+
+	IntegerVec geq(const IntegerVec & rhs) const;
+	IntegerVec equal(const IntegerVec & rhs) const;
+	IntegerVec operator>=(const IntegerVec & rhs) const {return geq(rhs);}
+	IntegerVec operator<(const IntegerVec & rhs) const {return !geq(rhs);}
+	IntegerVec operator<=(const IntegerVec & rhs) const {return rhs.geq(*this);}
+	IntegerVec operator>(const IntegerVec & rhs) const {return !rhs.geq(*this);}
+	IntegerVec operator==(const IntegerVec & rhs) const {return equal(rhs);}
+	IntegerVec operator!=(const IntegerVec & rhs) const {return !equal(rhs);}
+
+	IntegerVec operator^(const IntegerVec & rhs) const;
+	IntegerVec operator&(const IntegerVec & rhs) const;
+	IntegerVec operator|(const IntegerVec & rhs) const;
+	IntegerVec operator!() const;
+	IntegerVec operator+(const IntegerVec & rhs) const;
+	IntegerVec operator-(const IntegerVec & rhs) const;
+	IntegerVec operator-() const;
+	IntegerVec operator*(const IntegerVec & rhs) const;
+
+	/* Sum of all lanes, truncated to width bits, by a tree of batched adds
+	 * that grow by one bit per level. Lanes are sign- or zero-extended as
+	 * given, so a 1-bit comparison result is counted with signed_extend false.
+	 */
+	Integer sum(size_t width, bool signed_extend = true) const;
+
+	// one reveal for all lanes; signed T are sign-extended from size() bits
+	template<typename T>
+		void reveal(T * output, int party = PUBLIC) const;
+};
+
+#include "emp-tool/circuits/integer_vec.hpp"
+}
+#endif// EMP_INTEGER_VEC_H__
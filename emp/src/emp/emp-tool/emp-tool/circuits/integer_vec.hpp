@@ -0,0 +1,280 @@
+// add_full on n bit-sliced lanes: operands hold size rows of n bits, carries one row
+inline void add_full_vec(Bit * dest, Bit * carryOut, const Bit * op1, const Bit * op2,
+		const Bit * carryIn, int size, size_t n) {
+	vector<Bit> carry(n), axc(n), bxc(n), t(n);
+	if(carryIn)
+		std::copy(carryIn, carryIn + n, carry.data());
+	if(size == 0) {
+		if(carryIn && carryOut)
+			std::copy(carryIn, carryIn + n, carryOut);
+		return;
+	}
+	// skip AND on last row if carryOut==NULL
+	int skipLast = (carryOut == nullptr);
+	int i = 0;
+	for(; i < size-skipLast; ++i) {
+		for(size_t j = 0; j < n; ++j) {
+			axc[j] = op1[i*n+j] ^ carry[j];
+			bxc[j] = op2[i*n+j] ^ carry[j];
+			dest[i*n+j] = op1[i*n+j] ^ bxc[j];
+		}
+		and_batch(t.data(), axc.data(), bxc.data(), n);
+		for(size_t j = 0; j < n; ++j)
+			carry[j] = carry[j] ^ t[j];
+	}
+	if(carryOut != nullptr)
+		std::copy(carry.data(), carry.data() + n, carryOut);
+	else for(size_t j = 0; j < n; ++j)
+		dest[i*n+j] = carry[j] ^ op2[i*n+j] ^ op1[i*n+j];
+}
+
+inline void sub_full_vec(Bit * dest, Bit * borrowOut, const Bit * op1, const Bit * op2,
+		const Bit * borrowIn, int size, size_t n) {
+	vector<Bit> borrow(n), bxa(n), bxc(n), t(n);
+	if(borrowIn)
+		std::copy(borrowIn, borrowIn + n, borrow.data());
+	if(size == 0) {
+		if(borrowIn && borrowOut)
+			std::copy(borrowIn, borrowIn + n, borrowOut);
+		return;
+	}
+	// skip AND on last row if borrowOut==NULL
+	int skipLast = (borrowOut == nullptr);
+	int i = 0;
+	for(; i < size-skipLast; ++i) {
+		for(size_t j = 0; j < n; ++j) {
+			bxa[j] = op1[i*n+j] ^ op2[i*n+j];
+			bxc[j] = borrow[j] ^ op2[i*n+j];
+			dest[i*n+j] = bxa[j] ^ borrow[j];
+		}
+		and_batch(t.data(), bxa.data(), bxc.data(), n);
+		for(size_t j = 0; j < n; ++j)
+			borrow[j] = borrow[j] ^ t[j];
+	}
+	if(borrowOut != nullptr)
+		std::copy(borrow.data(), borrow.data() + n, borrowOut);
+	else for(size_t j = 0; j < n; ++j)
+		dest[i*n+j] = op1[i*n+j] ^ op2[i*n+j] ^ borrow[j];
+}
+
+inline IntegerVec::IntegerVec(int width, size_t length, int64_t input): length(length) {
+	Integer x(width, input, PUBLIC);
+	bits.resize(width*length);
+	for(int i = 0; i < width; ++i)
+		for(size_t j = 0; j < length; ++j)
+			bits[i*length+j] = x[i];
+}
+
+inline IntegerVec::IntegerVec(int width, size_t length, const int64_t * input, int party): length(length) {
+	bool * b = new bool[width*length];
+	bool * tmp = new bool[width];
+	for(size_t j = 0; j < length; ++j) {
+		int_to_bool<int64_t>(tmp, input == nullptr ? 0 : input[j], width);
+		for(int i = 0; i < width; ++i)
+			b[i*length+j] = tmp[i];
+	}
+	bits.resize(width*length);
+	if(party == PUBLIC) {
+		block one = CircuitExecution::circ_exec->public_label(true);
+		block zero = CircuitExecution::circ_exec->public_label(false);
+		for(size_t i = 0; i < bits.size(); ++i)
+			bits[i] = b[i] ? one : zero;
+	} else
+		ProtocolExecution::prot_exec->feed((block *)bits.data(), party, b, bits.size());
+	delete[] b;
+	delete[] tmp;
+}
+
+inline IntegerVec::IntegerVec(const Integer * src, size_t length): length(length) {
+	size_t width = length == 0 ? 0 : src[0].size();
+	bits.resize(width*length);
+	for(size_t j = 0; j < length; ++j)
+		set(j, src[j]);
+}
+
+inline IntegerVec::IntegerVec(const Integer & src, size_t length): length(length) {
+	bits.resize(src.size()*length);
+	for(size_t j = 0; j < length; ++j)
+		set(j, src);
+}
+
+inline Integer IntegerVec::operator[](size_t lane) const {
+	Integer res;
+	res.bits.resize(size());
+	for(size_t i = 0; i < size(); ++i)
+		res.bits[i] = bits[i*length+lane];
+	return res;
+}
+
+inline void IntegerVec::set(size_t lane, const Integer & x) {
+	assert(x.size() == size());
+	for(size_t i = 0; i < size(); ++i)
+		bits[i*length+lane] = x.bits[i];
+}
+
+inline IntegerVec IntegerVec::lanes(size_t begin, size_t n) const {
+	IntegerVec res;
+	res.length = n;
+	res.bits.resize(size()*n);
+	for(size_t i = 0; i < size(); ++i)
+		std::copy(bit(i) + begin, bit(i) + begin + n, res.bit(i));
+	return res;
+}
+
+inline void IntegerVec::set_lanes(size_t begin, const IntegerVec & x) {
+	assert(x.size() == size() and begin + x.length <= length);
+	for(size_t i = 0; i < size(); ++i)
+		std::copy(x.bit(i), x.bit(i) + x.length, bit(i) + begin);
+}
+
+inline IntegerVec& IntegerVec::resize(size_t width, bool signed_extend) {
+	size_t old = size();
+	if(length == 0)
+		return *this;
+	bits.resize(width*length, Bit(false, PUBLIC));
+	if(signed_extend and old > 0)
+		for(size_t i = old; i < width; ++i)
+			std::copy(bit(old-1), bit(old-1) + length, bit(i));
+	return *this;
+}
+
+inline IntegerVec IntegerVec::select(const IntegerVec & sel, const IntegerVec & rhs) const {
+	assert(sel.size() == 1 and sel.length == length and rhs.size() == size() and rhs.length == length);
+	IntegerVec res(*this);
+	vector<Bit> c(bits.size());
+	for(size_t i = 0; i < size(); ++i)
+		std::copy(sel.bits.data(), sel.bits.data() + length, c.data() + i*length);
+	for(size_t k = 0; k < bits.size(); ++k)
+		res.bits[k] = bits[k] ^ rhs.bits[k];
+	and_batch(res.bits.data(), res.bits.data(), c.data(), bits.size());
+	for(size_t k = 0; k < bits.size(); ++k)
+		res.bits[k] = res.bits[k] ^ bits[k];
+	return res;
+}
+
+//Logical operations
+inline IntegerVec IntegerVec::operator^(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	IntegerVec res(*this);
+	for(size_t k = 0; k < bits.size(); ++k)
+		res.bits[k] = bits[k] ^ rhs.bits[k];
+	return res;
+}
+
+inline IntegerVec IntegerVec::operator&(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	IntegerVec res(*this);
+	and_batch(res.bits.data(), bits.data(), rhs.bits.data(), bits.size());
+	return res;
+}
+
+inline IntegerVec IntegerVec::operator|(const IntegerVec & rhs) const {
+	IntegerVec res = (*this) & rhs;
+	for(size_t k = 0; k < bits.size(); ++k)
+		res.bits[k] = res.bits[k] ^ bits[k] ^ rhs.bits[k];
+	return res;
+}
+
+inline IntegerVec IntegerVec::operator!() const {
+	IntegerVec res(*this);
+	for(size_t k = 0; k < bits.size(); ++k)
+		res.bits[k] = !bits[k];
+	return res;
+}
+
+//Comparisons
+inline IntegerVec IntegerVec::geq(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	IntegerVec a(*this), b(rhs);
+	a.resize(size()+1, true);
+	b.resize(size()+1, true);
+	IntegerVec tmp = a - b;
+	IntegerVec res;
+	res.length = length;
+	res.bits.assign(tmp.bit(size()), tmp.bit(size()) + length);
+	return !res;
+}
+
+inline IntegerVec IntegerVec::equal(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	vector<Bit> eq(bits.size());
+	for(size_t k = 0; k < bits.size(); ++k)
+		eq[k] = (bits[k] == rhs.bits[k]);
+	// AND tree over the rows, one batch per level
+	for(size_t n = size(); n > 1; n -= n/2)
+		and_batch(eq.data(), eq.data(), eq.data() + (n - n/2)*length, (n/2)*length);
+	IntegerVec res(1, length, size() == 0);
+	if(size() > 0)
+		std::copy(eq.data(), eq.data() + length, res.bits.data());
+	return res;
+}
+
+/* Arithmetics
+ */
+inline IntegerVec IntegerVec::operator+(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	IntegerVec res(*this);
+	add_full_vec(res.bits.data(), nullptr, bits.data(), rhs.bits.data(), nullptr, size(), length);
+	return res;
+}
+
+inline IntegerVec IntegerVec::operator-(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	IntegerVec res(*this);
+	sub_full_vec(res.bits.data(), nullptr, bits.data(), rhs.bits.data(), nullptr, size(), length);
+	return res;
+}
+
+inline IntegerVec IntegerVec::operator-() const {
+	return IntegerVec(size(), length, 0) - (*this);
+}
+
+inline IntegerVec IntegerVec::operator*(const IntegerVec & rhs) const {
+	assert(rhs.size() == size() and rhs.length == length);
+	size_t n = length;
+	int width = size();
+	IntegerVec res(width, n, 0);
+	vector<Bit> temp(bits.size()), b(bits.size());
+	for(int i = 0; i < width; ++i) {
+		for(int k = 0; k < width-i; ++k)
+			std::copy(rhs.bit(i), rhs.bit(i) + n, b.data() + k*n);
+		and_batch(temp.data(), bits.data(), b.data(), (width-i)*n);
+		add_full_vec(res.bit(i), nullptr, res.bit(i), temp.data(), nullptr, width-i, n);
+	}
+	return res;
+}
+
+inline Integer IntegerVec::sum(size_t width, bool signed_extend) const {
+	IntegerVec cur(*this);
+	cur.resize(min(size(), width), signed_extend);
+	while(cur.length > 1) {
+		size_t half = cur.length / 2, rest = cur.length - half;
+		size_t w = min(cur.size()+1, width);
+		IntegerVec lo = cur.lanes(0, half), hi = cur.lanes(rest, half), next = cur.lanes(0, rest);
+		lo.resize(w, signed_extend);
+		hi.resize(w, signed_extend);
+		next.resize(w, signed_extend);
+		next.set_lanes(0, lo + hi);
+		cur = next;
+	}
+	if(cur.length == 0)
+		return Integer(width, 0, PUBLIC);
+	cur.resize(width, signed_extend);
+	return cur[0];
+}
+
+template<typename T>
+inline void IntegerVec::reveal(T * output, int party) const {
+	size_t width = size();
+	bool * b = new bool[bits.size()];
+	ProtocolExecution::prot_exec->reveal(b, party, (block *)bits.data(), bits.size());
+	for(size_t j = 0; j < length; ++j) {
+		uint64_t v = 0;
+		for(size_t i = 0; i < min(width, (size_t)64); ++i)
+			v |= (uint64_t)b[i*length+j] << i;
+		if(std::is_signed<T>::value and width > 0 and width < 64 and b[(width-1)*length+j])
+			v |= ~0ULL << width;
+		output[j] = (T)v;
+	}
+	delete[] b;
+}
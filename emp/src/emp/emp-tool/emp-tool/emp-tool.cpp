@@ -1,10 +1,13 @@
 #include "emp-tool/execution/circuit_execution.h"
 #include "emp-tool/execution/protocol_execution.h"
+#include "emp-tool/execution/gate_profile.h"
 
 #ifndef THREADING
 emp::ProtocolExecution* emp::ProtocolExecution::prot_exec = nullptr;
 emp::CircuitExecution* emp::CircuitExecution::circ_exec = nullptr;
+emp::GateProfile* emp::GateProfile::profile = nullptr;
 #else
 __thread emp::ProtocolExecution* emp::ProtocolExecution::prot_exec = nullptr;
 __thread emp::CircuitExecution* emp::CircuitExecution::circ_exec = nullptr;
+__thread emp::GateProfile* emp::GateProfile::profile = nullptr;
 #endif
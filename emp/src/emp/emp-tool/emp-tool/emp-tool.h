@@ -7,15 +7,19 @@
 
 #include "emp-tool/circuits/bit.h"
 #include "emp-tool/circuits/circuit_file.h"
+#include "emp-tool/circuits/circuit_binary.h"
 #include "emp-tool/circuits/comparable.h"
 #include "emp-tool/circuits/float32.h"
+#include "emp-tool/circuits/float_accumulator.h"
 #include "emp-tool/circuits/integer.h"
+#include "emp-tool/circuits/integer_vec.h"
 #include "emp-tool/circuits/number.h"
 #include "emp-tool/circuits/swappable.h"
 #include "emp-tool/circuits/sha3_256.h"
 #include "emp-tool/circuits/aes_128_ctr.h"
 
 #include "emp-tool/utils/block.h"
+#include "emp-tool/utils/transpose.h"
 #include "emp-tool/utils/constants.h"
 #include "emp-tool/utils/hash.h"
 #include "emp-tool/utils/prg.h"
@@ -24,8 +28,11 @@
 #include "emp-tool/utils/ccrh.h"
 #include "emp-tool/utils/tccrh.h"
 #include "emp-tool/utils/utils.h"
+#include "emp-tool/utils/bit_vector.h"
 #include "emp-tool/utils/ThreadPool.h"
+#include "emp-tool/utils/work_stealing.h"
 #include "emp-tool/utils/group.h"
+#include "emp-tool/utils/p256.h"
 #include "emp-tool/utils/mitccrh.h"
 #include "emp-tool/utils/aes_opt.h"
 #include "emp-tool/utils/aes.h"
@@ -35,8 +42,13 @@
 #include "emp-tool/gc/halfgate_gen.h"
 #include "emp-tool/gc/privacy_free_eva.h"
 #include "emp-tool/gc/privacy_free_gen.h"
+#include "emp-tool/gc/three_halves_eva.h"
+#include "emp-tool/gc/three_halves_gen.h"
 
 #include "emp-tool/execution/circuit_execution.h"
 #include "emp-tool/execution/protocol_execution.h"
 #include "emp-tool/execution/plain_circ.h"
 #include "emp-tool/execution/plain_prot.h"
+#include "emp-tool/execution/circuit_capture.h"
+#include "emp-tool/execution/circuit_levels.h"
+#include "emp-tool/execution/gate_profile.h"
@@ -0,0 +1,413 @@
+#ifndef EMP_CIRCUIT_CAPTURE_H__
+#define EMP_CIRCUIT_CAPTURE_H__
+#include "emp-tool/utils/block.h"
+#include "emp-tool/utils/utils.h"
+#include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/execution/protocol_execution.h"
+#include "emp-tool/circuits/circuit_file.h"
+#include "emp-tool/gc/halfgate_gen.h"
+#include "emp-tool/gc/halfgate_eva.h"
+#include "emp-tool/gc/three_halves_gen.h"
+#include "emp-tool/gc/three_halves_eva.h"
+#include <vector>
+#include <cstdio>
+
+namespace emp {
+
+/*
+ * Capture and replay of circuits whose shape does not depend on the inputs.
+ * The program runs once under capture, which records its gates into a
+ * compact gate list with the public values folded away, along with the
+ * input and output wires of every feed and reveal call. Replay then executes
+ * the list directly: no C++ control flow is re-executed, and on the garbling
+ * backends the gates go through a non-virtual loop that batches the
+ * independent AND gates into garble_batch / eval_batch.
+ */
+class CapturedCircuit { public:
+	// Wires 0 and 1 are the public constants; every other wire is written once
+	const static uint32_t PUBLIC_ZERO = 0, PUBLIC_ONE = 1;
+	struct Segment {
+		int party;
+		uint32_t begin, length;
+	};
+	uint32_t num_wire = 2;
+	uint64_t num_and = 0;
+	// Four entries per gate, as in BristolFormat: in1, in2, out, type
+	std::vector<uint32_t> gates;
+	// Input wires are contiguous per feed call, in call order
+	std::vector<Segment> inputs;
+	// Output wires in reveal order; a reveal call covers outputs[begin, begin+length)
+	std::vector<uint32_t> outputs;
+	std::vector<Segment> reveals;
+	// Largest number of consecutive independent AND gates handed to a backend at once
+	size_t max_batch = 1024*16;
+
+	size_t num_gate() const {
+		return gates.size() / 4;
+	}
+	size_t input_size() const {
+		size_t n = 0;
+		for(auto & s : inputs) n += s.length;
+		return n;
+	}
+	size_t output_size() const {
+		return outputs.size();
+	}
+	void clear() {
+		num_wire = 2;
+		num_and = 0;
+		gates.clear();
+		inputs.clear();
+		outputs.clear();
+		reveals.clear();
+	}
+
+	void to_file(const char * filename) const {
+		FILE * f = fopen(filename, "wb");
+		if(f == nullptr)
+			error("cannot open circuit file");
+		uint64_t size[4] = {gates.size(), inputs.size(), outputs.size(), reveals.size()};
+		fwrite(&num_wire, sizeof(num_wire), 1, f);
+		fwrite(&num_and, sizeof(num_and), 1, f);
+		fwrite(size, sizeof(size), 1, f);
+		fwrite(gates.data(), sizeof(uint32_t), gates.size(), f);
+		fwrite(inputs.data(), sizeof(Segment), inputs.size(), f);
+		fwrite(outputs.data(), sizeof(uint32_t), outputs.size(), f);
+		fwrite(reveals.data(), sizeof(Segment), reveals.size(), f);
+		fclose(f);
+	}
+
+	void from_file(const char * filename) {
+		FILE * f = fopen(filename, "rb");
+		if(f == nullptr)
+			error("cannot open circuit file");
+		uint64_t size[4];
+		bool ok = fread(&num_wire, sizeof(num_wire), 1, f) == 1
+			and fread(&num_and, sizeof(num_and), 1, f) == 1
+			and fread(size, sizeof(size), 1, f) == 1;
+		if(ok) {
+			gates.resize(size[0]);
+			inputs.resize(size[1]);
+			outputs.resize(size[2]);
+			reveals.resize(size[3]);
+			ok = fread(gates.data(), sizeof(uint32_t), size[0], f) == size[0]
+				and fread(inputs.data(), sizeof(Segment), size[1], f) == size[1]
+				and fread(outputs.data(), sizeof(uint32_t), size[2], f) == size[2]
+				and fread(reveals.data(), sizeof(Segment), size[3], f) == size[3];
+		}
+		fclose(f);
+		if(!ok)
+			error("truncated circuit file");
+	}
+
+	/* Bristol circuit of the captured gates, with Alice's inputs and then
+	 * Bob's in feed order. As in finalize_plain_prot, the outputs are copied
+	 * to the last wires by XORing them with a zero wire.
+	 */
+	BristolFormat to_bristol() const {
+		std::vector<int> map(num_wire, -1);
+		int next = 0, n[2] = {0, 0};
+		for(int p = 0; p < 2; ++p) {
+			for(auto & s : inputs) {
+				if(s.party != (p == 0 ? ALICE : BOB))
+					continue;
+				for(uint32_t j = 0; j < s.length; ++j)
+					map[s.begin + j] = next++;
+				n[p] += s.length;
+			}
+		}
+		if(next == 0)
+			error("cannot write a circuit without inputs");
+		std::vector<int> arr;
+		auto emit = [&](int a, int b, int out, int type) -> void {
+			int g[4] = {a, b, out, type};
+			arr.insert(arr.end(), g, g+4);
+		};
+		map[PUBLIC_ZERO] = next++;
+		emit(0, 0, map[PUBLIC_ZERO], XOR_GATE);
+		map[PUBLIC_ONE] = next++;
+		emit(map[PUBLIC_ZERO], 0, map[PUBLIC_ONE], NOT_GATE);
+		for(size_t i = 0; i < num_gate(); ++i) {
+			const uint32_t * g = gates.data() + 4*i;
+			map[g[2]] = next++;
+			emit(map[g[0]], g[3] == NOT_GATE ? 0 : map[g[1]], map[g[2]], g[3]);
+		}
+		for(auto o : outputs)
+			emit(map[o], map[PUBLIC_ZERO], next++, XOR_GATE);
+		return BristolFormat(arr.size()/4, next, n[0], n[1], outputs.size(), arr.data());
+	}
+
+	/* Runs the circuit on exec and the current prot_exec. in holds one bit per
+	 * input wire, in feed order; the bits of the other party's inputs are
+	 * ignored. out receives one bit per output wire, in reveal order.
+	 */
+	template<typename Exec>
+	void execute(Exec * exec, const bool * in, bool * out) const;
+
+	// Sets the constants and the input wires of w, the first step of execute
+	void feed_inputs(CircuitExecution * exec, block * w, const bool * in) const {
+		w[PUBLIC_ZERO] = exec->public_label(false);
+		w[PUBLIC_ONE] = exec->public_label(true);
+		size_t pos = 0;
+		for(auto & s : inputs) {
+			ProtocolExecution::prot_exec->feed(w + s.begin, s.party, in + pos, s.length);
+			pos += s.length;
+		}
+	}
+
+	// Reveals the output wires of w, the last step of execute
+	void reveal_outputs(const block * w, bool * out) const {
+		std::vector<block> labels(outputs.size());
+		for(size_t i = 0; i < outputs.size(); ++i)
+			labels[i] = w[outputs[i]];
+		for(auto & s : reveals)
+			ProtocolExecution::prot_exec->reveal(out + s.begin, s.party, labels.data() + s.begin, s.length);
+	}
+};
+
+/*
+ * Records gates into a CapturedCircuit. Labels carry the tags of
+ * PlainCircExec in their low word and the wire id in the high word; gates
+ * with a public input, and XOR/AND of a wire with itself, are folded.
+ */
+class CaptureCircExec: public CircuitExecution { public:
+	const static uint64_t P1 = 1;
+	const static uint64_t P0 = 2;
+	const static uint64_t S = 3;
+	CapturedCircuit * circuit;
+	CaptureCircExec(CapturedCircuit * circuit) {
+		this->circuit = circuit;
+	}
+
+	static uint32_t wire(const block & a) {
+		return (uint32_t)((const uint64_t*)&a)[1];
+	}
+	static block label(uint32_t w) {
+		uint64_t tag = w == CapturedCircuit::PUBLIC_ZERO ? P0 : (w == CapturedCircuit::PUBLIC_ONE ? P1 : S);
+		return makeBlock(w, tag);
+	}
+	block new_wire() {
+		return label(circuit->num_wire++);
+	}
+	block gate(const block& a, const block& b, uint32_t type) {
+		block out = new_wire();
+		uint32_t g[4] = {wire(a), wire(b), wire(out), type};
+		circuit->gates.insert(circuit->gates.end(), g, g+4);
+		return out;
+	}
+
+	block public_label(bool b) override {
+		return label(b ? CapturedCircuit::PUBLIC_ONE : CapturedCircuit::PUBLIC_ZERO);
+	}
+	block and_gate(const block& a, const block& b) override {
+		uint32_t wa = wire(a), wb = wire(b);
+		if(wa == CapturedCircuit::PUBLIC_ZERO or wb == CapturedCircuit::PUBLIC_ZERO)
+			return public_label(false);
+		if(wa == CapturedCircuit::PUBLIC_ONE or wa == wb)
+			return b;
+		if(wb == CapturedCircuit::PUBLIC_ONE)
+			return a;
+		++circuit->num_and;
+		return gate(a, b, AND_GATE);
+	}
+	block xor_gate(const block& a, const block& b) override {
+		uint32_t wa = wire(a), wb = wire(b);
+		if(wa == wb)
+			return public_label(false);
+		if(wa == CapturedCircuit::PUBLIC_ZERO)
+			return b;
+		if(wb == CapturedCircuit::PUBLIC_ZERO)
+			return a;
+		if(wa == CapturedCircuit::PUBLIC_ONE)
+			return not_gate(b);
+		if(wb == CapturedCircuit::PUBLIC_ONE)
+			return not_gate(a);
+		return gate(a, b, XOR_GATE);
+	}
+	block not_gate(const block& a) override {
+		uint32_t wa = wire(a);
+		if(wa == CapturedCircuit::PUBLIC_ZERO or wa == CapturedCircuit::PUBLIC_ONE)
+			return public_label(wa == CapturedCircuit::PUBLIC_ZERO);
+		return gate(a, a, NOT_GATE);
+	}
+	uint64_t num_and() override {
+		return circuit->num_and;
+	}
+};
+
+// Records the input and output wires; reveals return zeros while capturing
+class CaptureProt: public ProtocolExecution { public:
+	CaptureCircExec * exec;
+	CaptureProt(CaptureCircExec * exec): ProtocolExecution(PUBLIC) {
+		this->exec = exec;
+	}
+
+	void feed(block * label, int party, const bool* b, int length) override {
+		if(party == PUBLIC) {
+			for(int i = 0; i < length; ++i)
+				label[i] = exec->public_label(b[i]);
+			return;
+		}
+		CapturedCircuit * c = exec->circuit;
+		c->inputs.push_back({party, c->num_wire, (uint32_t)length});
+		for(int i = 0; i < length; ++i)
+			label[i] = exec->new_wire();
+	}
+
+	void reveal(bool* b, int party, const block * label, int length) override {
+		CapturedCircuit * c = exec->circuit;
+		c->reveals.push_back({party, (uint32_t)c->outputs.size(), (uint32_t)length});
+		for(int i = 0; i < length; ++i) {
+			c->outputs.push_back(CaptureCircExec::wire(label[i]));
+			b[i] = false;
+		}
+	}
+};
+
+/* Everything run between start and finish is recorded into
+ * circuit instead of being executed; the current backends are restored
+ * afterwards, so capturing also works in the middle of a protocol run.
+ */
+class CircuitCapture { public:
+	CircuitExecution * saved_circ = nullptr;
+	ProtocolExecution * saved_prot = nullptr;
+	CaptureCircExec * exec = nullptr;
+	CaptureProt * prot = nullptr;
+
+	void start(CapturedCircuit * circuit) {
+		circuit->clear();
+		saved_circ = CircuitExecution::circ_exec;
+		saved_prot = ProtocolExecution::prot_exec;
+		exec = new CaptureCircExec(circuit);
+		prot = new CaptureProt(exec);
+		CircuitExecution::circ_exec = exec;
+		ProtocolExecution::prot_exec = prot;
+	}
+
+	void finish() {
+		CircuitExecution::circ_exec = saved_circ;
+		ProtocolExecution::prot_exec = saved_prot;
+		delete prot;
+		delete exec;
+		prot = nullptr;
+		exec = nullptr;
+	}
+};
+
+/*
+ * Gate dispatch of the replay loop. The garbling backends get free XOR and a
+ * direct call into their batched AND, without the virtual call and the
+ * public-wire checks of and_gate_batch (captured gates have no public input);
+ * any other backend goes through the CircuitExecution interface.
+ */
+template<typename Exec>
+struct ReplayGates {
+	Exec * exec;
+	ReplayGates(Exec * exec): exec(exec) {}
+	void and_batch(const block * a, const block * b, block * out, size_t n) {
+		exec->and_gate_batch(a, b, out, n);
+	}
+	block xor_gate(const block & a, const block & b) {
+		return exec->xor_gate(a, b);
+	}
+	block not_gate(const block & a) {
+		return exec->not_gate(a);
+	}
+};
+
+template<typename Exec>
+struct ReplayFreeXor {
+	Exec * exec;
+	block one;
+	ReplayFreeXor(Exec * exec): exec(exec) {
+		one = exec->public_label(true);
+	}
+	block xor_gate(const block & a, const block & b) {
+		return a ^ b;
+	}
+	block not_gate(const block & a) {
+		return a ^ one;
+	}
+};
+
+template<typename T>
+struct ReplayGates<HalfGateGen<T>>: ReplayFreeXor<HalfGateGen<T>> {
+	using ReplayFreeXor<HalfGateGen<T>>::ReplayFreeXor;
+	void and_batch(const block * a, const block * b, block * out, size_t n) {
+		this->exec->garble_batch(a, b, out, n);
+	}
+};
+
+template<typename T>
+struct ReplayGates<HalfGateEva<T>>: ReplayFreeXor<HalfGateEva<T>> {
+	using ReplayFreeXor<HalfGateEva<T>>::ReplayFreeXor;
+	void and_batch(const block * a, const block * b, block * out, size_t n) {
+		this->exec->eval_batch(a, b, out, n);
+	}
+};
+
+template<typename T>
+struct ReplayGates<ThreeHalvesGen<T>>: ReplayFreeXor<ThreeHalvesGen<T>> {
+	using ReplayFreeXor<ThreeHalvesGen<T>>::ReplayFreeXor;
+	void and_batch(const block * a, const block * b, block * out, size_t n) {
+		this->exec->garble_batch(a, b, out, n);
+	}
+};
+
+template<typename T>
+struct ReplayGates<ThreeHalvesEva<T>>: ReplayFreeXor<ThreeHalvesEva<T>> {
+	using ReplayFreeXor<ThreeHalvesEva<T>>::ReplayFreeXor;
+	void and_batch(const block * a, const block * b, block * out, size_t n) {
+		this->exec->eval_batch(a, b, out, n);
+	}
+};
+
+/* AND gates are queued until a gate reads the output of a queued one, or the
+ * queue is full, and then run as one batch. The tables are still produced in
+ * gate-list order, so both parties stay in sync however they are batched.
+ */
+template<typename Exec>
+void CapturedCircuit::execute(Exec * exec, const bool * in, bool * out) const {
+	ReplayGates<Exec> g(exec);
+	std::vector<block> w(num_wire);
+	feed_inputs(exec, w.data(), in);
+
+	size_t cap = std::min<size_t>(max_batch, num_and);
+	std::vector<block> a(cap), b(cap), o(cap);
+	std::vector<uint32_t> dst(cap);
+	std::vector<uint8_t> queued(num_wire, 0);
+	size_t n = 0;
+	auto flush = [&]() {
+		g.and_batch(a.data(), b.data(), o.data(), n);
+		for(size_t k = 0; k < n; ++k) {
+			w[dst[k]] = o[k];
+			queued[dst[k]] = 0;
+		}
+		n = 0;
+	};
+
+	const uint32_t * gate = gates.data();
+	for(size_t i = 0; i < num_gate(); ++i, gate += 4) {
+		uint32_t in1 = gate[0], in2 = gate[1], res = gate[2];
+		if(queued[in1] or queued[in2])
+			flush();
+		if(gate[3] == AND_GATE) {
+			a[n] = w[in1];
+			b[n] = w[in2];
+			dst[n++] = res;
+			queued[res] = 1;
+			if(n == cap)
+				flush();
+		} else if(gate[3] == XOR_GATE) {
+			w[res] = g.xor_gate(w[in1], w[in2]);
+		} else {
+			w[res] = g.not_gate(w[in1]);
+		}
+	}
+	if(n > 0)
+		flush();
+
+	reveal_outputs(w.data(), out);
+}
+}
+#endif// EMP_CIRCUIT_CAPTURE_H__
@@ -19,6 +19,11 @@ class CircuitExecution { public:
 	virtual block xor_gate(const block&in1, const block&in2) = 0;
 	virtual block not_gate(const block& in1) = 0;
 	virtual block public_label(bool b) = 0;
+	// n independent gates out[i] = a[i] & b[i]; out may alias a or b
+	virtual void and_gate_batch(const block * a, const block * b, block * out, size_t n) {
+		for(size_t i = 0; i < n; ++i)
+			out[i] = and_gate(a[i], b[i]);
+	}
 	virtual uint64_t num_and() {
 		return -1;
 	}
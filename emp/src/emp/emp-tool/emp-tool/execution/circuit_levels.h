@@ -0,0 +1,223 @@
+#ifndef EMP_CIRCUIT_LEVELS_H__
+#define EMP_CIRCUIT_LEVELS_H__
+#include "emp-tool/execution/circuit_capture.h"
+#include "emp-tool/utils/work_stealing.h"
+#include <vector>
+
+namespace emp {
+
+/*
+ * Level-scheduled execution of a gate list. The AND gates at the same AND
+ * depth are independent, so each level is garbled or evaluated as one batch,
+ * split across a work-stealing pool. Every AND gate hashes with the MITCCRH
+ * keys of its position in the level order, which a worker derives on its
+ * own, and the tables of a level are sent or received in one block; garbler
+ * and evaluator may use different numbers of threads, but both must run the
+ * levels, as the AND gates are not in gate-list order.
+ */
+
+// Position of the next AND gate in the key sequence of a MITCCRH (two keys per gate)
+inline uint64_t mitccrh_next_gate(const MITCCRH<8> & h) {
+	return (h.gid - 8 + h.key_used) / 2;
+}
+
+// Moves a MITCCRH to the keys of the given AND gate
+inline void mitccrh_skip_to(MITCCRH<8> & h, uint64_t gate) {
+	h.gid = 2*gate;
+	h.key_used = 8;
+}
+
+// Runs f(begin, end) over [0, n) in chunks of at least min_chunk gates, a
+// multiple of 4, on the pool and the calling thread
+template<typename F>
+inline void parallel_chunks(WorkStealingPool * pool, size_t n, size_t min_chunk, F f) {
+	if(pool == nullptr) {
+		f(0, n);
+		return;
+	}
+	size_t chunk = std::max(min_chunk, n / (8 * (pool->size() + 1)));
+	chunk = (chunk + 3) / 4 * 4;
+	pool->parallel_for(n, chunk, [&](int64_t s, int64_t e) {
+		f(s, e);
+	});
+}
+
+// Garbles n gates with the keys from gate number first on
+inline void halfgates_garble_range(const block * a, const block * b, block * out, block * table,
+		size_t n, const block & delta, const block & seed, uint64_t first) {
+	MITCCRH<8> h;
+	h.setS(seed);
+	h.renew_ks(2*first);
+	block H[16];
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		for(int j = 0; j < 4; ++j) {
+			H[4*j] = a[i+j];
+			H[4*j+1] = a[i+j] ^ delta;
+			H[4*j+2] = b[i+j];
+			H[4*j+3] = b[i+j] ^ delta;
+		}
+		h.hash_cir<8,2>(H);
+		for(int j = 0; j < 4; ++j)
+			out[i+j] = halfgates_garble_hashed(a[i+j], b[i+j], H+4*j, delta, table+2*(i+j));
+	}
+	for(; i < n; ++i)
+		out[i] = halfgates_garble(a[i], a[i]^delta, b[i], b[i]^delta, delta, table+2*i, &h);
+}
+
+inline void halfgates_eval_range(const block * a, const block * b, block * out, const block * table,
+		size_t n, const block & seed, uint64_t first) {
+	MITCCRH<8> h;
+	h.setS(seed);
+	h.renew_ks(2*first);
+	block H[8];
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		for(int j = 0; j < 4; ++j) {
+			H[2*j] = a[i+j];
+			H[2*j+1] = b[i+j];
+		}
+		h.hash_cir<8,1>(H);
+		for(int j = 0; j < 4; ++j)
+			out[i+j] = halfgates_eval_hashed(a[i+j], b[i+j], H+2*j, table+2*(i+j));
+	}
+	for(; i < n; ++i)
+		out[i] = halfgates_eval(a[i], b[i], table+2*i, &h);
+}
+
+// One level of AND gates; backends without a parallel path run it as a batch
+template<typename Exec>
+struct LevelGates: ReplayGates<Exec> {
+	LevelGates(Exec * exec): ReplayGates<Exec>(exec) {}
+	void and_level(WorkStealingPool * pool, size_t min_chunk, const block * a, const block * b, block * out, size_t n) {
+		this->and_batch(a, b, out, n);
+	}
+};
+
+template<typename T>
+struct LevelGates<HalfGateGen<T>>: ReplayGates<HalfGateGen<T>> {
+	std::vector<block> table;
+	LevelGates(HalfGateGen<T> * exec): ReplayGates<HalfGateGen<T>>(exec) {}
+	void and_level(WorkStealingPool * pool, size_t min_chunk, const block * a, const block * b, block * out, size_t n) {
+		HalfGateGen<T> * gen = this->exec;
+		uint64_t first = mitccrh_next_gate(gen->mitccrh);
+		table.resize(2*n);
+		parallel_chunks(pool, n, min_chunk, [&](size_t s, size_t e) {
+			halfgates_garble_range(a+s, b+s, out+s, table.data()+2*s, e-s, gen->delta, gen->mitccrh.start_point, first+s);
+		});
+		gen->io->send_block(table.data(), 2*n);
+		mitccrh_skip_to(gen->mitccrh, first + n);
+	}
+};
+
+template<typename T>
+struct LevelGates<HalfGateEva<T>>: ReplayGates<HalfGateEva<T>> {
+	std::vector<block> table;
+	LevelGates(HalfGateEva<T> * exec): ReplayGates<HalfGateEva<T>>(exec) {}
+	void and_level(WorkStealingPool * pool, size_t min_chunk, const block * a, const block * b, block * out, size_t n) {
+		HalfGateEva<T> * eva = this->exec;
+		uint64_t first = mitccrh_next_gate(eva->mitccrh);
+		table.resize(2*n);
+		eva->io->recv_block(table.data(), 2*n);
+		parallel_chunks(pool, n, min_chunk, [&](size_t s, size_t e) {
+			halfgates_eval_range(a+s, b+s, out+s, table.data()+2*s, e-s, eva->mitccrh.start_point, first+s);
+		});
+		mitccrh_skip_to(eva->mitccrh, first + n);
+	}
+};
+
+/*
+ * The gates of a circuit grouped by AND depth. Built once per circuit shape,
+ * from a captured circuit or any gate array in the BristolFormat layout.
+ */
+class LeveledCircuit { public:
+	struct Level {
+		// in1, in2, out of the AND gates of this depth
+		std::vector<uint32_t> and_gates;
+		// in1, in2, out, type of the XOR and NOT gates of this depth, in circuit order
+		std::vector<uint32_t> free_gates;
+	};
+	std::vector<Level> levels;
+	size_t num_wire = 0;
+	// Smallest number of gates given to a worker
+	size_t min_chunk = 256;
+
+	LeveledCircuit(const CapturedCircuit & c) {
+		build(c.gates.data(), c.num_gate(), c.num_wire);
+	}
+
+	template<typename T>
+	LeveledCircuit(const T * gates, size_t num_gate, size_t num_wire) {
+		build(gates, num_gate, num_wire);
+	}
+
+	size_t max_width() const {
+		size_t w = 0;
+		for(auto & l : levels)
+			w = std::max(w, l.and_gates.size() / 3);
+		return w;
+	}
+
+	// Runs the gates on the wires w, whose inputs are set
+	template<typename Exec>
+	void compute(Exec * exec, block * w, WorkStealingPool * pool = nullptr) const {
+		LevelGates<Exec> g(exec);
+		std::vector<block> a(max_width()), b(max_width()), o(max_width());
+		for(auto & l : levels) {
+			size_t n = l.and_gates.size() / 3;
+			const uint32_t * gate = l.and_gates.data();
+			for(size_t i = 0; i < n; ++i) {
+				a[i] = w[gate[3*i]];
+				b[i] = w[gate[3*i+1]];
+			}
+			if(n > 0)
+				g.and_level(pool, min_chunk, a.data(), b.data(), o.data(), n);
+			for(size_t i = 0; i < n; ++i)
+				w[gate[3*i+2]] = o[i];
+
+			gate = l.free_gates.data();
+			for(size_t i = 0; i < l.free_gates.size(); i += 4) {
+				if(gate[i+3] == XOR_GATE)
+					w[gate[i+2]] = g.xor_gate(w[gate[i]], w[gate[i+1]]);
+				else
+					w[gate[i+2]] = g.not_gate(w[gate[i]]);
+			}
+		}
+	}
+
+	// Same as CapturedCircuit::execute, with the gates run by level
+	template<typename Exec>
+	void execute(const CapturedCircuit & c, Exec * exec, const bool * in, bool * out, WorkStealingPool * pool = nullptr) const {
+		std::vector<block> w(c.num_wire);
+		c.feed_inputs(exec, w.data(), in);
+		compute(exec, w.data(), pool);
+		c.reveal_outputs(w.data(), out);
+	}
+
+private:
+	template<typename T>
+	void build(const T * gates, size_t num_gate, size_t num_wire) {
+		this->num_wire = num_wire;
+		std::vector<uint32_t> depth(num_wire, 0);
+		for(size_t i = 0; i < num_gate; ++i) {
+			const T * g = gates + 4*i;
+			uint32_t d = depth[g[0]];
+			if(g[3] != NOT_GATE)
+				d = std::max(d, depth[g[1]]);
+			if(g[3] == AND_GATE)
+				++d;
+			depth[g[2]] = d;
+			if(levels.size() <= d)
+				levels.resize(d + 1);
+			if(g[3] == AND_GATE) {
+				uint32_t a[3] = {(uint32_t)g[0], (uint32_t)g[1], (uint32_t)g[2]};
+				levels[d].and_gates.insert(levels[d].and_gates.end(), a, a+3);
+			} else {
+				uint32_t a[4] = {(uint32_t)g[0], (uint32_t)g[1], (uint32_t)g[2], (uint32_t)g[3]};
+				levels[d].free_gates.insert(levels[d].free_gates.end(), a, a+4);
+			}
+		}
+	}
+};
+}
+#endif// EMP_CIRCUIT_LEVELS_H__
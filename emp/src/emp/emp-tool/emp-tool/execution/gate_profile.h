@@ -0,0 +1,268 @@
+#ifndef EMP_GATE_PROFILE_H__
+#define EMP_GATE_PROFILE_H__
+#include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/utils/utils.h"
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace emp {
+
+/*
+ * Counts the gates sent to an inner CircuitExecution and forwards them. The
+ * counts are the gates the program issues; gates folded by the backend are
+ * counted, whereas num_and() of the backend only counts the garbled ones.
+ * Code that looks up the backend type of circ_exec, like the replay fast
+ * paths, takes its generic path while a counter is in front.
+ */
+class GateCounter: public CircuitExecution { public:
+	CircuitExecution * exec;
+	uint64_t and_gates = 0, xor_gates = 0, not_gates = 0;
+	GateCounter(CircuitExecution * exec): exec(exec) {}
+	block and_gate(const block& a, const block& b) override {
+		++and_gates;
+		return exec->and_gate(a, b);
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		and_gates += n;
+		exec->and_gate_batch(a, b, out, n);
+	}
+	block xor_gate(const block& a, const block& b) override {
+		++xor_gates;
+		return exec->xor_gate(a, b);
+	}
+	block not_gate(const block& a) override {
+		++not_gates;
+		return exec->not_gate(a);
+	}
+	block public_label(bool b) override {
+		return exec->public_label(b);
+	}
+	uint64_t num_and() override {
+		return exec->num_and();
+	}
+};
+
+/*
+ * Per-region profile of a computation. start() puts a GateCounter in front
+ * of circ_exec until finish(); in between, every GateScope adds the gates,
+ * bytes and wall time spent in its lifetime to a region named after it. A
+ * region is identified by its name and its parent, so a scope entered many
+ * times (e.g. in a loop) accumulates into one region; counts are inclusive
+ * of nested regions. The root region "total" covers start() to finish().
+ * Garbled AND gates come from num_and() of the backend, and are 0 if it does
+ * not count them; AND% refers to them when available.
+ */
+class GateProfile { public:
+#ifndef THREADING
+	static GateProfile * profile;
+#else
+	static __thread GateProfile * profile;
+#endif
+	struct Region {
+		std::string name;
+		size_t parent;
+		std::vector<size_t> children;
+		uint64_t calls = 0, and_gates = 0, xor_gates = 0, not_gates = 0, garbled = 0;
+		uint64_t sent = 0, received = 0;
+		double time = 0;	// microseconds
+	};
+	std::vector<Region> regions;
+
+	// Profiles without byte counts
+	void start() {
+		start(std::function<uint64_t()>(), std::function<uint64_t()>());
+	}
+
+	// Takes the byte counts from an IOChannel
+	template<typename IO>
+	void start(const IO * io) {
+		start([io]() {return io->counter;}, [io]() {return io->recv_counter;});
+	}
+
+	void start(std::function<uint64_t()> sent, std::function<uint64_t()> received) {
+		if(counter != nullptr)
+			error("profile already started");
+		bytes_sent = sent;
+		bytes_received = received;
+		regions.clear();
+		index.clear();
+		stack.clear();
+		counter = new GateCounter(CircuitExecution::circ_exec);
+		CircuitExecution::circ_exec = counter;
+		saved_profile = profile;
+		profile = this;
+		regions.push_back(Region());
+		regions[0].name = "total";
+		regions[0].parent = 0;
+		open(0);
+	}
+
+	void finish() {
+		if(counter == nullptr)
+			return;
+		while(!stack.empty())
+			leave();
+		CircuitExecution::circ_exec = counter->exec;
+		delete counter;
+		counter = nullptr;
+		profile = saved_profile;
+	}
+
+	~GateProfile() {
+		finish();
+	}
+
+	// Opens the child region name of the innermost open region
+	void enter(const std::string & name) {
+		size_t parent = stack.back().region;
+		auto key = std::make_pair(parent, name);
+		auto it = index.find(key);
+		size_t r;
+		if(it != index.end())
+			r = it->second;
+		else {
+			r = regions.size();
+			regions.push_back(Region());
+			regions[r].name = name;
+			regions[r].parent = parent;
+			regions[parent].children.push_back(r);
+			index[key] = r;
+		}
+		open(r);
+	}
+
+	// Closes the innermost open region
+	void leave() {
+		if(stack.empty())
+			return;
+		Open o = stack.back();
+		stack.pop_back();
+		Open now = snapshot(o.region);
+		Region & r = regions[o.region];
+		++r.calls;
+		r.and_gates += now.and_gates - o.and_gates;
+		r.xor_gates += now.xor_gates - o.xor_gates;
+		r.not_gates += now.not_gates - o.not_gates;
+		r.garbled += now.garbled - o.garbled;
+		r.sent += now.sent - o.sent;
+		r.received += now.received - o.received;
+		r.time += time_from(o.start);
+	}
+
+	// One line per region, children indented below their parent
+	void print(std::ostream & out = std::cout) const {
+		std::ios::fmtflags flags = out.flags();
+		out << std::left << std::setw(32) << "Region" << std::right
+			<< std::setw(10) << "Calls" << std::setw(14) << "AND" << std::setw(14) << "Garbled" << std::setw(8) << "AND%"
+			<< std::setw(14) << "XOR" << std::setw(12) << "NOT"
+			<< std::setw(12) << "Sent MB" << std::setw(12) << "Recv MB" << std::setw(12) << "Time ms" << std::endl;
+		if(!regions.empty())
+			print(out, 0, 0);
+		out.flags(flags);
+	}
+
+	// The region tree as JSON, times in milliseconds
+	std::string to_json() const {
+		std::ostringstream out;
+		if(!regions.empty())
+			to_json(out, 0);
+		return out.str();
+	}
+
+private:
+	struct Open {
+		size_t region;
+		uint64_t and_gates, xor_gates, not_gates, garbled, sent, received;
+		time_point<high_resolution_clock> start;
+	};
+	GateCounter * counter = nullptr;
+	GateProfile * saved_profile = nullptr;
+	std::function<uint64_t()> bytes_sent, bytes_received;
+	std::map<std::pair<size_t, std::string>, size_t> index;
+	std::vector<Open> stack;
+
+	Open snapshot(size_t region) const {
+		Open o;
+		o.region = region;
+		o.and_gates = counter->and_gates;
+		o.xor_gates = counter->xor_gates;
+		o.not_gates = counter->not_gates;
+		o.garbled = counter->exec->num_and();
+		if(o.garbled == (uint64_t)-1)
+			o.garbled = 0;
+		o.sent = bytes_sent ? bytes_sent() : 0;
+		o.received = bytes_received ? bytes_received() : 0;
+		o.start = clock_start();
+		return o;
+	}
+
+	void open(size_t region) {
+		stack.push_back(snapshot(region));
+	}
+
+	void print(std::ostream & out, size_t i, int depth) const {
+		const Region & r = regions[i];
+		bool garbled = regions[0].garbled > 0;
+		double total_and = garbled ? regions[0].garbled : regions[0].and_gates;
+		double and_gates = garbled ? r.garbled : r.and_gates;
+		out << std::left << std::setw(32) << (std::string(2*depth, ' ') + r.name) << std::right
+			<< std::setw(10) << r.calls << std::setw(14) << r.and_gates << std::setw(14) << r.garbled
+			<< std::setw(8) << std::fixed << std::setprecision(1) << (total_and > 0 ? 100 * and_gates / total_and : 0)
+			<< std::setw(14) << r.xor_gates << std::setw(12) << r.not_gates
+			<< std::setw(12) << std::setprecision(2) << r.sent / (1024 * 1024.0)
+			<< std::setw(12) << r.received / (1024 * 1024.0)
+			<< std::setw(12) << std::setprecision(1) << r.time / 1000 << std::endl;
+		for(auto c : r.children)
+			print(out, c, depth + 1);
+	}
+
+	void to_json(std::ostream & out, size_t i) const {
+		const Region & r = regions[i];
+		out << "{\"name\": \"";
+		for(char ch : r.name) {
+			if(ch == '"' or ch == '\\')
+				out << '\\';
+			out << ch;
+		}
+		out << "\", \"calls\": " << r.calls << ", \"and\": " << r.and_gates
+			<< ", \"garbled\": " << r.garbled << ", \"xor\": " << r.xor_gates << ", \"not\": " << r.not_gates
+			<< ", \"sent\": " << r.sent << ", \"received\": " << r.received
+			<< ", \"time_ms\": " << r.time / 1000 << ", \"children\": [";
+		for(size_t k = 0; k < r.children.size(); ++k) {
+			if(k > 0)
+				out << ", ";
+			to_json(out, r.children[k]);
+		}
+		out << "]}";
+	}
+};
+
+/*
+ * Profiles its own lifetime as a region of the active GateProfile, and does
+ * nothing when no profile is active:
+ *	{
+ *		GateScope s("digitize");
+ *		...
+ *	}
+ */
+class GateScope { public:
+	GateScope(const std::string & name): profile(GateProfile::profile) {
+		if(profile != nullptr)
+			profile->enter(name);
+	}
+	~GateScope() {
+		if(profile != nullptr)
+			profile->leave();
+	}
+	GateScope(const GateScope &) = delete;
+	GateScope & operator=(const GateScope &) = delete;
+private:
+	GateProfile * profile;
+};
+}
+#endif// EMP_GATE_PROFILE_H__
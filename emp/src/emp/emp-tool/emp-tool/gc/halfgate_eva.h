@@ -3,20 +3,18 @@
 #include "emp-tool/utils/utils.h"
 #include "emp-tool/utils/mitccrh.h"
 #include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/gc/public_wires.h"
 #include <iostream>
 namespace emp {
 
-inline block halfgates_eval(block A, block B, const block *table, MITCCRH<8> *mitccrh) {
+/* Output label from the hashes H = {H(A), H(B)} */
+inline block halfgates_eval_hashed(block A, block B, const block *H, const block *table) {
 	block HA, HB, W;
 	int sa, sb;
 
 	sa = getLSB(A);
 	sb = getLSB(B);
 
-	block H[2];
-	H[0] = A;
-	H[1] = B;
-	mitccrh->hash_cir<2,1>(H);
 	HA = H[0];
 	HB = H[1];
 
@@ -27,6 +25,14 @@ inline block halfgates_eval(block A, block B, const block *table, MITCCRH<8> *mi
 	return W;
 }
 
+inline block halfgates_eval(block A, block B, const block *table, MITCCRH<8> *mitccrh) {
+	block H[2];
+	H[0] = A;
+	H[1] = B;
+	mitccrh->hash_cir<2,1>(H);
+	return halfgates_eval_hashed(A, B, H, table);
+}
+
 
 template<typename T>
 class HalfGateEva:public CircuitExecution {
@@ -36,7 +42,7 @@ public:
 	MITCCRH<8> mitccrh;
 	HalfGateEva(T * io) :io(io) {
 		set_delta();
-		block tmp;
+		block tmp = zero_block;
 		io->recv_block(&tmp, 1);
 		mitccrh.setS(tmp);
 	}
@@ -47,12 +53,41 @@ public:
 		return constant[b];
 	}
 	block and_gate(const block& a, const block& b) override {
+		block res;
+		if(fold_and_gate(constant, a, b, &res))
+			return res;
+		return eval(a, b);
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		fold_and_gate_batch(constant, a, b, out, n,
+			[this](const block * a, const block * b, block * out, size_t n) {eval_batch(a, b, out, n);});
+	}
+	block eval(const block& a, const block& b) {
 		block table[2];
 		io->recv_block(table, 2);
 		return halfgates_eval(a, b, table, &mitccrh);
 	}
+	// See HalfGateGen::garble_batch
+	void eval_batch(const block * a, const block * b, block * out, size_t n) {
+		size_t i = 0;
+		for(; i < n and mitccrh.key_used % 8 != 0; ++i)
+			out[i] = eval(a[i], b[i]);
+		block H[8], table[8];
+		for(; i + 4 <= n; i += 4) {
+			io->recv_block(table, 8);
+			for(int j = 0; j < 4; ++j) {
+				H[2*j] = a[i+j];
+				H[2*j+1] = b[i+j];
+			}
+			mitccrh.hash_cir<8,1>(H);
+			for(int j = 0; j < 4; ++j)
+				out[i+j] = halfgates_eval_hashed(a[i+j], b[i+j], H+2*j, table+2*j);
+		}
+		for(; i < n; ++i)
+			out[i] = eval(a[i], b[i]);
+	}
 	block xor_gate(const block& a, const block& b) override {
-		return a ^ b;
+		return fold_xor_gate(constant, a, b);
 	}
 	block not_gate(const block&a) override {
 		return xor_gate(a, public_label(true));
@@ -3,6 +3,7 @@
 #include "emp-tool/utils/utils.h"
 #include "emp-tool/utils/mitccrh.h"
 #include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/gc/public_wires.h"
 #include <iostream>
 namespace emp {
 
@@ -11,18 +12,13 @@ namespace emp {
  * [REF] Implementation of "Two Halves Make a Whole"
  * https://eprint.iacr.org/2014/756.pdf
  */
-inline block halfgates_garble(block LA0, block A1, block LB0, block B1, block delta, block *table, MITCCRH<8> *mitccrh) {
+/* Garbled table and output label from the hashes H = {H(LA0), H(A1), H(LB0), H(B1)} */
+inline block halfgates_garble_hashed(block LA0, block LB0, const block *H, block delta, block *table) {
 	bool pa = getLSB(LA0);
 	bool pb = getLSB(LB0);
 	block HLA0, HA1, HLB0, HB1;
 	block tmp, W0;
 
-	block H[4];
-	H[0] = LA0;
-	H[1] = A1;
-	H[2] = LB0;
-	H[3] = B1;
-	mitccrh->hash_cir<2,2>(H);
 	HLA0 = H[0];
 	HA1 = H[1];
 	HLB0 = H[2];
@@ -40,6 +36,16 @@ inline block halfgates_garble(block LA0, block A1, block LB0, block B1, block de
 	return W0;
 }
 
+inline block halfgates_garble(block LA0, block A1, block LB0, block B1, block delta, block *table, MITCCRH<8> *mitccrh) {
+	block H[4];
+	H[0] = LA0;
+	H[1] = A1;
+	H[2] = LB0;
+	H[3] = B1;
+	mitccrh->hash_cir<2,2>(H);
+	return halfgates_garble_hashed(LA0, LB0, H, delta, table);
+}
+
 template<typename T>
 class HalfGateGen:public CircuitExecution {
 public:
@@ -64,13 +70,47 @@ public:
 		return constant[b];
 	}
 	block and_gate(const block& a, const block& b) override {
+		block res;
+		if(fold_and_gate(constant, a, b, &res))
+			return res;
+		return garble(a, b);
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		fold_and_gate_batch(constant, a, b, out, n,
+			[this](const block * a, const block * b, block * out, size_t n) {garble_batch(a, b, out, n);});
+	}
+	block garble(const block& a, const block& b) {
 		block table[2];
 		block res = halfgates_garble(a, a^delta, b, b^delta, delta, table, &mitccrh);
 		io->send_block(table, 2);
 		return res;
 	}
+	/* Four gates use all eight MITCCRH keys, so their 16 hashes run in a
+	 * single ParaEnc call. Keys and tables come out in the same order as with
+	 * garble, hence the evaluator may batch differently or not at all.
+	 */
+	void garble_batch(const block * a, const block * b, block * out, size_t n) {
+		size_t i = 0;
+		for(; i < n and mitccrh.key_used % 8 != 0; ++i)
+			out[i] = garble(a[i], b[i]);
+		block H[16], table[8];
+		for(; i + 4 <= n; i += 4) {
+			for(int j = 0; j < 4; ++j) {
+				H[4*j] = a[i+j];
+				H[4*j+1] = a[i+j] ^ delta;
+				H[4*j+2] = b[i+j];
+				H[4*j+3] = b[i+j] ^ delta;
+			}
+			mitccrh.hash_cir<8,2>(H);
+			for(int j = 0; j < 4; ++j)
+				out[i+j] = halfgates_garble_hashed(a[i+j], b[i+j], H+4*j, delta, table+2*j);
+			io->send_block(table, 8);
+		}
+		for(; i < n; ++i)
+			out[i] = garble(a[i], b[i]);
+	}
 	block xor_gate(const block&a, const block& b) override {
-		return a ^ b;
+		return fold_xor_gate(constant, a, b);
 	}
 	block not_gate(const block&a) override {
 		return xor_gate(a, public_label(true));
@@ -0,0 +1,87 @@
+#ifndef EMP_PUBLIC_WIRES_H__
+#define EMP_PUBLIC_WIRES_H__
+#include "emp-tool/utils/block.h"
+#include <vector>
+#include <utility>
+namespace emp {
+
+/*
+ * Constant folding for garbling backends. Public wires carry exactly the
+ * labels constant[0] / constant[1] handed out by public_label, which both
+ * parties recognize without communication: the garbler's constant[1] is the
+ * evaluator's one XOR delta, so a label matches a constant on one side iff it
+ * does on the other (up to a negligible chance of a label collision). Gates
+ * with a public input are folded identically by the garbler and the
+ * evaluator, and no table is sent for them.
+ */
+
+// 0 or 1 for a public wire, -1 otherwise
+inline int public_value(const block * constant, const block & a) {
+	if(cmpBlock(&a, constant, 1))
+		return 0;
+	if(cmpBlock(&a, constant+1, 1))
+		return 1;
+	return -1;
+}
+
+// Sets out to a AND b if either input is public
+inline bool fold_and_gate(const block * constant, const block & a, const block & b, block * out) {
+	int va = public_value(constant, a), vb = public_value(constant, b);
+	if(va == 0 or vb == 0)
+		*out = constant[0];
+	else if(va == 1)
+		*out = b;
+	else if(vb == 1)
+		*out = a;
+	else return false;
+	return true;
+}
+
+// XOR that keeps public results on the canonical public labels
+inline block fold_xor_gate(const block * constant, const block & a, const block & b) {
+	int va = public_value(constant, a);
+	if(va != -1) {
+		int vb = public_value(constant, b);
+		if(vb != -1)
+			return constant[va ^ vb];
+	}
+	return a ^ b;
+}
+
+/* Folds the public gates of a batch and runs batch(a, b, out, n) on the
+ * remaining ones, compacted so that they still fill whole hash batches
+ */
+template<typename F>
+inline void fold_and_gate_batch(const block * constant, const block * a, const block * b,
+		block * out, size_t n, F batch) {
+	size_t first = 0;
+	while(first < n and public_value(constant, a[first]) == -1 and public_value(constant, b[first]) == -1)
+		++first;
+	if(first == n) {
+		batch(a, b, out, n);
+		return;
+	}
+	std::vector<size_t> idx;
+	std::vector<std::pair<size_t, block>> folded;
+	for(size_t i = 0; i < first; ++i)
+		idx.push_back(i);
+	for(size_t i = first; i < n; ++i) {
+		block res;
+		if(fold_and_gate(constant, a[i], b[i], &res))
+			folded.push_back(std::make_pair(i, res));
+		else idx.push_back(i);
+	}
+	// gather before writing, out may alias a or b
+	std::vector<block> ca(idx.size()), cb(idx.size()), co(idx.size());
+	for(size_t k = 0; k < idx.size(); ++k) {
+		ca[k] = a[idx[k]];
+		cb[k] = b[idx[k]];
+	}
+	for(size_t k = 0; k < folded.size(); ++k)
+		out[folded[k].first] = folded[k].second;
+	batch(ca.data(), cb.data(), co.data(), idx.size());
+	for(size_t k = 0; k < idx.size(); ++k)
+		out[idx[k]] = co[k];
+}
+}
+#endif// EMP_PUBLIC_WIRES_H__
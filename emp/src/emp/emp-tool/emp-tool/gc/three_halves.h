@@ -0,0 +1,41 @@
+#ifndef EMP_THREE_HALVES_H__
+#define EMP_THREE_HALVES_H__
+#include "emp-tool/utils/block.h"
+#include <stdint.h>
+namespace emp {
+
+/*
+ * The three-halves garbling scheme: 1.5 blocks and 6 control bits per AND
+ * [REF] Implementation of "Three Halves Make a Whole? Beating the Half-Gates
+ * Lower Bound for Garbled Circuits"
+ * https://eprint.iacr.org/2021/749.pdf
+ *
+ * Labels are split into halves X = (X_L, X_R) and H(X) is the low half of
+ * the MITCCRH hash. With colors i = lsb(A), j = lsb(B), the evaluator gets
+ *   C_L = H(A) ^ H(A^B) ^ i(G0^G2) ^ jG2      ^ R_ij[L].(A_L, A_R, B_L, B_R)
+ *   C_R = H(B) ^ H(A^B) ^ iG2      ^ j(G1^G2) ^ R_ij[R].(A_L, A_R, B_L, B_R)
+ * The 2x4 bit matrix R_ij (row L in bits 0-3, row R in bits 4-7) is
+ * three_halves_M[ij] ^ three_halves_K[t]; the garbler draws the four t at
+ * random among the choices that make the gate correct, and sends each one
+ * encrypted under bits of H(A_i) ^ H(B_j). The four always XOR to zero, so
+ * only three are sent.
+ */
+const static uint8_t three_halves_M[4] = {0x00, 0x20, 0x04, 0x24};
+const static uint8_t three_halves_K[4] = {0x00, 0x6b, 0xbd, 0xd6};
+// t for color c is r ^ three_halves_t[lsb(A0)<<1 | lsb(B0)][c], with r random
+const static uint8_t three_halves_t[4][4] = {{0, 0, 0, 0}, {0, 2, 3, 1}, {0, 1, 2, 3}, {0, 3, 1, 2}};
+const static int THREE_HALVES_TABLE_BYTES = 3*sizeof(uint64_t)+1;
+
+inline uint64_t three_halves_half(const block & b, int k) {
+	return ((const uint64_t *)&b)[k];
+}
+
+// row . (A_L, A_R, B_L, B_R) for a 4-bit row of R_ij
+inline uint64_t three_halves_dot(int row, const uint64_t * x) {
+	uint64_t res = 0;
+	for(int k = 0; k < 4; ++k)
+		res ^= x[k] & (0 - (uint64_t)((row >> k) & 1));
+	return res;
+}
+}
+#endif// EMP_THREE_HALVES_H__
@@ -0,0 +1,105 @@
+#ifndef EMP_THREE_HALVES_EVA_H__
+#define EMP_THREE_HALVES_EVA_H__
+#include "emp-tool/utils/utils.h"
+#include "emp-tool/utils/mitccrh.h"
+#include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/gc/three_halves.h"
+#include "emp-tool/gc/public_wires.h"
+#include <iostream>
+namespace emp {
+
+/* Output label from the hashes H = {H(A), H(B), H(A^B)} */
+inline block three_halves_eval_hashed(block A, block B, const block *H, const uint8_t *table) {
+	int i = getLSB(A), j = getLSB(B), c = (i << 1) | j;
+	uint64_t G[3];
+	memcpy(G, table, sizeof(G));
+	int ctrl = table[sizeof(G)];
+	// the fourth control value is the XOR of the three that are sent
+	ctrl = (c == 3) ? (ctrl ^ (ctrl >> 2) ^ (ctrl >> 4)) : (ctrl >> (2*c));
+	int t = (ctrl ^ three_halves_half(H[0], 1) ^ three_halves_half(H[1], 1)) & 3;
+	int R = three_halves_M[c] ^ three_halves_K[t];
+	uint64_t x[4] = {three_halves_half(A, 0), three_halves_half(A, 1),
+		three_halves_half(B, 0), three_halves_half(B, 1)};
+
+	uint64_t C[2];
+	C[0] = three_halves_half(H[0], 0) ^ three_halves_half(H[2], 0) ^ three_halves_dot(R & 0xf, x);
+	C[1] = three_halves_half(H[1], 0) ^ three_halves_half(H[2], 0) ^ three_halves_dot(R >> 4, x);
+	if(i) {
+		C[0] ^= G[0] ^ G[2];
+		C[1] ^= G[2];
+	}
+	if(j) {
+		C[0] ^= G[2];
+		C[1] ^= G[1] ^ G[2];
+	}
+	return makeBlock(C[1], C[0]);
+}
+
+template<typename T>
+class ThreeHalvesEva:public CircuitExecution {
+public:
+	T * io;
+	block constant[2];
+	MITCCRH<6> mitccrh;
+	ThreeHalvesEva(T * io) :io(io) {
+		set_delta();
+		block tmp = zero_block;
+		io->recv_block(&tmp, 1);
+		mitccrh.setS(tmp);
+	}
+	void set_delta() {
+		io->recv_block(constant, 2);
+	}
+	block public_label(bool b) override {
+		return constant[b];
+	}
+	block and_gate(const block& a, const block& b) override {
+		block res;
+		if(fold_and_gate(constant, a, b, &res))
+			return res;
+		return eval(a, b);
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		fold_and_gate_batch(constant, a, b, out, n,
+			[this](const block * a, const block * b, block * out, size_t n) {eval_batch(a, b, out, n);});
+	}
+	block eval(const block& a, const block& b) {
+		block H[3] = {a, b, a ^ b};
+		uint8_t table[THREE_HALVES_TABLE_BYTES] = {};
+		io->recv_data(table, THREE_HALVES_TABLE_BYTES);
+		mitccrh.hash_cir<3,1>(H);
+		return three_halves_eval_hashed(a, b, H, table);
+	}
+	// See ThreeHalvesGen::garble_batch
+	void eval_batch(const block * a, const block * b, block * out, size_t n) {
+		size_t i = 0;
+		for(; i < n and mitccrh.key_used % 6 != 0; ++i)
+			out[i] = eval(a[i], b[i]);
+		block H[6];
+		uint8_t table[2*THREE_HALVES_TABLE_BYTES] = {};
+		for(; i + 2 <= n; i += 2) {
+			io->recv_data(table, 2*THREE_HALVES_TABLE_BYTES);
+			for(int j = 0; j < 2; ++j) {
+				H[3*j] = a[i+j];
+				H[3*j+1] = b[i+j];
+				H[3*j+2] = a[i+j] ^ b[i+j];
+			}
+			mitccrh.hash_cir<6,1>(H);
+			for(int j = 0; j < 2; ++j)
+				out[i+j] = three_halves_eval_hashed(a[i+j], b[i+j], H+3*j, table+j*THREE_HALVES_TABLE_BYTES);
+		}
+		for(; i < n; ++i)
+			out[i] = eval(a[i], b[i]);
+	}
+	block xor_gate(const block& a, const block& b) override {
+		return fold_xor_gate(constant, a, b);
+	}
+	block not_gate(const block&a) override {
+		return xor_gate(a, public_label(true));
+	}
+	uint64_t num_and() override {
+		return mitccrh.gid/3;
+	}
+};
+}
+#endif// EMP_THREE_HALVES_EVA_H__
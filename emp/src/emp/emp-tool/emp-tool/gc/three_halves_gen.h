@@ -0,0 +1,147 @@
+#ifndef EMP_THREE_HALVES_GEN_H__
+#define EMP_THREE_HALVES_GEN_H__
+#include "emp-tool/utils/utils.h"
+#include "emp-tool/utils/mitccrh.h"
+#include "emp-tool/utils/prg.h"
+#include "emp-tool/execution/circuit_execution.h"
+#include "emp-tool/gc/three_halves.h"
+#include "emp-tool/gc/public_wires.h"
+#include <iostream>
+namespace emp {
+
+/* Garbled table and output 0-label from the hashes
+ * H = {H(A0), H(A1), H(B0), H(B1), H(A0^B0), H(A0^B1)}; r in [0, 4) is the
+ * random choice of the R_ij matrices, see three_halves.h
+ */
+inline block three_halves_garble_hashed(block A0, block B0, const block *H, block delta, int r, uint8_t *table) {
+	int alpha = getLSB(A0), beta = getLSB(B0);
+	uint64_t T[4][2], G[3];
+	int ctrl[4];
+	for(int a = 0; a < 2; ++a)
+		for(int b = 0; b < 2; ++b) {
+			int c = ((a ^ alpha) << 1) | (b ^ beta);
+			int t = r ^ three_halves_t[(alpha << 1) | beta][c];
+			int R = three_halves_M[c] ^ three_halves_K[t];
+			block A = a ? A0 ^ delta : A0;
+			block B = b ? B0 ^ delta : B0;
+			uint64_t x[4] = {three_halves_half(A, 0), three_halves_half(A, 1),
+				three_halves_half(B, 0), three_halves_half(B, 1)};
+			const block & HA = H[a], & HB = H[2+b], & HX = H[4+(a^b)];
+			uint64_t and_mask = 0 - (uint64_t)(a & b);
+			T[(a<<1)|b][0] = three_halves_half(HA, 0) ^ three_halves_half(HX, 0)
+				^ three_halves_dot(R & 0xf, x) ^ (three_halves_half(delta, 0) & and_mask);
+			T[(a<<1)|b][1] = three_halves_half(HB, 0) ^ three_halves_half(HX, 0)
+				^ three_halves_dot(R >> 4, x) ^ (three_halves_half(delta, 1) & and_mask);
+			ctrl[c] = (t ^ three_halves_half(HA, 1) ^ three_halves_half(HB, 1)) & 3;
+		}
+	G[2] = T[2][1] ^ T[0][1];
+	G[0] = T[2][0] ^ T[0][0] ^ G[2];
+	G[1] = T[1][1] ^ T[0][1] ^ G[2];
+	memcpy(table, G, sizeof(G));
+	table[sizeof(G)] = ctrl[0] | (ctrl[1] << 2) | (ctrl[2] << 4);
+
+	uint64_t C[2] = {T[0][0], T[0][1]};
+	if(alpha) {
+		C[0] ^= G[0] ^ G[2];
+		C[1] ^= G[2];
+	}
+	if(beta) {
+		C[0] ^= G[2];
+		C[1] ^= G[1] ^ G[2];
+	}
+	return makeBlock(C[1], C[0]);
+}
+
+template<typename T>
+class ThreeHalvesGen:public CircuitExecution {
+public:
+	block delta;
+	T * io;
+	block constant[2];
+	MITCCRH<6> mitccrh;
+	PRG prg;
+	uint64_t coins = 0;
+	int coins_left = 0;
+	ThreeHalvesGen(T * io) :io(io) {
+		block tmp[2];
+		PRG().random_block(tmp, 2);
+		set_delta(tmp[0]);
+		io->send_block(tmp+1, 1);
+		mitccrh.setS(tmp[1]);
+	}
+	void set_delta(const block & _delta) {
+		delta = set_bit(_delta, 0);
+		PRG().random_block(constant, 2);
+		io->send_block(constant, 2);
+		constant[1] = constant[1] ^ delta;
+	}
+	block public_label(bool b) override {
+		return constant[b];
+	}
+	// two random bits per gate
+	int coin() {
+		if(coins_left == 0) {
+			prg.random_data(&coins, sizeof(coins));
+			coins_left = 32;
+		}
+		int r = coins & 3;
+		coins >>= 2;
+		--coins_left;
+		return r;
+	}
+	block and_gate(const block& a, const block& b) override {
+		block res;
+		if(fold_and_gate(constant, a, b, &res))
+			return res;
+		return garble(a, b);
+	}
+	void and_gate_batch(const block * a, const block * b, block * out, size_t n) override {
+		fold_and_gate_batch(constant, a, b, out, n,
+			[this](const block * a, const block * b, block * out, size_t n) {garble_batch(a, b, out, n);});
+	}
+	block garble(const block& a, const block& b) {
+		block H[6] = {a, a ^ delta, b, b ^ delta, a ^ b, a ^ b ^ delta};
+		uint8_t table[THREE_HALVES_TABLE_BYTES];
+		mitccrh.hash_cir<3,2>(H);
+		block res = three_halves_garble_hashed(a, b, H, delta, coin(), table);
+		io->send_data(table, THREE_HALVES_TABLE_BYTES);
+		return res;
+	}
+	// Two gates use all six MITCCRH keys, in the same order as with garble
+	void garble_batch(const block * a, const block * b, block * out, size_t n) {
+		size_t i = 0;
+		for(; i < n and mitccrh.key_used % 6 != 0; ++i)
+			out[i] = garble(a[i], b[i]);
+		block H[12];
+		uint8_t table[2*THREE_HALVES_TABLE_BYTES];
+		for(; i + 2 <= n; i += 2) {
+			for(int j = 0; j < 2; ++j) {
+				block ab = a[i+j] ^ b[i+j];
+				H[6*j] = a[i+j];
+				H[6*j+1] = a[i+j] ^ delta;
+				H[6*j+2] = b[i+j];
+				H[6*j+3] = b[i+j] ^ delta;
+				H[6*j+4] = ab;
+				H[6*j+5] = ab ^ delta;
+			}
+			mitccrh.hash_cir<6,2>(H);
+			for(int j = 0; j < 2; ++j)
+				out[i+j] = three_halves_garble_hashed(a[i+j], b[i+j], H+6*j, delta, coin(),
+						table+j*THREE_HALVES_TABLE_BYTES);
+			io->send_data(table, 2*THREE_HALVES_TABLE_BYTES);
+		}
+		for(; i < n; ++i)
+			out[i] = garble(a[i], b[i]);
+	}
+	block xor_gate(const block&a, const block& b) override {
+		return fold_xor_gate(constant, a, b);
+	}
+	block not_gate(const block&a) override {
+		return xor_gate(a, public_label(true));
+	}
+	uint64_t num_and() override {
+		return mitccrh.gid/3;
+	}
+};
+}
+#endif// EMP_THREE_HALVES_GEN_H__
@@ -9,13 +9,14 @@
 namespace emp {
 template<typename T> 
 class IOChannel { public:
-	uint64_t counter = 0;
+	uint64_t counter = 0, recv_counter = 0;
 	void send_data(const void * data, size_t nbyte) {
 		counter +=nbyte;
 		derived().send_data_internal(data, nbyte);
 	}
 
 	void recv_data(void * data, size_t nbyte) {
+		recv_counter += nbyte;
 		derived().recv_data_internal(data, nbyte);
 	}
 
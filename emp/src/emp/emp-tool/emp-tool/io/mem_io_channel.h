@@ -31,6 +31,14 @@ class MemIO: public IOChannel<MemIO> { public:
 	}
 	void clear() {
 		size = 0;
+		read_pos = 0;
+	}
+	// The bytes written and not read yet
+	const char * unread_data() const {
+		return buffer + read_pos;
+	}
+	int64_t unread_size() const {
+		return size - read_pos;
 	}
 	void send_data_internal(const void * data, int64_t len) {
 		if(size + len >= cap){
@@ -102,8 +102,23 @@ AES_set_encrypt_key(const block userkey, AES_KEY *key) {
 }
 
 #ifdef __x86_64__
+/*
+ * VAES runs an AES round on the four blocks of a 512-bit register with one
+ * instruction. It is used when the CPU has VAES and AVX-512, detected once;
+ * setting aes_use_vaes() to false goes back to AES-NI, e.g. to compare the
+ * two. Both give the same ciphertexts.
+ */
+inline bool & aes_use_vaes() {
+	static bool use = []() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("vaes") and __builtin_cpu_supports("avx512f")
+			and __builtin_cpu_supports("avx512bw");
+	}();
+	return use;
+}
+
 __attribute__((target("aes,sse2")))
-inline void AES_ecb_encrypt_blks(block *blks, unsigned int nblks, const AES_KEY *key) {
+inline void AES_ecb_encrypt_blks_ni(block *blks, unsigned int nblks, const AES_KEY *key) {
    for (unsigned int i = 0; i < nblks; ++i)
       blks[i] = _mm_xor_si128(blks[i], key->rd_key[0]);
    for (unsigned int j = 1; j < key->rounds; ++j)
@@ -112,6 +127,77 @@ inline void AES_ecb_encrypt_blks(block *blks, unsigned int nblks, const AES_KEY
    for (unsigned int i = 0; i < nblks; ++i)
       blks[i] = _mm_aesenclast_si128(blks[i], key->rd_key[key->rounds]);
 }
+
+EMP_AVX512_BEGIN
+// 32 blocks in flight, then four at a time, the last ones masked
+__attribute__((target("vaes,avx512f")))
+inline void AES_ecb_encrypt_blks_vaes(block *blks, unsigned int nblks, const AES_KEY *key) {
+	const unsigned int rounds = key->rounds;
+	__m512i k[15];
+	for (unsigned int j = 0; j <= rounds; ++j)
+		k[j] = _mm512_broadcast_i32x4(key->rd_key[j]);
+	unsigned int i = 0;
+	for (; i + 32 <= nblks; i += 32) {
+		__m512i x[8];
+		for (int l = 0; l < 8; ++l)
+			x[l] = _mm512_loadu_si512(blks + i + 4*l) ^ k[0];
+		for (unsigned int j = 1; j < rounds; ++j)
+			for (int l = 0; l < 8; ++l)
+				x[l] = _mm512_aesenc_epi128(x[l], k[j]);
+		for (int l = 0; l < 8; ++l)
+			_mm512_storeu_si512(blks + i + 4*l, _mm512_aesenclast_epi128(x[l], k[rounds]));
+	}
+	for (; i < nblks; i += 4) {
+		__mmask8 m = nblks - i >= 4 ? 0xFF : (1 << 2*(nblks - i)) - 1;
+		__m512i x = _mm512_maskz_loadu_epi64(m, blks + i) ^ k[0];
+		for (unsigned int j = 1; j < rounds; ++j)
+			x = _mm512_aesenc_epi128(x, k[j]);
+		_mm512_mask_storeu_epi64(blks + i, m, _mm512_aesenclast_epi128(x, k[rounds]));
+	}
+}
+
+inline void AES_ecb_encrypt_blks(block *blks, unsigned int nblks, const AES_KEY *key) {
+	if (nblks >= 4 and aes_use_vaes())
+		AES_ecb_encrypt_blks_vaes(blks, nblks, key);
+	else
+		AES_ecb_encrypt_blks_ni(blks, nblks, key);
+}
+
+/*
+ * Counter mode as PRG uses it: out[i] = E(makeBlock(0, counter + i)), with
+ * 32 blocks in flight.
+ */
+__attribute__((target("vaes,avx512f")))
+inline void AES_ctr_encrypt_blks_vaes(block *out, uint64_t counter, unsigned int nblks, const AES_KEY *key) {
+	const unsigned int rounds = key->rounds;
+	__m512i k[15];
+	for (unsigned int j = 0; j <= rounds; ++j)
+		k[j] = _mm512_broadcast_i32x4(key->rd_key[j]);
+	const __m512i four = _mm512_set_epi64(0, 4, 0, 4, 0, 4, 0, 4);
+	__m512i ctr = _mm512_set_epi64(0, counter + 3, 0, counter + 2, 0, counter + 1, 0, counter);
+	unsigned int i = 0;
+	for (; i + 32 <= nblks; i += 32) {
+		__m512i x[8];
+		for (int l = 0; l < 8; ++l) {
+			x[l] = ctr ^ k[0];
+			ctr = _mm512_add_epi64(ctr, four);
+		}
+		for (unsigned int j = 1; j < rounds; ++j)
+			for (int l = 0; l < 8; ++l)
+				x[l] = _mm512_aesenc_epi128(x[l], k[j]);
+		for (int l = 0; l < 8; ++l)
+			_mm512_storeu_si512(out + i + 4*l, _mm512_aesenclast_epi128(x[l], k[rounds]));
+	}
+	for (; i < nblks; i += 4) {
+		__mmask8 m = nblks - i >= 4 ? 0xFF : (1 << 2*(nblks - i)) - 1;
+		__m512i x = ctr ^ k[0];
+		ctr = _mm512_add_epi64(ctr, four);
+		for (unsigned int j = 1; j < rounds; ++j)
+			x = _mm512_aesenc_epi128(x, k[j]);
+		_mm512_mask_storeu_epi64(out + i, m, _mm512_aesenclast_epi128(x, k[rounds]));
+	}
+}
+EMP_AVX512_END
 #elif __aarch64__
 inline void AES_ecb_encrypt_blks(block *_blks, unsigned int nblks, const AES_KEY *key) {
    uint8x16_t * blks = (uint8x16_t*)(_blks);
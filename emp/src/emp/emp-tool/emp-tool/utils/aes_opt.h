@@ -24,7 +24,7 @@ static inline void ks_rounds(AES_KEY * keys, block con, block con3, block mask,
  * https://eprint.iacr.org/2015/751.pdf
  */
 template<int NumKeys>
-static inline void AES_opt_key_schedule(block* user_key, AES_KEY *keys) {
+static inline void AES_opt_key_schedule_ni(block* user_key, AES_KEY *keys) {
 	block con = _mm_set_epi32(1,1,1,1);
 	block con2 = _mm_set_epi32(0x1b,0x1b,0x1b,0x1b);
 	block con3 = _mm_set_epi32(0x07060504,0x07060504,0x0ffffffff,0x0ffffffff);
@@ -55,12 +55,53 @@ static inline void AES_opt_key_schedule(block* user_key, AES_KEY *keys) {
 	ks_rounds<NumKeys>(keys, con2, con3, mask, 10);
 }
 
+#ifdef __x86_64__
+EMP_AVX512_BEGIN
+// The same schedule for four keys at a time, one in each 128-bit lane
+template<int NumKeys>
+__attribute__((target("vaes,avx512f,avx512bw")))
+static inline void AES_opt_key_schedule_vaes(block* user_key, AES_KEY *keys) {
+	const __m512i con3 = _mm512_broadcast_i32x4(_mm_set_epi32(0x07060504,0x07060504,0x0ffffffff,0x0ffffffff));
+	const __m512i mask = _mm512_broadcast_i32x4(_mm_set_epi32(0x0c0f0e0d,0x0c0f0e0d,0x0c0f0e0d,0x0c0f0e0d));
+	__m512i key[NumKeys/4 > 0 ? NumKeys/4 : 1];
+	for(int g = 0; g < NumKeys/4; ++g)
+		key[g] = _mm512_loadu_si512(user_key + 4*g);
+	for(int i = 0; i < NumKeys; ++i) {
+		keys[i].rounds=10;
+		keys[i].rd_key[0] = user_key[i];
+	}
+	for(int r = 1; r <= 10; ++r) {
+		__m512i con = _mm512_set1_epi32(r <= 8 ? 1 << (r-1) : (r == 9 ? 0x1b : 0x36));
+		for(int g = 0; g < NumKeys/4; ++g) {
+			__m512i aux = _mm512_aesenclast_epi128(_mm512_shuffle_epi8(key[g], mask), con);
+			key[g] = _mm512_slli_epi64(key[g], 32) ^ key[g];
+			key[g] = _mm512_shuffle_epi8(key[g], con3) ^ key[g];
+			key[g] = aux ^ key[g];
+			keys[4*g].rd_key[r] = _mm512_castsi512_si128(key[g]);
+			keys[4*g+1].rd_key[r] = _mm512_extracti32x4_epi32(key[g], 1);
+			keys[4*g+2].rd_key[r] = _mm512_extracti32x4_epi32(key[g], 2);
+			keys[4*g+3].rd_key[r] = _mm512_extracti32x4_epi32(key[g], 3);
+		}
+	}
+}
+EMP_AVX512_END
+#endif
+
+template<int NumKeys>
+static inline void AES_opt_key_schedule(block* user_key, AES_KEY *keys) {
+#ifdef __x86_64__
+	if(NumKeys % 4 == 0 and aes_use_vaes())
+		return AES_opt_key_schedule_vaes<NumKeys>(user_key, keys);
+#endif
+	AES_opt_key_schedule_ni<NumKeys>(user_key, keys);
+}
+
 /*
  * With numKeys keys, use each key to encrypt numEncs blocks.
  */
 #ifdef __x86_64__
 template<int numKeys, int numEncs>
-static inline void ParaEnc(block *blks, AES_KEY *keys) {
+static inline void ParaEnc_ni(block *blks, AES_KEY *keys) {
 	block * first = blks;
 	for(size_t i = 0; i < numKeys; ++i) {
 		block K = keys[i].rd_key[0];
@@ -90,6 +131,46 @@ static inline void ParaEnc(block *blks, AES_KEY *keys) {
 		}
 	}
 }
+
+EMP_AVX512_BEGIN
+// Round r keys of blocks b to b+3, one per lane
+template<int numEncs>
+__attribute__((target("avx512f")))
+static inline __m512i vaes_round_keys(const AES_KEY *keys, int b, int r) {
+	if(numEncs % 4 == 0)
+		return _mm512_broadcast_i32x4(keys[b/numEncs].rd_key[r]);
+	if(numEncs == 2)
+		return _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_broadcastsi128_si256(keys[b/2].rd_key[r])),
+			_mm256_broadcastsi128_si256(keys[b/2+1].rd_key[r]), 1);
+	__m512i k = _mm512_zextsi128_si512(keys[b/numEncs].rd_key[r]);
+	k = _mm512_inserti32x4(k, keys[(b+1)/numEncs].rd_key[r], 1);
+	k = _mm512_inserti32x4(k, keys[(b+2)/numEncs].rd_key[r], 2);
+	return _mm512_inserti32x4(k, keys[(b+3)/numEncs].rd_key[r], 3);
+}
+
+// Needs numKeys*numEncs % 4 == 0
+template<int numKeys, int numEncs>
+__attribute__((target("vaes,avx512f")))
+static inline void ParaEnc_vaes(block *blks, AES_KEY *keys) {
+	const int n = numKeys*numEncs/4;
+	__m512i x[n > 0 ? n : 1];
+	for(int i = 0; i < n; ++i)
+		x[i] = _mm512_loadu_si512(blks + 4*i) ^ vaes_round_keys<numEncs>(keys, 4*i, 0);
+	for(int r = 1; r < 10; ++r)
+		for(int i = 0; i < n; ++i)
+			x[i] = _mm512_aesenc_epi128(x[i], vaes_round_keys<numEncs>(keys, 4*i, r));
+	for(int i = 0; i < n; ++i)
+		_mm512_storeu_si512(blks + 4*i, _mm512_aesenclast_epi128(x[i], vaes_round_keys<numEncs>(keys, 4*i, 10)));
+}
+EMP_AVX512_END
+
+template<int numKeys, int numEncs>
+static inline void ParaEnc(block *blks, AES_KEY *keys) {
+	if((numKeys*numEncs) % 4 == 0 and aes_use_vaes())
+		ParaEnc_vaes<numKeys, numEncs>(blks, keys);
+	else
+		ParaEnc_ni<numKeys, numEncs>(blks, keys);
+}
 #elif __aarch64__
 template<int numKeys, int numEncs>
 static inline void ParaEnc(block *_blks, AES_KEY *keys) {
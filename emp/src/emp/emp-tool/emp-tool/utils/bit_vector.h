@@ -0,0 +1,133 @@
+#ifndef EMP_BIT_VECTOR_H__
+#define EMP_BIT_VECTOR_H__
+#include "emp-tool/utils/block.h"
+#include "emp-tool/utils/utils.h"
+#include <vector>
+
+namespace emp {
+
+/*
+ * n bits packed 128 to a block, bit i in bit i%8 of byte i/8: the order of
+ * pack_bits and bool_to_block, so that 128 choice bits of IKNP are one block
+ * and the bytes go on the wire as they are. For choice, correction and
+ * reveal bits, which then take bool arrays only at the API. Bits past n are
+ * kept 0.
+ */
+class BitVector { public:
+	BitVector(size_t n = 0): data((n + 127) / 128, zero_block), n(n) {}
+
+	size_t size() const {
+		return n;
+	}
+
+	// Keeps the first min(n, size()) bits; new ones are 0
+	void resize(size_t n) {
+		data.resize((n + 127) / 128, zero_block);
+		this->n = n;
+		clear_tail();
+	}
+
+	block * blocks() {
+		return data.data();
+	}
+	const block * blocks() const {
+		return data.data();
+	}
+	uint8_t * bytes() {
+		return (uint8_t *)data.data();
+	}
+	const uint8_t * bytes() const {
+		return (const uint8_t *)data.data();
+	}
+	size_t byte_size() const {
+		return (n + 7) / 8;
+	}
+
+	bool operator[](size_t i) const {
+		return (words()[i/64] >> (i % 64)) & 1;
+	}
+
+	void set(size_t i, bool b) {
+		uint64_t & w = words()[i/64];
+		w = (w & ~(1ULL << (i % 64))) | ((uint64_t)b << (i % 64));
+	}
+
+	void from_bools(const bool * b, size_t n) {
+		resize(n);
+		pack_bits(bytes(), b, n);
+	}
+
+	void to_bools(bool * b) const {
+		unpack_bits(b, bytes(), n);
+	}
+
+	// Bit i from the LSB of in[i], as the choice bits of random COTs
+	void from_lsbs(const block * in, size_t n) {
+		resize(n);
+		uint64_t * w = words();
+		for(size_t i = 0; i < n; i += 64) {
+			uint64_t v = 0;
+			for(size_t j = 0; j < 64 and i + j < n; ++j)
+				v |= (uint64_t)getLSB(in[i + j]) << j;
+			w[i/64] = v;
+		}
+	}
+
+	// The 64 bits from bit i on, 0 past the end
+	uint64_t word_at(size_t i) const {
+		const uint64_t * w = words();
+		size_t k = i / 64, nw = 2 * data.size();
+		int s = i % 64;
+		uint64_t v = k < nw ? w[k] >> s : 0;
+		if(s != 0 and k + 1 < nw)
+			v |= w[k + 1] << (64 - s);
+		return v;
+	}
+
+	// Bits [dst, dst + len) from bits [src_off, src_off + len) of src
+	void copy(size_t dst, const BitVector & src, size_t src_off, size_t len) {
+		uint64_t * w = words();
+		for(size_t i = 0; i < len; i += 64) {
+			size_t k = len - i < 64 ? len - i : 64;
+			uint64_t mask = k == 64 ? ~0ULL : (1ULL << k) - 1;
+			uint64_t v = src.word_at(src_off + i) & mask;
+			size_t p = (dst + i) / 64;
+			int s = (dst + i) % 64;
+			w[p] = (w[p] & ~(mask << s)) | (v << s);
+			if(s != 0 and s + k > 64)
+				w[p + 1] = (w[p + 1] & ~(mask >> (64 - s))) | (v >> (64 - s));
+		}
+	}
+
+	BitVector & operator^=(const BitVector & b) {
+		if(b.n != n)
+			error("BitVector sizes differ");
+		xorBlocks_arr(data.data(), data.data(), b.data.data(), data.size());
+		return *this;
+	}
+
+	// Sets the bits past size() in the last block to 0, e.g. after bytes() was written
+	void clear_tail() {
+		if(n % 128 != 0) {
+			uint64_t * w = words() + 2 * (n / 128);
+			int s = n % 128;
+			if(s < 64) {
+				w[0] &= (1ULL << s) - 1;
+				w[1] = 0;
+			} else w[1] &= (1ULL << (s - 64)) - 1;
+		}
+	}
+
+private:
+	std::vector<block> data;
+	size_t n = 0;
+
+	uint64_t * words() {
+		return (uint64_t *)data.data();
+	}
+	const uint64_t * words() const {
+		return (const uint64_t *)data.data();
+	}
+};
+}
+#endif// EMP_BIT_VECTOR_H__
@@ -25,6 +25,17 @@ namespace emp {
 
 using block = __m128i;
 
+// Around AVX-512 code: the intrinsics of GCC 12 leave operands undefined in a way -Wall flags
+#if defined(__GNUC__) and !defined(__clang__)
+#define EMP_AVX512_BEGIN _Pragma("GCC diagnostic push") \
+	_Pragma("GCC diagnostic ignored \"-Wuninitialized\"") \
+	_Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define EMP_AVX512_END _Pragma("GCC diagnostic pop")
+#else
+#define EMP_AVX512_BEGIN
+#define EMP_AVX512_END
+#endif
+
 inline bool getLSB(const block & x) {
 	return (x[0] & 1) == 1;
 }
@@ -64,6 +64,15 @@ class Hash { public:
 		return _mm_load_si128((__m128i*)&digest[0]);
 	}
 
+	// KDF of a point given in the encoding of Point::to_bin
+	static block KDF(const unsigned char * in, size_t len, uint64_t id = 1) {
+		unsigned char tmp[136];
+		if(len + 8 > sizeof(tmp))
+			error("KDF input too long");
+		memcpy(tmp, in, len);
+		memcpy(tmp+len, &id, 8);
+		return hash_for_block(tmp, len+8);
+	}
 	static block KDF(Point &in, uint64_t id = 1) {
 		size_t len = in.size();
 		in.group->resize_scratch(len+8);
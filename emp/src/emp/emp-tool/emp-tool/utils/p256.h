@@ -0,0 +1,944 @@
+#ifndef EMP_P256_H__
+#define EMP_P256_H__
+#include "emp-tool/utils/prg.h"
+#include <vector>
+#include <cstring>
+
+/*
+ * NIST P-256 on 64-bit limbs, for the base OTs: the same curve, point
+ * encoding and results as the OpenSSL Group, without a BIGNUM or an
+ * EC_POINT per operation. Field elements are kept in Montgomery form
+ * (R = 2^256) and points in Jacobian coordinates; p256_normalize() turns a
+ * whole array back to affine with one inversion (Montgomery's trick).
+ * Multiples of a fixed point go through a P256Table, one row of 16 affine
+ * points per 5-bit window of the scalar, so a multiplication is 52 mixed
+ * additions and no doublings; other points take a 16-entry table each,
+ * normalized together across the batch. Secret scalars are recoded to
+ * signed digits and every lookup reads the whole row, so neither the time
+ * nor the memory accesses depend on them. With AVX-512 IFMA the batch
+ * multiplications run eight points at a time, one per 64-bit lane. Needs
+ * unsigned __int128.
+ */
+
+#ifdef __SIZEOF_INT128__
+#define EMP_HAS_P256
+
+namespace emp {
+
+typedef unsigned __int128 p256_u128;
+
+struct P256Fe { uint64_t v[4]; };
+struct P256Scalar { uint64_t v[4]; };
+// (0, 0) is not on the curve and stands for the point at infinity
+struct P256Affine { P256Fe x, y; };
+// Jacobian (X, Y, Z) for (X/Z^2, Y/Z^3); Z = 0 at infinity
+struct P256Point { P256Fe x, y, z; };
+
+const static int P256_WINDOW = 5;
+const static int P256_WINDOWS = 52;
+const static int P256_ROW = 1 << (P256_WINDOW - 1);
+const static size_t P256_POINT_SIZE = 65;
+
+const static P256Fe p256_p = {{0xffffffffffffffffULL, 0x00000000ffffffffULL, 0x0000000000000000ULL, 0xffffffff00000001ULL}};
+const static P256Scalar p256_n = {{0xf3b9cac2fc632551ULL, 0xbce6faada7179e84ULL, 0xffffffffffffffffULL, 0xffffffff00000000ULL}};
+// R mod p and R^2 mod p
+const static P256Fe p256_one = {{0x0000000000000001ULL, 0xffffffff00000000ULL, 0xffffffffffffffffULL, 0x00000000fffffffeULL}};
+const static P256Fe p256_rr = {{0x0000000000000003ULL, 0xfffffffbffffffffULL, 0xfffffffffffffffeULL, 0x00000004fffffffdULL}};
+const static P256Fe p256_b = {{0x3bce3c3e27d2604bULL, 0x651d06b0cc53b0f6ULL, 0xb3ebbd55769886bcULL, 0x5ac635d8aa3a93e7ULL}};
+const static P256Fe p256_gx = {{0xf4a13945d898c296ULL, 0x77037d812deb33a0ULL, 0xf8bce6e563a440f2ULL, 0x6b17d1f2e12c4247ULL}};
+const static P256Fe p256_gy = {{0xcbb6406837bf51f5ULL, 0x2bce33576b315eceULL, 0x8ee7eb4a7c0f9e16ULL, 0x4fe342e2fe1a7f9bULL}};
+
+// All ones if a == b, else 0
+inline uint64_t p256_eq_mask(uint64_t a, uint64_t b) {
+	return (uint64_t)0 - (((a ^ b) - 1) >> 63 & ~((a ^ b) >> 63));
+}
+
+inline void p256_fe_cmov(P256Fe &r, const P256Fe &a, uint64_t mask) {
+	for(int i = 0; i < 4; ++i)
+		r.v[i] ^= (r.v[i] ^ a.v[i]) & mask;
+}
+
+inline uint64_t p256_fe_is_zero(const P256Fe &a) {
+	return p256_eq_mask(a.v[0] | a.v[1] | a.v[2] | a.v[3], 0);
+}
+
+// Word-sized add with carry, subtract with borrow, and multiply-add
+inline uint64_t p256_adc(uint64_t a, uint64_t b, uint64_t &carry) {
+#ifdef __x86_64__
+	unsigned long long r;
+	carry = _addcarry_u64((unsigned char)carry, a, b, &r);
+	return r;
+#else
+	p256_u128 s = (p256_u128)a + b + carry;
+	carry = (uint64_t)(s >> 64);
+	return (uint64_t)s;
+#endif
+}
+
+inline uint64_t p256_sbb(uint64_t a, uint64_t b, uint64_t &borrow) {
+#ifdef __x86_64__
+	unsigned long long r;
+	borrow = _subborrow_u64((unsigned char)borrow, a, b, &r);
+	return r;
+#else
+	p256_u128 d = (p256_u128)a - b - borrow;
+	borrow = (uint64_t)(d >> 64) & 1;
+	return (uint64_t)d;
+#endif
+}
+
+// a + carry for a carry word, high word in carry
+inline uint64_t p256_addw(uint64_t a, uint64_t &carry) {
+	p256_u128 s = (p256_u128)a + carry;
+	carry = (uint64_t)(s >> 64);
+	return (uint64_t)s;
+}
+
+// a * b + c + carry, high word in carry
+inline uint64_t p256_mac(uint64_t a, uint64_t b, uint64_t c, uint64_t &carry) {
+	p256_u128 s = (p256_u128)a * b + c + carry;
+	carry = (uint64_t)(s >> 64);
+	return (uint64_t)s;
+}
+
+// r = t - p if the 257-bit value (hi, t0..t3) is at least p, else t
+inline void p256_reduce_once(P256Fe &r, uint64_t t0, uint64_t t1, uint64_t t2, uint64_t t3, uint64_t hi) {
+	uint64_t borrow = 0;
+	uint64_t s0 = p256_sbb(t0, p256_p.v[0], borrow);
+	uint64_t s1 = p256_sbb(t1, p256_p.v[1], borrow);
+	uint64_t s2 = p256_sbb(t2, p256_p.v[2], borrow);
+	uint64_t s3 = p256_sbb(t3, p256_p.v[3], borrow);
+	uint64_t keep = (uint64_t)0 - (borrow & ~hi & 1);
+	r.v[0] = (t0 & keep) | (s0 & ~keep);
+	r.v[1] = (t1 & keep) | (s1 & ~keep);
+	r.v[2] = (t2 & keep) | (s2 & ~keep);
+	r.v[3] = (t3 & keep) | (s3 & ~keep);
+}
+
+inline void p256_fe_add(P256Fe &r, const P256Fe &a, const P256Fe &b) {
+	uint64_t carry = 0;
+	uint64_t t0 = p256_adc(a.v[0], b.v[0], carry);
+	uint64_t t1 = p256_adc(a.v[1], b.v[1], carry);
+	uint64_t t2 = p256_adc(a.v[2], b.v[2], carry);
+	uint64_t t3 = p256_adc(a.v[3], b.v[3], carry);
+	p256_reduce_once(r, t0, t1, t2, t3, carry);
+}
+
+inline void p256_fe_sub(P256Fe &r, const P256Fe &a, const P256Fe &b) {
+	uint64_t borrow = 0;
+	uint64_t t0 = p256_sbb(a.v[0], b.v[0], borrow);
+	uint64_t t1 = p256_sbb(a.v[1], b.v[1], borrow);
+	uint64_t t2 = p256_sbb(a.v[2], b.v[2], borrow);
+	uint64_t t3 = p256_sbb(a.v[3], b.v[3], borrow);
+	uint64_t mask = (uint64_t)0 - borrow, carry = 0;
+	r.v[0] = p256_adc(t0, p256_p.v[0] & mask, carry);
+	r.v[1] = p256_adc(t1, p256_p.v[1] & mask, carry);
+	r.v[2] = p256_adc(t2, p256_p.v[2] & mask, carry);
+	r.v[3] = p256_adc(t3, p256_p.v[3] & mask, carry);
+}
+
+inline void p256_fe_neg(P256Fe &r, const P256Fe &a) {
+	const P256Fe zero = {{0, 0, 0, 0}};
+	p256_fe_sub(r, zero, a);
+}
+
+// Montgomery product a * b / R mod p. Since p = -1 mod 2^64, the
+// reduction multiplier of each round is just the low limb.
+inline void p256_fe_mul(P256Fe &r, const P256Fe &a, const P256Fe &b) {
+	const uint64_t a0 = a.v[0], a1 = a.v[1], a2 = a.v[2], a3 = a.v[3];
+	uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+	for(int i = 0; i < 4; ++i) {
+		uint64_t bi = b.v[i], c = 0, t5;
+		t0 = p256_mac(a0, bi, t0, c);
+		t1 = p256_mac(a1, bi, t1, c);
+		t2 = p256_mac(a2, bi, t2, c);
+		t3 = p256_mac(a3, bi, t3, c);
+		t4 = p256_addw(t4, c);
+		t5 = c;
+		// t += t0 * p, then drop the low limb, which is now 0 with carry t0
+		uint64_t m = t0;
+		c = m;
+		t0 = p256_mac(m, p256_p.v[1], t1, c);
+		t1 = p256_addw(t2, c);
+		t2 = p256_mac(m, p256_p.v[3], t3, c);
+		t3 = p256_addw(t4, c);
+		t4 = t5 + c;
+	}
+	p256_reduce_once(r, t0, t1, t2, t3, t4);
+}
+
+inline void p256_fe_sqr(P256Fe &r, const P256Fe &a) {
+	p256_fe_mul(r, a, a);
+}
+
+inline void p256_fe_sqr_n(P256Fe &r, const P256Fe &a, int n) {
+	r = a;
+	for(int i = 0; i < n; ++i)
+		p256_fe_sqr(r, r);
+}
+
+// a^(p-2); the exponent is public, so a fixed addition chain
+inline void p256_fe_inv(P256Fe &r, const P256Fe &a) {
+	P256Fe x2, x3, x6, x12, x15, x30, x32, t;
+	p256_fe_sqr(t, a);
+	p256_fe_mul(x2, t, a);
+	p256_fe_sqr(t, x2);
+	p256_fe_mul(x3, t, a);
+	p256_fe_sqr_n(t, x3, 3);
+	p256_fe_mul(x6, t, x3);
+	p256_fe_sqr_n(t, x6, 6);
+	p256_fe_mul(x12, t, x6);
+	p256_fe_sqr_n(t, x12, 3);
+	p256_fe_mul(x15, t, x3);
+	p256_fe_sqr_n(t, x15, 15);
+	p256_fe_mul(x30, t, x15);
+	p256_fe_sqr_n(t, x30, 2);
+	p256_fe_mul(x32, t, x2);
+	// p - 2 = 1^32 0^31 1 0^96 1^64 1^30 0 1
+	p256_fe_sqr_n(t, x32, 32);
+	p256_fe_mul(t, t, a);
+	p256_fe_sqr_n(t, t, 128);
+	p256_fe_mul(t, t, x32);
+	p256_fe_sqr_n(t, t, 32);
+	p256_fe_mul(t, t, x32);
+	p256_fe_sqr_n(t, t, 30);
+	p256_fe_mul(t, t, x30);
+	p256_fe_sqr_n(t, t, 2);
+	p256_fe_mul(r, t, a);
+}
+
+// Big-endian bytes to Montgomery form; false if not below p
+inline bool p256_fe_from_bytes(P256Fe &r, const unsigned char * in) {
+	P256Fe t;
+	for(int i = 0; i < 4; ++i) {
+		t.v[3-i] = 0;
+		for(int j = 0; j < 8; ++j)
+			t.v[3-i] = t.v[3-i] << 8 | in[8*i+j];
+	}
+	uint64_t borrow = 0;
+	for(int i = 0; i < 4; ++i) {
+		p256_u128 d = (p256_u128)t.v[i] - p256_p.v[i] - borrow;
+		borrow = (uint64_t)(d >> 64) & 1;
+	}
+	p256_fe_mul(r, t, p256_rr);
+	return borrow == 1;
+}
+
+inline void p256_fe_to_bytes(unsigned char * out, const P256Fe &a) {
+	const P256Fe unit = {{1, 0, 0, 0}};
+	P256Fe t;
+	p256_fe_mul(t, a, unit);
+	for(int i = 0; i < 4; ++i)
+		for(int j = 0; j < 8; ++j)
+			out[8*i+j] = (unsigned char)(t.v[3-i] >> (56 - 8*j));
+}
+
+inline void p256_point_cmov(P256Point &r, const P256Point &a, uint64_t mask) {
+	p256_fe_cmov(r.x, a.x, mask);
+	p256_fe_cmov(r.y, a.y, mask);
+	p256_fe_cmov(r.z, a.z, mask);
+}
+
+inline void p256_lift(P256Point &r, const P256Affine &a) {
+	r.x = a.x;
+	r.y = a.y;
+	r.z = p256_one;
+	p256_fe_cmov(r.z, a.x, p256_fe_is_zero(a.x) & p256_fe_is_zero(a.y));
+}
+
+// r = 2a, with a = -3 (dbl-2001-b); infinity stays infinity
+inline void p256_dbl(P256Point &r, const P256Point &a) {
+	P256Fe delta, gamma, beta, alpha, t0, t1;
+	p256_fe_sqr(delta, a.z);
+	p256_fe_sqr(gamma, a.y);
+	p256_fe_mul(beta, a.x, gamma);
+	p256_fe_sub(t0, a.x, delta);
+	p256_fe_add(t1, a.x, delta);
+	p256_fe_mul(alpha, t0, t1);
+	p256_fe_add(t0, alpha, alpha);
+	p256_fe_add(alpha, t0, alpha);
+	p256_fe_add(t0, a.y, a.z);
+	p256_fe_sqr(t0, t0);
+	p256_fe_sub(t0, t0, gamma);
+	p256_fe_sub(r.z, t0, delta);
+	p256_fe_add(beta, beta, beta);
+	p256_fe_add(beta, beta, beta);
+	p256_fe_sqr(t0, alpha);
+	p256_fe_sub(t0, t0, beta);
+	p256_fe_sub(r.x, t0, beta);
+	p256_fe_sub(t0, beta, r.x);
+	p256_fe_mul(t0, alpha, t0);
+	p256_fe_sqr(gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_sub(r.y, t0, gamma);
+}
+
+// r = a + b for affine b, without the special cases: a and b must not be
+// infinity, and a != +-b
+inline void p256_madd(P256Point &r, const P256Point &a, const P256Affine &b) {
+	P256Fe z1z1, u2, s2, h, rr, hh, hhh, v, t;
+	p256_fe_sqr(z1z1, a.z);
+	p256_fe_mul(u2, b.x, z1z1);
+	p256_fe_mul(s2, b.y, a.z);
+	p256_fe_mul(s2, s2, z1z1);
+	p256_fe_sub(h, u2, a.x);
+	p256_fe_sub(rr, s2, a.y);
+	p256_fe_sqr(hh, h);
+	p256_fe_mul(hhh, h, hh);
+	p256_fe_mul(v, a.x, hh);
+	p256_fe_mul(r.z, a.z, h);
+	p256_fe_sqr(t, rr);
+	p256_fe_sub(t, t, hhh);
+	p256_fe_sub(t, t, v);
+	p256_fe_sub(t, t, v);
+	p256_fe_sub(v, v, t);
+	p256_fe_mul(v, rr, v);
+	p256_fe_mul(hhh, a.y, hhh);
+	p256_fe_sub(r.y, v, hhh);
+	r.x = t;
+}
+
+// r = a + b for affine b, for all inputs, but branching on them: only for
+// points that are public
+inline void p256_add(P256Point &r, const P256Point &a, const P256Affine &b) {
+	if(p256_fe_is_zero(a.z))
+		return p256_lift(r, b);
+	if(p256_fe_is_zero(b.x) and p256_fe_is_zero(b.y)) {
+		r = a;
+		return;
+	}
+	P256Fe z1z1, u2, s2;
+	p256_fe_sqr(z1z1, a.z);
+	p256_fe_mul(u2, b.x, z1z1);
+	p256_fe_sub(u2, u2, a.x);
+	if(p256_fe_is_zero(u2)) {
+		p256_fe_mul(s2, b.y, a.z);
+		p256_fe_mul(s2, s2, z1z1);
+		p256_fe_sub(s2, s2, a.y);
+		if(p256_fe_is_zero(s2))
+			return p256_dbl(r, a);
+		r = P256Point{p256_one, p256_one, P256Fe{{0, 0, 0, 0}}};
+		return;
+	}
+	p256_madd(r, a, b);
+}
+
+// Affine forms of n points with one inversion; infinity becomes (0, 0)
+inline void p256_normalize(P256Affine * out, const P256Point * in, size_t n) {
+	if(n == 0)
+		return;
+	std::vector<P256Fe> prefix(n);
+	P256Fe acc = p256_one, z;
+	for(size_t i = 0; i < n; ++i) {
+		z = in[i].z;
+		p256_fe_cmov(z, p256_one, p256_fe_is_zero(in[i].z));
+		p256_fe_mul(acc, acc, z);
+		prefix[i] = acc;
+	}
+	p256_fe_inv(acc, acc);
+	const P256Fe zero = {{0, 0, 0, 0}};
+	for(size_t i = n; i-- > 0;) {
+		uint64_t inf = p256_fe_is_zero(in[i].z);
+		P256Fe zinv, zinv2;
+		if(i > 0)
+			p256_fe_mul(zinv, acc, prefix[i-1]);
+		else
+			zinv = acc;
+		z = in[i].z;
+		p256_fe_cmov(z, p256_one, inf);
+		p256_fe_mul(acc, acc, z);
+		p256_fe_sqr(zinv2, zinv);
+		p256_fe_mul(out[i].x, in[i].x, zinv2);
+		p256_fe_mul(zinv2, zinv2, zinv);
+		p256_fe_mul(out[i].y, in[i].y, zinv2);
+		p256_fe_cmov(out[i].x, zero, inf);
+		p256_fe_cmov(out[i].y, zero, inf);
+	}
+}
+
+// Uncompressed SEC1 encoding, as Point::to_bin; returns its length (1 at infinity)
+inline size_t p256_encode(unsigned char * out, const P256Affine &a) {
+	if(p256_fe_is_zero(a.x) and p256_fe_is_zero(a.y)) {
+		out[0] = 0;
+		return 1;
+	}
+	out[0] = 4;
+	p256_fe_to_bytes(out + 1, a.x);
+	p256_fe_to_bytes(out + 33, a.y);
+	return P256_POINT_SIZE;
+}
+
+// Reads an uncompressed point; false unless it is on the curve
+inline bool p256_decode(P256Affine &r, const unsigned char * in, size_t len) {
+	if(len != P256_POINT_SIZE or in[0] != 4)
+		return false;
+	if(!p256_fe_from_bytes(r.x, in + 1) or !p256_fe_from_bytes(r.y, in + 33))
+		return false;
+	P256Fe lhs, rhs, t;
+	p256_fe_sqr(lhs, r.y);
+	p256_fe_sqr(rhs, r.x);
+	p256_fe_mul(rhs, rhs, r.x);
+	p256_fe_add(t, r.x, r.x);
+	p256_fe_add(t, t, r.x);
+	p256_fe_sub(rhs, rhs, t);
+	P256Fe b;
+	p256_fe_mul(b, p256_b, p256_rr);
+	p256_fe_add(rhs, rhs, b);
+	p256_fe_sub(t, lhs, rhs);
+	return p256_fe_is_zero(t);
+}
+
+// Uniform in [1, n)
+inline void p256_rand_scalar(P256Scalar &k, PRG &prg) {
+	while(true) {
+		prg.random_data(k.v, sizeof(k.v));
+		uint64_t borrow = 0;
+		for(int i = 0; i < 4; ++i) {
+			p256_u128 d = (p256_u128)k.v[i] - p256_n.v[i] - borrow;
+			borrow = (uint64_t)(d >> 64) & 1;
+		}
+		if(borrow and (k.v[0] | k.v[1] | k.v[2] | k.v[3]))
+			return;
+	}
+}
+
+// Signed 5-bit digits in [-16, 16] with k = sum d[j] 32^j, for k < n
+inline void p256_recode(int d[P256_WINDOWS], const P256Scalar &k) {
+	int carry = 0;
+	for(int j = 0; j < P256_WINDOWS; ++j) {
+		int pos = P256_WINDOW * j, limb = pos / 64, off = pos % 64;
+		uint64_t bits = k.v[limb] >> off;
+		if(off > 64 - P256_WINDOW and limb < 3)
+			bits |= k.v[limb+1] << (64 - off);
+		int w = (int)(bits & (2*P256_ROW - 1)) + carry;
+		carry = ((P256_ROW - w) >> 31) & 1;
+		d[j] = w - (carry << P256_WINDOW);
+	}
+}
+
+// d * row[|d| - 1], read in constant time; garbage for d = 0
+inline void p256_lookup(P256Affine &r, const P256Affine * row, int d) {
+	uint64_t neg = (uint64_t)0 - (uint64_t)((d >> 31) & 1);
+	uint64_t abs = (uint64_t)((d ^ (d >> 31)) - (d >> 31));
+	memset(&r, 0, sizeof(r));
+	for(int i = 0; i < P256_ROW; ++i) {
+		uint64_t m = p256_eq_mask(i + 1, abs);
+		for(int l = 0; l < 4; ++l) {
+			r.x.v[l] |= row[i].x.v[l] & m;
+			r.y.v[l] |= row[i].y.v[l] & m;
+		}
+	}
+	P256Fe ny;
+	p256_fe_neg(ny, r.y);
+	p256_fe_cmov(r.y, ny, neg);
+}
+
+// r += d * row[|d| - 1], where inf says whether r is still infinity
+inline void p256_accumulate(P256Point &r, uint64_t &inf, const P256Affine * row, int d) {
+	P256Affine q;
+	P256Point s, lifted;
+	p256_lookup(q, row, d);
+	p256_madd(s, r, q);
+	p256_lift(lifted, q);
+	p256_point_cmov(s, lifted, inf);
+	uint64_t nonzero = ~p256_eq_mask((uint64_t)(int64_t)d, 0);
+	p256_point_cmov(r, s, nonzero);
+	inf &= ~nonzero;
+}
+
+#ifdef __x86_64__
+/*
+ * Batches of eight points with AVX-512 IFMA, one point per 64-bit lane.
+ * Field elements are 5 limbs of 52 bits, fully reduced, in Montgomery form
+ * with R = 2^260; p = -1 mod 2^52 as well, so the reduction multiplier is
+ * again the low limb. The batch multiplications use it when the CPU has it,
+ * detected once; setting p256_use_ifma() to false keeps the 64-bit code,
+ * e.g. to compare the two. Both give the same points.
+ */
+inline bool & p256_use_ifma() {
+	static bool use = []() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512ifma");
+	}();
+	return use;
+}
+
+struct P256Fe8 { __m512i l[5]; };
+struct P256Affine8 { P256Fe8 x, y; };
+struct P256Point8 { P256Fe8 x, y, z; };
+
+const static uint64_t P256_MASK52 = 0xfffffffffffffULL;
+const static uint64_t p256_p52[5] = {0xfffffffffffffULL, 0x00fffffffffffULL, 0, 0x0001000000000ULL, 0x0ffffffff0000ULL};
+
+// Between P256Fe and 52-bit limbs: times 16, from R = 2^256 to 2^260, and back
+inline void p256_fe_to52(uint64_t l[5], const P256Fe &a) {
+	P256Fe t;
+	p256_fe_add(t, a, a);
+	p256_fe_add(t, t, t);
+	p256_fe_add(t, t, t);
+	p256_fe_add(t, t, t);
+	l[0] = t.v[0] & P256_MASK52;
+	l[1] = (t.v[0] >> 52 | t.v[1] << 12) & P256_MASK52;
+	l[2] = (t.v[1] >> 40 | t.v[2] << 24) & P256_MASK52;
+	l[3] = (t.v[2] >> 28 | t.v[3] << 36) & P256_MASK52;
+	l[4] = t.v[3] >> 16;
+}
+
+inline void p256_fe_from52(P256Fe &r, const uint64_t l[5]) {
+	// Montgomery product with 2^252, i.e. division by 16
+	const P256Fe sixteenth = {{0, 0, 0, 1ULL << 60}};
+	P256Fe t = {{l[0] | l[1] << 52, l[1] >> 12 | l[2] << 40, l[2] >> 24 | l[3] << 28, l[3] >> 36 | l[4] << 16}};
+	p256_fe_mul(r, t, sixteenth);
+}
+
+EMP_AVX512_BEGIN
+#define EMP_P256_IFMA __attribute__((target("avx512f,avx512ifma")))
+
+// Lane i of r from *a[i]
+EMP_P256_IFMA inline void p256_fe8_load(P256Fe8 &r, const P256Fe * const a[8]) {
+	uint64_t l[8][5], lanes[8];
+	for(int i = 0; i < 8; ++i)
+		p256_fe_to52(l[i], *a[i]);
+	for(int j = 0; j < 5; ++j) {
+		for(int i = 0; i < 8; ++i)
+			lanes[i] = l[i][j];
+		r.l[j] = _mm512_loadu_si512((const void *)lanes);
+	}
+}
+
+EMP_P256_IFMA inline void p256_fe8_store(P256Fe * const a[8], const P256Fe8 &r) {
+	uint64_t l[8][5], lanes[8];
+	for(int j = 0; j < 5; ++j) {
+		_mm512_storeu_si512((void *)lanes, r.l[j]);
+		for(int i = 0; i < 8; ++i)
+			l[i][j] = lanes[i];
+	}
+	for(int i = 0; i < 8; ++i)
+		p256_fe_from52(*a[i], l[i]);
+}
+
+EMP_P256_IFMA inline void p256_fe8_set1(P256Fe8 &r, const P256Fe &a) {
+	uint64_t l[5];
+	p256_fe_to52(l, a);
+	for(int j = 0; j < 5; ++j)
+		r.l[j] = _mm512_set1_epi64(l[j]);
+}
+
+// Limbs 0..3 into [0, 2^52), carrying signed; limb 4 keeps the sign
+EMP_P256_IFMA inline void p256_fe8_carry(__m512i t[5]) {
+	const __m512i mask = _mm512_set1_epi64(P256_MASK52);
+	for(int j = 0; j < 4; ++j) {
+		t[j+1] = _mm512_add_epi64(t[j+1], _mm512_srai_epi64(t[j], 52));
+		t[j] = _mm512_and_si512(t[j], mask);
+	}
+}
+
+// r = t - p where t is at least p, else t; t in [0, 2p) with carried limbs
+EMP_P256_IFMA inline void p256_fe8_reduce_once(P256Fe8 &r, const __m512i t[5]) {
+	__m512i d[5];
+	for(int j = 0; j < 5; ++j)
+		d[j] = _mm512_sub_epi64(t[j], _mm512_set1_epi64(p256_p52[j]));
+	p256_fe8_carry(d);
+	__mmask8 below = _mm512_cmplt_epi64_mask(d[4], _mm512_setzero_si512());
+	for(int j = 0; j < 5; ++j)
+		r.l[j] = _mm512_mask_blend_epi64(below, d[j], t[j]);
+}
+
+EMP_P256_IFMA inline void p256_fe8_add(P256Fe8 &r, const P256Fe8 &a, const P256Fe8 &b) {
+	__m512i t[5];
+	for(int j = 0; j < 5; ++j)
+		t[j] = _mm512_add_epi64(a.l[j], b.l[j]);
+	p256_fe8_carry(t);
+	p256_fe8_reduce_once(r, t);
+}
+
+EMP_P256_IFMA inline void p256_fe8_sub(P256Fe8 &r, const P256Fe8 &a, const P256Fe8 &b) {
+	__m512i t[5];
+	for(int j = 0; j < 5; ++j)
+		t[j] = _mm512_sub_epi64(a.l[j], b.l[j]);
+	p256_fe8_carry(t);
+	__mmask8 neg = _mm512_cmplt_epi64_mask(t[4], _mm512_setzero_si512());
+	for(int j = 0; j < 5; ++j)
+		t[j] = _mm512_mask_add_epi64(t[j], neg, t[j], _mm512_set1_epi64(p256_p52[j]));
+	p256_fe8_carry(t);
+	for(int j = 0; j < 5; ++j)
+		r.l[j] = t[j];
+}
+
+EMP_P256_IFMA inline void p256_fe8_neg(P256Fe8 &r, const P256Fe8 &a) {
+	P256Fe8 zero;
+	for(int j = 0; j < 5; ++j)
+		zero.l[j] = _mm512_setzero_si512();
+	p256_fe8_sub(r, zero, a);
+}
+
+// Montgomery product a * b / 2^260 mod p
+EMP_P256_IFMA inline void p256_fe8_mul(P256Fe8 &r, const P256Fe8 &a, const P256Fe8 &b) {
+	const __m512i mask = _mm512_set1_epi64(P256_MASK52);
+	__m512i t[6], p[5];
+	for(int j = 0; j < 5; ++j)
+		p[j] = _mm512_set1_epi64(p256_p52[j]);
+	for(int j = 0; j < 6; ++j)
+		t[j] = _mm512_setzero_si512();
+	for(int i = 0; i < 5; ++i) {
+		for(int j = 0; j < 5; ++j) {
+			t[j] = _mm512_madd52lo_epu64(t[j], a.l[j], b.l[i]);
+			t[j+1] = _mm512_madd52hi_epu64(t[j+1], a.l[j], b.l[i]);
+		}
+		// t += m * p for the low limb m, skipping the zero limb 2 of p
+		__m512i m = _mm512_and_si512(t[0], mask);
+		for(int j = 0; j < 5; ++j) {
+			if(j == 2)
+				continue;
+			t[j] = _mm512_madd52lo_epu64(t[j], m, p[j]);
+			t[j+1] = _mm512_madd52hi_epu64(t[j+1], m, p[j]);
+		}
+		t[1] = _mm512_add_epi64(t[1], _mm512_srli_epi64(t[0], 52));
+		for(int j = 0; j < 5; ++j)
+			t[j] = t[j+1];
+		t[5] = _mm512_setzero_si512();
+	}
+	p256_fe8_carry(t);
+	p256_fe8_reduce_once(r, t);
+}
+
+EMP_P256_IFMA inline void p256_fe8_sqr_n(P256Fe8 &r, const P256Fe8 &a, int n) {
+	r = a;
+	for(int i = 0; i < n; ++i)
+		p256_fe8_mul(r, r, r);
+}
+
+EMP_P256_IFMA inline void p256_fe8_cmov(P256Fe8 &r, const P256Fe8 &a, __mmask8 k) {
+	for(int j = 0; j < 5; ++j)
+		r.l[j] = _mm512_mask_mov_epi64(r.l[j], k, a.l[j]);
+}
+
+// The addition chain of p256_fe_inv
+EMP_P256_IFMA inline void p256_fe8_inv(P256Fe8 &r, const P256Fe8 &a) {
+	P256Fe8 x2, x3, x6, x12, x15, x30, x32, t;
+	p256_fe8_mul(t, a, a);
+	p256_fe8_mul(x2, t, a);
+	p256_fe8_mul(t, x2, x2);
+	p256_fe8_mul(x3, t, a);
+	p256_fe8_sqr_n(t, x3, 3);
+	p256_fe8_mul(x6, t, x3);
+	p256_fe8_sqr_n(t, x6, 6);
+	p256_fe8_mul(x12, t, x6);
+	p256_fe8_sqr_n(t, x12, 3);
+	p256_fe8_mul(x15, t, x3);
+	p256_fe8_sqr_n(t, x15, 15);
+	p256_fe8_mul(x30, t, x15);
+	p256_fe8_sqr_n(t, x30, 2);
+	p256_fe8_mul(x32, t, x2);
+	p256_fe8_sqr_n(t, x32, 32);
+	p256_fe8_mul(t, t, a);
+	p256_fe8_sqr_n(t, t, 128);
+	p256_fe8_mul(t, t, x32);
+	p256_fe8_sqr_n(t, t, 32);
+	p256_fe8_mul(t, t, x32);
+	p256_fe8_sqr_n(t, t, 30);
+	p256_fe8_mul(t, t, x30);
+	p256_fe8_sqr_n(t, t, 2);
+	p256_fe8_mul(r, t, a);
+}
+
+EMP_P256_IFMA inline void p256_point8_cmov(P256Point8 &r, const P256Point8 &a, __mmask8 k) {
+	p256_fe8_cmov(r.x, a.x, k);
+	p256_fe8_cmov(r.y, a.y, k);
+	p256_fe8_cmov(r.z, a.z, k);
+}
+
+// p256_dbl in every lane
+EMP_P256_IFMA inline void p256_dbl8(P256Point8 &r, const P256Point8 &a) {
+	P256Fe8 delta, gamma, beta, alpha, t0, t1;
+	p256_fe8_mul(delta, a.z, a.z);
+	p256_fe8_mul(gamma, a.y, a.y);
+	p256_fe8_mul(beta, a.x, gamma);
+	p256_fe8_sub(t0, a.x, delta);
+	p256_fe8_add(t1, a.x, delta);
+	p256_fe8_mul(alpha, t0, t1);
+	p256_fe8_add(t0, alpha, alpha);
+	p256_fe8_add(alpha, t0, alpha);
+	p256_fe8_add(t0, a.y, a.z);
+	p256_fe8_mul(t0, t0, t0);
+	p256_fe8_sub(t0, t0, gamma);
+	p256_fe8_sub(r.z, t0, delta);
+	p256_fe8_add(beta, beta, beta);
+	p256_fe8_add(beta, beta, beta);
+	p256_fe8_mul(t0, alpha, alpha);
+	p256_fe8_sub(t0, t0, beta);
+	p256_fe8_sub(r.x, t0, beta);
+	p256_fe8_sub(t0, beta, r.x);
+	p256_fe8_mul(t0, alpha, t0);
+	p256_fe8_mul(gamma, gamma, gamma);
+	p256_fe8_add(gamma, gamma, gamma);
+	p256_fe8_add(gamma, gamma, gamma);
+	p256_fe8_add(gamma, gamma, gamma);
+	p256_fe8_sub(r.y, t0, gamma);
+}
+
+// p256_madd in every lane
+EMP_P256_IFMA inline void p256_madd8(P256Point8 &r, const P256Point8 &a, const P256Affine8 &b) {
+	P256Fe8 z1z1, u2, s2, h, rr, hh, hhh, v, t;
+	p256_fe8_mul(z1z1, a.z, a.z);
+	p256_fe8_mul(u2, b.x, z1z1);
+	p256_fe8_mul(s2, b.y, a.z);
+	p256_fe8_mul(s2, s2, z1z1);
+	p256_fe8_sub(h, u2, a.x);
+	p256_fe8_sub(rr, s2, a.y);
+	p256_fe8_mul(hh, h, h);
+	p256_fe8_mul(hhh, h, hh);
+	p256_fe8_mul(v, a.x, hh);
+	p256_fe8_mul(r.z, a.z, h);
+	p256_fe8_mul(t, rr, rr);
+	p256_fe8_sub(t, t, hhh);
+	p256_fe8_sub(t, t, v);
+	p256_fe8_sub(t, t, v);
+	p256_fe8_sub(v, v, t);
+	p256_fe8_mul(v, rr, v);
+	p256_fe8_mul(hhh, a.y, hhh);
+	p256_fe8_sub(r.y, v, hhh);
+	r.x = t;
+}
+
+// p256_accumulate in every lane, for the lanes in nonzero
+EMP_P256_IFMA inline void p256_accumulate8(P256Point8 &r, __mmask8 &inf, const P256Affine8 &q, __mmask8 nonzero, const P256Fe8 &one) {
+	P256Point8 s, lifted = {q.x, q.y, one};
+	p256_madd8(s, r, q);
+	p256_point8_cmov(s, lifted, inf);
+	p256_point8_cmov(r, s, nonzero);
+	inf &= ~nonzero;
+}
+
+// p256_mul on eight points at a time; the last batch fills its spare lanes
+// with a copy of its first point
+EMP_P256_IFMA inline void p256_mul_ifma(P256Point * out, const P256Affine * in, size_t n, const int d[P256_WINDOWS]) {
+	P256Fe8 one;
+	p256_fe8_set1(one, p256_one);
+	for(size_t g = 0; g < n; g += 8) {
+		const P256Fe * xs[8], * ys[8];
+		for(size_t i = 0; i < 8; ++i) {
+			size_t idx = g + i < n ? g + i : g;
+			xs[i] = &in[idx].x;
+			ys[i] = &in[idx].y;
+		}
+		P256Affine8 base;
+		p256_fe8_load(base.x, xs);
+		p256_fe8_load(base.y, ys);
+
+		// The 16 multiples of each point, normalized with one inversion per lane
+		P256Point8 jac[P256_ROW];
+		P256Affine8 row[P256_ROW];
+		P256Fe8 prefix[P256_ROW], acc, zinv, zinv2;
+		jac[0] = P256Point8{base.x, base.y, one};
+		p256_dbl8(jac[1], jac[0]);
+		for(int j = 2; j < P256_ROW; ++j)
+			p256_madd8(jac[j], jac[j-1], base);
+		acc = one;
+		for(int j = 0; j < P256_ROW; ++j) {
+			p256_fe8_mul(acc, acc, jac[j].z);
+			prefix[j] = acc;
+		}
+		p256_fe8_inv(acc, acc);
+		for(int j = P256_ROW - 1; j >= 0; --j) {
+			if(j > 0)
+				p256_fe8_mul(zinv, acc, prefix[j-1]);
+			else
+				zinv = acc;
+			p256_fe8_mul(acc, acc, jac[j].z);
+			p256_fe8_mul(zinv2, zinv, zinv);
+			p256_fe8_mul(row[j].x, jac[j].x, zinv2);
+			p256_fe8_mul(zinv2, zinv2, zinv);
+			p256_fe8_mul(row[j].y, jac[j].y, zinv2);
+		}
+
+		P256Point8 r = {one, one, one};
+		for(int j = 0; j < 5; ++j)
+			r.z.l[j] = _mm512_setzero_si512();
+		__mmask8 inf = 0xFF;
+		for(int j = P256_WINDOWS - 1; j >= 0; --j) {
+			for(int s = 0; s < P256_WINDOW and j < P256_WINDOWS - 1; ++s)
+				p256_dbl8(r, r);
+			// The digit is the same in all lanes: d * row[|d| - 1], reading every entry
+			uint64_t neg = (uint64_t)0 - (uint64_t)((d[j] >> 31) & 1);
+			uint64_t abs = (uint64_t)((d[j] ^ (d[j] >> 31)) - (d[j] >> 31));
+			P256Affine8 q = row[0];
+			for(int i = 1; i < P256_ROW; ++i) {
+				__mmask8 k = (__mmask8)p256_eq_mask(i + 1, abs);
+				p256_fe8_cmov(q.x, row[i].x, k);
+				p256_fe8_cmov(q.y, row[i].y, k);
+			}
+			P256Fe8 ny;
+			p256_fe8_neg(ny, q.y);
+			p256_fe8_cmov(q.y, ny, (__mmask8)neg);
+			p256_accumulate8(r, inf, q, (__mmask8)~p256_eq_mask((uint64_t)(int64_t)d[j], 0), one);
+		}
+
+		P256Fe * ox[8], * oy[8], * oz[8];
+		P256Point spare;
+		for(size_t i = 0; i < 8; ++i) {
+			P256Point * o = g + i < n ? &out[g + i] : &spare;
+			ox[i] = &o->x;
+			oy[i] = &o->y;
+			oz[i] = &o->z;
+		}
+		p256_fe8_store(ox, r.x);
+		p256_fe8_store(oy, r.y);
+		p256_fe8_store(oz, r.z);
+	}
+}
+
+// P256Table::mul on eight scalars at a time, from the table rows in 52-bit
+// limbs (x then y, 10 words per entry)
+EMP_P256_IFMA inline void p256_table_mul_ifma(P256Point * out, const P256Scalar * k, size_t n, const uint64_t * rows52) {
+	P256Fe8 one;
+	p256_fe8_set1(one, p256_one);
+	const __m512i zero = _mm512_setzero_si512();
+	for(size_t g = 0; g < n; g += 8) {
+		int64_t digits[P256_WINDOWS][8];
+		for(size_t i = 0; i < 8; ++i) {
+			int d[P256_WINDOWS];
+			p256_recode(d, k[g + i < n ? g + i : g]);
+			for(int j = 0; j < P256_WINDOWS; ++j)
+				digits[j][i] = d[j];
+		}
+		P256Point8 r = {one, one, one};
+		for(int j = 0; j < 5; ++j)
+			r.z.l[j] = zero;
+		__mmask8 inf = 0xFF;
+		for(int j = 0; j < P256_WINDOWS; ++j) {
+			// Lane i gets d[i] * row[|d[i]| - 1], reading every entry
+			__m512i d = _mm512_loadu_si512((const void *)digits[j]);
+			__m512i abs = _mm512_abs_epi64(d);
+			const uint64_t * row = rows52 + 10 * P256_ROW * j;
+			P256Affine8 q;
+			for(int l = 0; l < 5; ++l)
+				q.x.l[l] = q.y.l[l] = zero;
+			for(int i = 0; i < P256_ROW; ++i) {
+				__mmask8 hit = _mm512_cmpeq_epi64_mask(abs, _mm512_set1_epi64(i + 1));
+				for(int l = 0; l < 5; ++l) {
+					q.x.l[l] = _mm512_mask_set1_epi64(q.x.l[l], hit, row[10*i + l]);
+					q.y.l[l] = _mm512_mask_set1_epi64(q.y.l[l], hit, row[10*i + 5 + l]);
+				}
+			}
+			P256Fe8 ny;
+			p256_fe8_neg(ny, q.y);
+			p256_fe8_cmov(q.y, ny, _mm512_cmplt_epi64_mask(d, zero));
+			p256_accumulate8(r, inf, q, _mm512_cmpneq_epi64_mask(d, zero), one);
+		}
+
+		P256Fe * ox[8], * oy[8], * oz[8];
+		P256Point spare;
+		for(size_t i = 0; i < 8; ++i) {
+			P256Point * o = g + i < n ? &out[g + i] : &spare;
+			ox[i] = &o->x;
+			oy[i] = &o->y;
+			oz[i] = &o->z;
+		}
+		p256_fe8_store(ox, r.x);
+		p256_fe8_store(oy, r.y);
+		p256_fe8_store(oz, r.z);
+	}
+}
+#undef EMP_P256_IFMA
+EMP_AVX512_END
+#endif
+
+// Rows of i * 32^j * base for i = 1..16, one per window j
+class P256Table { public:
+	std::vector<P256Affine> rows;
+	// The rows in 52-bit limbs, for p256_table_mul_ifma
+	std::vector<uint64_t> rows52;
+	P256Table(const P256Affine &base): rows(P256_WINDOWS * P256_ROW) {
+		std::vector<P256Point> jac(P256_WINDOWS * P256_ROW);
+		std::vector<P256Point> pows(P256_WINDOWS);
+		std::vector<P256Affine> pows_aff(P256_WINDOWS);
+		p256_lift(pows[0], base);
+		for(int j = 1; j < P256_WINDOWS; ++j) {
+			pows[j] = pows[j-1];
+			for(int i = 0; i < P256_WINDOW; ++i)
+				p256_dbl(pows[j], pows[j]);
+		}
+		p256_normalize(pows_aff.data(), pows.data(), P256_WINDOWS);
+		for(int j = 0; j < P256_WINDOWS; ++j) {
+			P256Point * row = &jac[P256_ROW * j];
+			p256_lift(row[0], pows_aff[j]);
+			p256_dbl(row[1], row[0]);
+			for(int i = 2; i < P256_ROW; ++i)
+				p256_madd(row[i], row[i-1], pows_aff[j]);
+		}
+		p256_normalize(rows.data(), jac.data(), jac.size());
+#ifdef __x86_64__
+		if(p256_use_ifma()) {
+			rows52.resize(10 * rows.size());
+			for(size_t i = 0; i < rows.size(); ++i) {
+				p256_fe_to52(&rows52[10*i], rows[i].x);
+				p256_fe_to52(&rows52[10*i + 5], rows[i].y);
+			}
+		}
+#endif
+	}
+
+	void mul(P256Point &r, const P256Scalar &k) const {
+		int d[P256_WINDOWS];
+		p256_recode(d, k);
+		r = P256Point{p256_one, p256_one, P256Fe{{0, 0, 0, 0}}};
+		uint64_t inf = ~(uint64_t)0;
+		for(int j = 0; j < P256_WINDOWS; ++j)
+			p256_accumulate(r, inf, &rows[P256_ROW * j], d[j]);
+	}
+
+	// out[i] = k[i] * base
+	void mul(P256Point * out, const P256Scalar * k, size_t n) const {
+#ifdef __x86_64__
+		if(p256_use_ifma() and !rows52.empty())
+			return p256_table_mul_ifma(out, k, n, rows52.data());
+#endif
+		for(size_t i = 0; i < n; ++i)
+			mul(out[i], k[i]);
+	}
+};
+
+inline const P256Table & p256_generator() {
+	static const P256Table table(P256Affine{
+			[]() { P256Fe x; p256_fe_mul(x, p256_gx, p256_rr); return x; }(),
+			[]() { P256Fe y; p256_fe_mul(y, p256_gy, p256_rr); return y; }()});
+	return table;
+}
+
+// out[i] = k * in[i] for points that are not infinity; the 16-entry tables
+// of all points are normalized together
+inline void p256_mul(P256Point * out, const P256Affine * in, size_t n, const P256Scalar &k) {
+	int d[P256_WINDOWS];
+	p256_recode(d, k);
+#ifdef __x86_64__
+	if(p256_use_ifma())
+		return p256_mul_ifma(out, in, n, d);
+#endif
+	std::vector<P256Point> jac(P256_ROW * n);
+	std::vector<P256Affine> rows(P256_ROW * n);
+	for(size_t i = 0; i < n; ++i) {
+		P256Point * row = &jac[P256_ROW * i];
+		p256_lift(row[0], in[i]);
+		p256_dbl(row[1], row[0]);
+		for(int j = 2; j < P256_ROW; ++j)
+			p256_madd(row[j], row[j-1], in[i]);
+	}
+	p256_normalize(rows.data(), jac.data(), jac.size());
+	for(size_t i = 0; i < n; ++i) {
+		P256Point r = {p256_one, p256_one, P256Fe{{0, 0, 0, 0}}};
+		uint64_t inf = ~(uint64_t)0;
+		for(int j = P256_WINDOWS - 1; j >= 0; --j) {
+			for(int s = 0; s < P256_WINDOW and j < P256_WINDOWS - 1; ++s)
+				p256_dbl(r, r);
+			p256_accumulate(r, inf, &rows[P256_ROW * i], d[j]);
+		}
+		out[i] = r;
+	}
+}
+
+}
+#endif
+#endif// EMP_P256_H__
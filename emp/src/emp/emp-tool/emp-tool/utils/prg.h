@@ -4,6 +4,7 @@
 #include "emp-tool/utils/aes.h"
 #include "emp-tool/utils/utils.h"
 #include "emp-tool/utils/constants.h"
+#include "emp-tool/utils/bit_vector.h"
 #include <climits>
 #include <memory>
 
@@ -63,11 +64,21 @@ class PRG { public:
 		}
 	}
 
+	/* Random bits spread one per bool, from 4096 bits of PRG output at a
+	 * time: 32 blocks keep every AES batch full, also with VAES
+	 */
 	void random_bool(bool * data, int length) {
-		uint8_t * uint_data = (uint8_t*)data;
-		random_data_unaligned(uint_data, length);
-		for(int i = 0; i < length; ++i)
-			data[i] = uint_data[i] & 1;
+		block tmp[32];
+		for(int i = 0; i < length; i += 4096) {
+			int k = std::min(4096, length - i);
+			random_block(tmp, (k + 127) / 128);
+			unpack_bits(data + i, (const uint8_t *)tmp, k);
+		}
+	}
+
+	void random_bits(BitVector & bits) {
+		random_block(bits.blocks(), (bits.size() + 127) / 128);
+		bits.clear_tail();
 	}
 
     void random_data_unaligned(void *data, int nbytes) {
@@ -109,20 +120,37 @@ class PRG { public:
     }
 
 	void random_block(block * data, int nblocks=1) {
+#ifdef __x86_64__
+		if(aes_use_vaes()) {
+			AES_ctr_encrypt_blks_vaes(data, counter, nblocks, &aes);
+			counter += nblocks;
+			return;
+		}
+#endif
 		block tmp[AES_BATCH_SIZE];
 		for(int i = 0; i < nblocks/AES_BATCH_SIZE; ++i) {
 			for (int j = 0; j < AES_BATCH_SIZE; ++j)
 				tmp[j] = makeBlock(0LL, counter++);
-			AES_ecb_encrypt_blks<AES_BATCH_SIZE>(tmp, &aes);
+			encrypt_batch(tmp, AES_BATCH_SIZE);
 			memcpy(data + i*AES_BATCH_SIZE, tmp, AES_BATCH_SIZE*sizeof(block));
 		}
 		int remain = nblocks % AES_BATCH_SIZE;
 		for (int j = 0; j < remain; ++j)
 			tmp[j] = makeBlock(0LL, counter++);
-		AES_ecb_encrypt_blks(tmp, remain, &aes);
+		encrypt_batch(tmp, remain);
 		memcpy(data + (nblocks/AES_BATCH_SIZE)*AES_BATCH_SIZE, tmp, remain*sizeof(block));
 	}
 
+	// At most AES_BATCH_SIZE blocks of random_block without VAES: AES-NI
+	// directly, as the dispatching call would inline its 32-block VAES loop
+	void encrypt_batch(block * blks, int nblks) {
+#ifdef __x86_64__
+		AES_ecb_encrypt_blks_ni(blks, nblks, &aes);
+#else
+		AES_ecb_encrypt_blks(blks, nblks, &aes);
+#endif
+	}
+
 	typedef uint64_t result_type;
 	result_type buffer[32];
 	size_t ptr = 32;
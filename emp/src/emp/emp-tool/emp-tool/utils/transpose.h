@@ -0,0 +1,163 @@
+#ifndef EMP_UTIL_TRANSPOSE_H__
+#define EMP_UTIL_TRANSPOSE_H__
+#include "emp-tool/utils/block.h"
+
+namespace emp {
+
+/*
+ * Bit-matrix transposes with 256- and 512-bit vectors, in the layout of
+ * sse_trans: inp holds nrows rows of ncols bits, out ncols rows of nrows
+ * bits. The matrix is taken in bands of 128 rows: a 16x16 byte transpose
+ * per 128-bit lane puts the bytes of 16 rows in one column together, an 8x8
+ * bit transpose per 64-bit word (shifts and masks with AVX2, one
+ * GF2P8AFFINEQB with GFNI) turns them into the 16-bit pieces of 8 output
+ * rows, and an 8x8 transpose of 16-bit words joins the pieces of the 8
+ * groups of 16 rows into whole 128-bit output blocks. bit_trans() picks the
+ * widest kernel the CPU supports; shapes a kernel does not cover go to
+ * sse_trans.
+ */
+
+#ifdef __x86_64__
+// Row loaded in vector k, so that the byte transpose leaves the rows in order
+const static uint8_t trans_row_order[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+// One step of the 16x16 byte transpose of each 128-bit lane, from r to t
+#define EMP_TRANS_STEP(unpacklo, unpackhi, r, t) \
+	for(int k = 0; k < 8; ++k) { \
+		t[2*k] = unpacklo(r[k], r[k+8]); \
+		t[2*k+1] = unpackhi(r[k], r[k+8]); \
+	}
+
+// 8x8 transpose of the 16-bit words of each 128-bit lane, from z to w
+#define EMP_TRANS_WORDS(unpacklo, unpackhi, z, w) { \
+		auto s0 = unpacklo##_epi16(z[0], z[1]), s1 = unpackhi##_epi16(z[0], z[1]); \
+		auto s2 = unpacklo##_epi16(z[2], z[3]), s3 = unpackhi##_epi16(z[2], z[3]); \
+		auto s4 = unpacklo##_epi16(z[4], z[5]), s5 = unpackhi##_epi16(z[4], z[5]); \
+		auto s6 = unpacklo##_epi16(z[6], z[7]), s7 = unpackhi##_epi16(z[6], z[7]); \
+		auto t0 = unpacklo##_epi32(s0, s2), t1 = unpackhi##_epi32(s0, s2); \
+		auto t2 = unpacklo##_epi32(s1, s3), t3 = unpackhi##_epi32(s1, s3); \
+		auto t4 = unpacklo##_epi32(s4, s6), t5 = unpackhi##_epi32(s4, s6); \
+		auto t6 = unpacklo##_epi32(s5, s7), t7 = unpackhi##_epi32(s5, s7); \
+		w[0] = unpacklo##_epi64(t0, t4); w[1] = unpackhi##_epi64(t0, t4); \
+		w[2] = unpacklo##_epi64(t1, t5); w[3] = unpackhi##_epi64(t1, t5); \
+		w[4] = unpacklo##_epi64(t2, t6); w[5] = unpackhi##_epi64(t2, t6); \
+		w[6] = unpacklo##_epi64(t3, t7); w[7] = unpackhi##_epi64(t3, t7); \
+	}
+
+// Needs nrows % 128 == 0 and ncols % 256 == 0
+__attribute__((target("avx2")))
+inline void avx2_trans(uint8_t *out, uint8_t const *inp, uint64_t nrows, uint64_t ncols) {
+	const __m256i interleave = _mm256_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+			0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+	const __m256i m7 = _mm256_set1_epi64x(0x00AA00AA00AA00AA);
+	const __m256i m14 = _mm256_set1_epi64x(0x0000CCCC0000CCCC);
+	const __m256i m28 = _mm256_set1_epi64x(0x00000000F0F0F0F0);
+	// stage[j][g]: 16-bit pieces of rows 16g..16g+15, column bytes j and 16+j
+	__m256i stage[16][8], r[16], t[16];
+	for(uint64_t rr = 0; rr < nrows; rr += 128) {
+		for(uint64_t cb = 0; cb < ncols / 8; cb += 32) {
+			for(int g = 0; g < 8; ++g) {
+				for(int k = 0; k < 16; ++k)
+					r[k] = _mm256_loadu_si256((const __m256i *)&INP(rr + 16*g + trans_row_order[k], 8*cb));
+				EMP_TRANS_STEP(_mm256_unpacklo_epi8, _mm256_unpackhi_epi8, r, t)
+				EMP_TRANS_STEP(_mm256_unpacklo_epi16, _mm256_unpackhi_epi16, t, r)
+				EMP_TRANS_STEP(_mm256_unpacklo_epi32, _mm256_unpackhi_epi32, r, t)
+				EMP_TRANS_STEP(_mm256_unpacklo_epi64, _mm256_unpackhi_epi64, t, r)
+				for(int j = 0; j < 16; ++j) {
+					__m256i x = r[j], y;
+					y = (x ^ _mm256_srli_epi64(x, 7)) & m7;
+					x = x ^ y ^ _mm256_slli_epi64(y, 7);
+					y = (x ^ _mm256_srli_epi64(x, 14)) & m14;
+					x = x ^ y ^ _mm256_slli_epi64(y, 14);
+					y = (x ^ _mm256_srli_epi64(x, 28)) & m28;
+					x = x ^ y ^ _mm256_slli_epi64(y, 28);
+					stage[j][g] = _mm256_shuffle_epi8(x, interleave);
+				}
+			}
+			for(int j = 0; j < 16; ++j) {
+				__m256i w[8];
+				EMP_TRANS_WORDS(_mm256_unpacklo, _mm256_unpackhi, stage[j], w)
+				for(int i = 0; i < 8; ++i) {
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + j) + i), _mm256_castsi256_si128(w[i]));
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + 16 + j) + i), _mm256_extracti128_si256(w[i], 1));
+				}
+			}
+		}
+	}
+}
+
+EMP_AVX512_BEGIN
+// Needs nrows % 128 == 0 and ncols % 512 == 0
+__attribute__((target("avx512f,avx512bw,gfni")))
+inline void avx512_trans(uint8_t *out, uint8_t const *inp, uint64_t nrows, uint64_t ncols) {
+	const __m512i interleave = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15));
+	// Byte i of each word selects bit i: GF2P8AFFINEQB then transposes the other operand
+	const __m512i select = _mm512_set1_epi64(0x8040201008040201);
+	// stage[j][g]: 16-bit pieces of rows 16g..16g+15, column bytes j, 16+j, 32+j and 48+j
+	__m512i stage[16][8], r[16], t[16];
+	for(uint64_t rr = 0; rr < nrows; rr += 128) {
+		for(uint64_t cb = 0; cb < ncols / 8; cb += 64) {
+			for(int g = 0; g < 8; ++g) {
+				// The 8x8 bit transpose wants the rows of a word in reverse order
+				for(int k = 0; k < 16; ++k)
+					r[k] = _mm512_loadu_si512((const void *)&INP(rr + 16*g + (trans_row_order[k] ^ 7), 8*cb));
+				EMP_TRANS_STEP(_mm512_unpacklo_epi8, _mm512_unpackhi_epi8, r, t)
+				EMP_TRANS_STEP(_mm512_unpacklo_epi16, _mm512_unpackhi_epi16, t, r)
+				EMP_TRANS_STEP(_mm512_unpacklo_epi32, _mm512_unpackhi_epi32, r, t)
+				EMP_TRANS_STEP(_mm512_unpacklo_epi64, _mm512_unpackhi_epi64, t, r)
+				for(int j = 0; j < 16; ++j)
+					stage[j][g] = _mm512_shuffle_epi8(_mm512_gf2p8affine_epi64_epi8(select, r[j], 0), interleave);
+			}
+			for(int j = 0; j < 16; ++j) {
+				__m512i w[8];
+				EMP_TRANS_WORDS(_mm512_unpacklo, _mm512_unpackhi, stage[j], w)
+				for(int i = 0; i < 8; ++i) {
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + j) + i), _mm512_castsi512_si128(w[i]));
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + 16 + j) + i), _mm512_extracti32x4_epi32(w[i], 1));
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + 32 + j) + i), _mm512_extracti32x4_epi32(w[i], 2));
+					_mm_storeu_si128((__m128i *)&OUT(rr, 8*(cb + 48 + j) + i), _mm512_extracti32x4_epi32(w[i], 3));
+				}
+			}
+		}
+	}
+}
+EMP_AVX512_END
+#undef EMP_TRANS_STEP
+#undef EMP_TRANS_WORDS
+#endif
+
+enum TransKernel {TRANS_SSE, TRANS_AVX2, TRANS_AVX512};
+
+// Widest kernel this CPU runs, detected once
+inline TransKernel trans_kernel() {
+#ifdef __x86_64__
+	static const TransKernel kernel = []() {
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw") and __builtin_cpu_supports("gfni"))
+			return TRANS_AVX512;
+		if(__builtin_cpu_supports("avx2"))
+			return TRANS_AVX2;
+		return TRANS_SSE;
+	}();
+	return kernel;
+#else
+	return TRANS_SSE;
+#endif
+}
+
+// sse_trans with the given kernel, or sse_trans itself where the kernel does not fit the shape
+inline void bit_trans(uint8_t *out, uint8_t const *inp, uint64_t nrows, uint64_t ncols, TransKernel kernel) {
+#ifdef __x86_64__
+	if(kernel == TRANS_AVX512 and nrows % 128 == 0 and ncols % 512 == 0)
+		return avx512_trans(out, inp, nrows, ncols);
+	if(kernel >= TRANS_AVX2 and nrows % 128 == 0 and ncols % 256 == 0)
+		return avx2_trans(out, inp, nrows, ncols);
+#endif
+	sse_trans(out, inp, nrows, ncols);
+}
+
+inline void bit_trans(uint8_t *out, uint8_t const *inp, uint64_t nrows, uint64_t ncols) {
+	bit_trans(out, inp, nrows, ncols, trans_kernel());
+}
+}
+#endif// EMP_UTIL_TRANSPOSE_H__
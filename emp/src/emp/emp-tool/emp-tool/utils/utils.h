@@ -44,6 +44,11 @@ template<typename T>
 inline void from_bool(const bool * data, T * output, const int len, const bool reverse = false);
 
 
+// Bit i of out (bit i%8 of byte i/8) from in[i] for n bools; the rest of the last byte is 0
+void pack_bits(uint8_t * out, const bool * in, size_t n);
+
+void unpack_bits(bool * out, const uint8_t * in, size_t n);
+
 block bool_to_block(const bool * data);
 
 void block_to_bool(bool * data, block b);
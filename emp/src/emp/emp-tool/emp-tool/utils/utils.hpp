@@ -76,14 +76,93 @@ inline void from_bool(const bool * data, T * output, const int len, const bool r
 
 
 
+#ifdef __x86_64__
+// Whether pack_bits and unpack_bits take 64 bits per step: detected once, may be turned off
+inline bool & bits_use_avx512() {
+	static bool use = []() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw");
+	}();
+	return use;
+}
+
+EMP_AVX512_BEGIN
+// The whole 64-bit steps of pack_bits and unpack_bits; return the bits done
+__attribute__((target("avx512f,avx512bw")))
+inline size_t pack_bits_avx512(uint8_t * out, const bool * in, size_t n) {
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		__m512i v = _mm512_loadu_si512((const void *)(in + i));
+		uint64_t m = _mm512_test_epi8_mask(v, v);
+		memcpy(out + i/8, &m, 8);
+	}
+	return i;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline size_t unpack_bits_avx512(bool * out, const uint8_t * in, size_t n) {
+	// a masked move of a constant: a broadcast from a register costs an extra uop per step
+	const __m512i one = _mm512_set1_epi8(1);
+	size_t i = 0;
+	for(; i + 64 <= n; i += 64) {
+		uint64_t m;
+		memcpy(&m, in + i/8, 8);
+		_mm512_storeu_si512((void *)(out + i), _mm512_maskz_mov_epi8(m, one));
+	}
+	return i;
+}
+EMP_AVX512_END
+#endif
+
+inline void pack_bits(uint8_t * out, const bool * in, size_t n) {
+	size_t i = 0;
+#ifdef __x86_64__
+	if(bits_use_avx512())
+		i = pack_bits_avx512(out, in, n);
+#endif
+	// 16 bools at a time: bit 0 of each byte to its sign bit
+	for(; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+		uint16_t m = (uint16_t)_mm_movemask_epi8(_mm_slli_epi64(v, 7));
+		memcpy(out + i/8, &m, 2);
+	}
+	if(i < n)
+		memset(out + i/8, 0, (n - i + 7) / 8);
+	for(; i < n; ++i)
+		out[i/8] |= (uint8_t)in[i] << (i % 8);
+}
+
+inline void unpack_bits(bool * out, const uint8_t * in, size_t n) {
+	size_t i = 0;
+#ifdef __x86_64__
+	if(bits_use_avx512())
+		i = unpack_bits_avx512(out, in, n);
+#endif
+	// 16 bits at a time: each byte repeated 8 times, then one bit per copy
+	const __m128i select = _mm_set1_epi64x(0x8040201008040201LL);
+	const __m128i one = _mm_set1_epi8(1);
+	for(; i + 16 <= n; i += 16) {
+		uint16_t m;
+		memcpy(&m, in + i/8, 2);
+		__m128i v = _mm_cvtsi32_si128(m);
+		v = _mm_unpacklo_epi8(v, v);
+		v = _mm_unpacklo_epi16(v, v);
+		v = _mm_unpacklo_epi32(v, v);
+		v = _mm_cmpeq_epi8(_mm_and_si128(v, select), select);
+		_mm_storeu_si128((__m128i *)(out + i), _mm_and_si128(v, one));
+	}
+	for(; i < n; ++i)
+		out[i] = (in[i/8] >> (i % 8)) & 1;
+}
+
 inline block bool_to_block(const bool * data) {
-	return makeBlock(bool_to_int<uint64_t>(data+64), bool_to_int<uint64_t>(data));
+	block b;
+	pack_bits((uint8_t *)&b, data, 128);
+	return b;
 }
 
 inline void  block_to_bool(bool * data, block b) {
-	uint64_t* ptr = (uint64_t*)(&b);
-	int_to_bool<uint64_t>(data, ptr[0], 64);
-	int_to_bool<uint64_t>(data+64, ptr[1], 64);
+	unpack_bits(data, (const uint8_t *)&b, 128);
 }
 
 inline bool file_exists(const std::string &name) {
@@ -0,0 +1,380 @@
+#ifndef EMP_WORK_STEALING_H__
+#define EMP_WORK_STEALING_H__
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace emp {
+
+/*
+ * Thread pool where each worker owns a deque of tasks: it pushes and pops
+ * its own at the bottom, lock-free, and when it runs out steals from the
+ * top of the others' before it takes from the queue of tasks submitted
+ * from outside the pool, the only one behind a mutex. parallel_for()
+ * splits a loop into chunks without a task per chunk: every participant,
+ * the calling thread included, starts on its own contiguous range of them,
+ * taken one at a time with a CAS, and when done steals half of what is
+ * left of another range. A slow chunk then delays only itself instead of
+ * the fixed share of one thread. Workers may be pinned to CPUs (Linux),
+ * so that each keeps its caches. enqueue() is the one of ThreadPool.
+ */
+class WorkStealingPool { public:
+	typedef std::function<void()> Task;
+
+	// threads workers, the i-th pinned to the (i+1)-th CPU this process may use if pin
+	WorkStealingPool(int threads, bool pin = false): deques(threads), ranges(new Range[threads + 1]) {
+		workers.reserve(threads);
+		for(int i = 0; i < threads; ++i)
+			workers.emplace_back([this, i]() {
+				worker_index() = i;
+				worker_pool() = this;
+				run_worker(i);
+			});
+		if(pin)
+			pin_workers();
+	}
+
+	~WorkStealingPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			++epoch;
+		}
+		wake.notify_all();
+		for(auto & w : workers)
+			w.join();
+		for(auto t : injected)
+			delete t;
+	}
+
+	// Worker threads; parallel_for runs on these and the calling thread
+	int size() const {
+		return deques.size();
+	}
+
+	template<class F, class... Args>
+	auto enqueue(F && f, Args &&... args)
+			-> std::future<typename std::result_of<F(Args...)>::type> {
+		using return_type = typename std::result_of<F(Args...)>::type;
+		auto task = std::make_shared<std::packaged_task<return_type()>>(
+				std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+		std::future<return_type> res = task->get_future();
+		Task * t = new Task([task]() { (*task)(); });
+		// a worker keeps its own tasks, the others go through the queue
+		if(worker_pool() != this or !deques[worker_index()].push(t)) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(stop)
+				throw std::runtime_error("enqueue on stopped WorkStealingPool");
+			injected.push_back(t);
+		}
+		notify(false);
+		return res;
+	}
+
+	/* f(begin, end) over [0, n) in chunks of grain, the last one shorter;
+	 * every chunk starts at a multiple of grain. grain 0 picks about 8
+	 * chunks per participant. Returns when all are done. A call while
+	 * another one runs, e.g. from inside f, runs the same chunks in order on
+	 * its own thread, as does a pool without workers.
+	 * If f throws, the chunks not yet started are skipped and the first
+	 * exception is rethrown here once the others are done.
+	 */
+	template<typename F>
+	void parallel_for(int64_t n, int64_t grain, F f) {
+		if(n <= 0)
+			return;
+		int64_t parts = size() + 1;
+		if(grain <= 0)
+			grain = std::max<int64_t>(1, n / (8 * parts));
+		int64_t chunks = (n + grain - 1) / grain;
+		if(chunks == 1 or size() == 0 or chunks >= (1LL << 32) or job_busy.exchange(true)) {
+			for(int64_t b = 0; b < n; b += grain)
+				f(b, std::min(n, b + grain));
+			return;
+		}
+		job.run = [](const void * f, int64_t b, int64_t e) {
+			(*(const F *)f)(b, e);
+		};
+		job.f = &f;
+		job.n = n;
+		job.grain = grain;
+		job.remaining.store(chunks);
+		for(int64_t s = 0; s < parts; ++s)
+			ranges[s].v.store(pack(s * chunks / parts, (s + 1) * chunks / parts));
+		job_gen.fetch_add(1);
+		notify(true);
+
+		run_chunks(parts - 1);
+		while(job.remaining.load() > 0)
+			std::this_thread::yield();
+		// closed: a worker still about to join sees the new generation and leaves
+		job_gen.fetch_add(1);
+		while(job.active.load() > 0)
+			std::this_thread::yield();
+		std::exception_ptr e = job.exception;
+		job.exception = nullptr;
+		job.failed.store(false);
+		job_busy.store(false);
+		if(e)
+			std::rethrow_exception(e);
+	}
+
+	template<typename F>
+	void parallel_for(int64_t n, F f) {
+		parallel_for(n, 0, f);
+	}
+
+private:
+	/* Chase-Lev deque of fixed capacity ("Correct and Efficient Work-Stealing
+	 * for Weak Memory Models", PPoPP 2013): push and pop by the owner only
+	 */
+	class TaskDeque { public:
+		static const int64_t capacity = 1024;
+		TaskDeque() {
+			for(auto & t : buf)
+				t.store(nullptr, std::memory_order_relaxed);
+		}
+
+		// false if full
+		bool push(Task * t) {
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t tp = top.load(std::memory_order_acquire);
+			if(b - tp >= capacity)
+				return false;
+			buf[b & (capacity - 1)].store(t, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		Task * pop() {
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+			Task * x = nullptr;
+			if(t <= b) {
+				x = buf[b & (capacity - 1)].load(std::memory_order_relaxed);
+				if(t == b) {
+					// the last one: a thief may take it first
+					if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						x = nullptr;
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+			} else bottom.store(b + 1, std::memory_order_relaxed);
+			return x;
+		}
+
+		Task * steal() {
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+			if(t >= b)
+				return nullptr;
+			Task * x = buf[t & (capacity - 1)].load(std::memory_order_relaxed);
+			if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return x;
+		}
+
+	private:
+		std::atomic<int64_t> top{0};
+		char pad[56];
+		std::atomic<int64_t> bottom{0};
+		std::atomic<Task *> buf[capacity];
+	};
+
+	// The chunks [lo, hi) left to one participant, as hi << 32 | lo, on its own cache line
+	struct Range {
+		std::atomic<uint64_t> v{0};
+		char pad[56];
+	};
+
+	// The loop of the running parallel_for
+	struct Job {
+		void (*run)(const void *, int64_t, int64_t) = nullptr;
+		const void * f = nullptr;
+		int64_t n = 0, grain = 0;
+		std::atomic<int64_t> remaining{0};
+		// workers that joined this generation
+		std::atomic<int> active{0};
+		// the first exception of f, set by whoever set failed
+		std::atomic<bool> failed{false};
+		std::exception_ptr exception;
+	};
+
+	std::vector<TaskDeque> deques;
+	std::unique_ptr<Range[]> ranges;
+	std::deque<Task *> injected;
+	std::mutex mutex;
+	std::condition_variable wake;
+	// changed under mutex by everything that gives the workers something to do
+	uint64_t epoch = 0;
+	bool stop = false;
+
+	Job job;
+	// odd while a parallel_for is open to workers
+	std::atomic<uint64_t> job_gen{0};
+	std::atomic<bool> job_busy{false};
+	std::vector<std::thread> workers;
+
+	static int & worker_index() {
+		static thread_local int index = -1;
+		return index;
+	}
+	static WorkStealingPool * & worker_pool() {
+		static thread_local WorkStealingPool * pool = nullptr;
+		return pool;
+	}
+
+	static uint64_t pack(int64_t lo, int64_t hi) {
+		return (uint64_t)hi << 32 | (uint64_t)lo;
+	}
+
+	void notify(bool all) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			++epoch;
+		}
+		if(all)
+			wake.notify_all();
+		else wake.notify_one();
+	}
+
+	// The next chunk of range self, or -1
+	int64_t take(int self) {
+		uint64_t v = ranges[self].v.load();
+		while((uint32_t)v < (v >> 32))
+			if(ranges[self].v.compare_exchange_weak(v, v + 1))
+				return (uint32_t)v;
+		return -1;
+	}
+
+	// Moves the upper half of the first nonempty other range into range self, which is empty
+	bool steal_range(int self, int parts) {
+		for(int k = 1; k < parts; ++k) {
+			Range & r = ranges[(self + k) % parts];
+			uint64_t v = r.v.load();
+			for(;;) {
+				int64_t lo = (uint32_t)v, hi = v >> 32;
+				if(lo >= hi)
+					break;
+				int64_t mid = lo + (hi - lo) / 2;
+				if(r.v.compare_exchange_weak(v, pack(lo, mid))) {
+					ranges[self].v.store(pack(mid, hi));
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void run_chunks(int self) {
+		int parts = size() + 1;
+		for(;;) {
+			int64_t c = take(self);
+			if(c < 0) {
+				if(steal_range(self, parts))
+					continue;
+				return;
+			}
+			int64_t b = c * job.grain;
+			// an exception must not leave a worker: it would end the process
+			if(!job.failed.load()) {
+				try {
+					job.run(job.f, b, std::min(job.n, b + job.grain));
+				} catch(...) {
+					if(!job.failed.exchange(true))
+						job.exception = std::current_exception();
+				}
+			}
+			job.remaining.fetch_sub(1);
+		}
+	}
+
+	// Works on the open parallel_for once per generation
+	bool join_job(int i, uint64_t & joined) {
+		uint64_t g = job_gen.load();
+		if(g % 2 == 0 or g == joined)
+			return false;
+		job.active.fetch_add(1);
+		if(job_gen.load() == g) {
+			joined = g;
+			run_chunks(i);
+		}
+		job.active.fetch_sub(1);
+		return joined == g;
+	}
+
+	// Runs a task: its own, a stolen one, or one submitted from outside
+	bool run_task(int i) {
+		Task * t = deques[i].pop();
+		for(int k = 1; t == nullptr and k < size(); ++k)
+			t = deques[(i + k) % size()].steal();
+		if(t == nullptr) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!injected.empty()) {
+				t = injected.front();
+				injected.pop_front();
+			}
+		}
+		if(t == nullptr)
+			return false;
+		(*t)();
+		delete t;
+		return true;
+	}
+
+	void run_worker(int i) {
+		uint64_t joined = 0;
+		for(;;) {
+			if(join_job(i, joined) or run_task(i))
+				continue;
+			uint64_t seen;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if(stop)
+					return;
+				seen = epoch;
+			}
+			// anything submitted since the last look has changed epoch
+			if(join_job(i, joined) or run_task(i))
+				continue;
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stop or epoch != seen; });
+		}
+	}
+
+	void pin_workers() {
+#ifdef __linux__
+		cpu_set_t allowed;
+		if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+			return;
+		std::vector<int> cpus;
+		for(int c = 0; c < CPU_SETSIZE; ++c)
+			if(CPU_ISSET(c, &allowed))
+				cpus.push_back(c);
+		for(size_t i = 0; i < workers.size() and !cpus.empty(); ++i) {
+			cpu_set_t one;
+			CPU_ZERO(&one);
+			CPU_SET(cpus[(i + 1) % cpus.size()], &one);
+			pthread_setaffinity_np(workers[i].native_handle(), sizeof(one), &one);
+		}
+#endif
+	}
+};
+}
+#endif// EMP_WORK_STEALING_H__
@@ -3,6 +3,45 @@
 using namespace std;
 using namespace emp;
 
+template<int K, int H>
+void check_para_enc(PRG & prg) {
+	AES_KEY keys[K];
+	block user_key[K], blks[K*H], expected[K*H];
+	prg.random_block(user_key, K);
+	for(int i = 0; i < K; ++i)
+		AES_set_encrypt_key(user_key[i], keys+i);
+	prg.random_block(blks, K*H);
+	memcpy(expected, blks, sizeof(blks));
+	ParaEnc_ni<K, H>(expected, keys);
+	ParaEnc<K, H>(blks, keys);
+	if(!cmpBlock(blks, expected, K*H))
+		error("ParaEnc test fail!");
+}
+
+// Time of f in ns, averaged over runs
+template<typename F>
+double bench(int runs, F f) {
+	auto start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		f();
+	return time_from(start) * 1000 / runs;
+}
+
+// AES-NI against VAES (when the CPU has it) on the same work
+template<typename F>
+void compare(const char * name, double blocks, int runs, F f) {
+	bool vaes = aes_use_vaes();
+	aes_use_vaes() = false;
+	double ni = bench(runs, f);
+	cout << name << "\tAES-NI " << blocks / ni * 1e3 << " M blocks/s";
+	if(vaes) {
+		aes_use_vaes() = true;
+		double v = bench(runs, f);
+		cout << "\tVAES " << blocks / v * 1e3 << " M blocks/s\t" << ni / v << "x";
+	}
+	cout << endl;
+}
+
 int main() {
 	for(int t = 0; t < 1000; ++t) {
 		block key[8];
@@ -50,7 +89,42 @@ int main() {
 		error("AES test vector fail!");
 	}
 
+	// The VAES paths against AES-NI, if the CPU has VAES
+	PRG prg;
+	for(int t = 0; t < 100; ++t) {
+		check_para_enc<8, 1>(prg);
+		check_para_enc<8, 2>(prg);
+		check_para_enc<8, 4>(prg);
+		check_para_enc<4, 1>(prg);
+		check_para_enc<2, 2>(prg);
+		check_para_enc<2, 1>(prg);
+		check_para_enc<1, 4>(prg);
+		check_para_enc<3, 3>(prg);
+	}
+	block blks[70], expected[70];
+	for(unsigned int n = 0; n <= 70; ++n) {
+		prg.random_block(blks, n);
+		memcpy(expected, blks, n*sizeof(block));
+		AES_ecb_encrypt_blks_ni(expected, n, KEY);
+		AES_ecb_encrypt_blks(blks, n, KEY);
+		if(!cmpBlock(blks, expected, n))
+			error("AES ECB test fail!");
+	}
+
 	cout <<"all tests pass!\n";
+
+	block user_key[8], data[1024];
+	AES_KEY keys[8];
+	prg.random_block(user_key, 8);
+	prg.random_block(data, 1024);
+	AES_opt_key_schedule<8>(user_key, keys);
+	compare("key schedule, 8 keys", 8, 100000, [&]() {
+		AES_opt_key_schedule<8>(user_key, keys);
+		user_key[0] = keys[7].rd_key[10];
+	});
+	compare("ParaEnc<8,2>", 16, 1000000, [&]() {ParaEnc<8, 2>(data, keys);});
+	compare("ParaEnc<8,4>", 32, 1000000, [&]() {ParaEnc<8, 4>(data, keys);});
+	compare("ECB, 1024 blocks", 1024, 10000, [&]() {AES_ecb_encrypt_blks(data, 1024, KEY);});
 	
 	return 0;
 }
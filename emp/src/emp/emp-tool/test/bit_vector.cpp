@@ -0,0 +1,178 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+// Packing against the bit-by-bit conversions, for lengths around the SIMD steps
+void test_pack(PRG & prg) {
+	for(size_t n : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 127, 128, 129, 1000, 4099}) {
+		vector<uint8_t> raw(n + 1);
+		prg.random_data(raw.data(), raw.size());
+		bool * b = new bool[n + 1], * back = new bool[n + 1];
+		for(size_t i = 0; i < n; ++i)
+			b[i] = raw[i] & 1;
+		vector<uint8_t> packed((n + 7) / 8 + 1, 0xff), expected((n + 7) / 8 + 1, 0xff);
+		memset(expected.data(), 0, (n + 7) / 8);
+		for(size_t i = 0; i < n; ++i)
+			expected[i / 8] |= b[i] << (i % 8);
+		pack_bits(packed.data(), b, n);
+		if(packed != expected)
+			error("pack_bits");
+		back[n] = true;
+		unpack_bits(back, packed.data(), n);
+		if(memcmp(back, b, n) != 0 or !back[n])
+			error("unpack_bits");
+		delete[] b;
+		delete[] back;
+	}
+
+	bool b[128], back[128];
+	prg.random_bool(b, 128);
+	block blk = bool_to_block(b), expected = makeBlock(bool_to_int<uint64_t>(b + 64), bool_to_int<uint64_t>(b));
+	if(!cmpBlock(&blk, &expected, 1))
+		error("bool_to_block");
+	block_to_bool(back, blk);
+	if(memcmp(back, b, 128) != 0)
+		error("block_to_bool");
+}
+
+void test_bit_vector(PRG & prg) {
+	size_t n = 1000;
+	bool * b = new bool[n], * c = new bool[n];
+	prg.random_bool(b, n);
+	prg.random_bool(c, n);
+	for(size_t i = 0; i < n; ++i)
+		if((uint8_t)b[i] > 1)
+			error("random_bool");
+	BitVector v, w;
+	v.from_bools(b, n);
+	w.from_bools(c, n);
+	for(size_t i = 0; i < n; ++i)
+		if(v[i] != b[i])
+			error("from_bools");
+
+	// Bit copies at offsets that do and do not line up with the words
+	for(int t = 0; t < 200; ++t) {
+		size_t r[3];
+		prg.random_data(r, sizeof(r));
+		size_t len = r[0] % (n + 1), dst = r[1] % (n - len + 1), src = r[2] % (n - len + 1);
+		BitVector u = w;
+		u.copy(dst, v, src, len);
+		for(size_t i = 0; i < n; ++i)
+			if(u[i] != (i >= dst and i < dst + len ? b[src + i - dst] : c[i]))
+				error("copy");
+	}
+
+	v ^= w;
+	for(size_t i = 0; i < n; ++i)
+		if(v[i] != (b[i] != c[i]))
+			error("xor");
+
+	vector<block> labels(n);
+	prg.random_block(labels.data(), n);
+	v.from_lsbs(labels.data(), n);
+	v.to_bools(c);
+	for(size_t i = 0; i < n; ++i)
+		if(c[i] != getLSB(labels[i]))
+			error("from_lsbs");
+
+	// Bits past the size stay 0
+	v.resize(3);
+	v.resize(128);
+	for(size_t i = 3; i < 128; ++i)
+		if(v[i])
+			error("resize");
+	prg.random_bits(v);
+	v.resize(100);
+	if(v.blocks()[0][1] >> 36 != 0)
+		error("random_bits");
+
+	// random_bool spreads the bits random_bits packs, over several batches
+	block seed = makeBlock(1, 2);
+	PRG p1(&seed), p2(&seed);
+	size_t m = 10000;
+	BitVector bits(m);
+	bool * d = new bool[m];
+	p1.random_bits(bits);
+	p2.random_bool(d, m);
+	for(size_t i = 0; i < m; ++i)
+		if(d[i] != bits[i])
+			error("random_bool");
+	delete[] b;
+	delete[] c;
+	delete[] d;
+}
+
+// random_bool as it was, one byte of PRG output per bool
+void random_bool_bytes(PRG & prg, bool * data, int length) {
+	uint8_t * uint_data = (uint8_t*)data;
+	prg.random_data_unaligned(uint_data, length);
+	for(int i = 0; i < length; ++i)
+		data[i] = uint_data[i] & 1;
+}
+
+void bench(PRG & prg, size_t n, int runs) {
+	bool * b = new bool[n];
+	prg.random_bool(b, n);
+	vector<uint8_t> packed((n + 7) / 8);
+	auto start = clock_start();
+	for(int r = 0; r < runs; ++r) {
+		memset(packed.data(), 0, packed.size());
+		for(size_t i = 0; i < n; ++i)
+			packed[i / 8] |= b[i] << (i % 8);
+		b[r % n] ^= packed[0] & 1;
+	}
+	double loop = time_from(start) / runs;
+	start = clock_start();
+	for(int r = 0; r < runs; ++r) {
+		pack_bits(packed.data(), b, n);
+		b[r % n] ^= packed[0] & 1;
+	}
+	double pack = time_from(start) / runs;
+	start = clock_start();
+	for(int r = 0; r < runs; ++r) {
+		unpack_bits(b, packed.data(), n);
+		packed[r % packed.size()] ^= b[0];
+	}
+	double unpack = time_from(start) / runs;
+	start = clock_start();
+	for(int r = 0; r < runs; ++r)
+		prg.random_bool(b, n);
+	double rand_bool = time_from(start) / runs;
+	start = clock_start();
+	for(int r = 0; r < runs; ++r)
+		random_bool_bytes(prg, b, n);
+	double rand_bytes = time_from(start) / runs;
+	BitVector v(n);
+	start = clock_start();
+	for(int r = 0; r < runs; ++r)
+		prg.random_bits(v);
+	double rand_bits = time_from(start) / runs;
+	cout << n << " bits: " << n << " bytes as bools, " << v.byte_size() << " packed" << endl;
+	cout << "pack\t" << pack << " us (" << loop / pack << "x the bit loop)\tunpack\t" << unpack << " us" << endl;
+	cout << "random_bool\t" << rand_bool << " us (" << rand_bytes << " us from bytes)\trandom_bits\t" << rand_bits << " us" << endl;
+	delete[] b;
+}
+
+int main() {
+	PRG prg;
+	test_pack(prg);
+	test_bit_vector(prg);
+#ifdef __x86_64__
+	bool avx512 = bits_use_avx512();
+	bits_use_avx512() = false;
+	test_pack(prg);
+	test_bit_vector(prg);
+	bits_use_avx512() = avx512;
+#endif
+	cout << "BitVector matches the bool conversions" << endl;
+	bench(prg, 1<<20, 20);
+#ifdef __x86_64__
+	if(avx512) {
+		bits_use_avx512() = false;
+		cout << "without AVX-512:" << endl;
+		bench(prg, 1<<20, 20);
+	}
+#endif
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+#include <sys/wait.h>
+using namespace std;
+using namespace emp;
+
+// Plaintext evaluation on whole blocks: 128 parallel runs of the circuit
+class BitsliceExec: public CircuitExecution { public:
+	block and_gate(const block& a, const block& b) override {
+		return a & b;
+	}
+	block xor_gate(const block& a, const block& b) override {
+		return a ^ b;
+	}
+	block not_gate(const block& a) override {
+		return a ^ all_one_block;
+	}
+	block public_label(bool b) override {
+		return b ? all_one_block : zero_block;
+	}
+};
+
+template<typename T>
+void check(const T & text, const BinaryCircuit & bin, int64_t n1, int64_t n2, int64_t n3) {
+	if(bin.num_gate != text.num_gate or bin.num_wire != text.num_wire
+			or bin.n1 != n1 or bin.n2 != n2 or bin.n3 != n3
+			or memcmp(bin.gates, text.gates.data(), 4*sizeof(int)*text.num_gate) != 0)
+		error("binary circuit differs");
+}
+
+void test(const string & file) {
+	auto start = clock_start();
+	BristolFormat text(file.c_str());
+	double t_text = time_from(start);
+	to_binary_circuit(text, "circuit.bin");
+	start = clock_start();
+	BinaryCircuit bin("circuit.bin");
+	double t_bin = time_from(start);
+	check(text, bin, text.n1, text.n2, text.n3);
+
+	CircuitExecution::circ_exec = new BitsliceExec();
+	PRG prg;
+	vector<block> in(text.n1 + text.n2), out1(text.n3), out2(text.n3);
+	prg.random_block(in.data(), in.size());
+	text.compute(out1.data(), in.data(), in.data() + text.n1);
+	bin.compute(out2.data(), in.data(), in.data() + text.n1);
+	if(!cmpBlock(out1.data(), out2.data(), text.n3))
+		error("binary circuit computes differently");
+	delete CircuitExecution::circ_exec;
+	remove("circuit.bin");
+	cout << file << ": text " << t_text/1000 << " ms, binary " << t_bin/1000 << " ms" << endl;
+}
+
+void test_fashion(const string & file) {
+	BristolFashion text(file.c_str());
+	to_binary_circuit(text, "circuit.bin");
+	BinaryCircuit bin("circuit.bin");
+	check(text, bin, text.num_input, 0, text.num_output);
+	remove("circuit.bin");
+}
+
+// Loading file must fail; error() exits, so the load runs in a child process
+void expect_rejected(const char * file) {
+	pid_t pid = fork();
+	if(pid == 0) {
+		fclose(stderr);
+		BinaryCircuit bin(file);
+		_exit(0);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	if(!WIFEXITED(status) or WEXITSTATUS(status) != 1)
+		error("malformed binary circuit accepted");
+}
+
+// A small valid circuit, then copies with a bad header or gate
+void test_malformed() {
+	int gates[] = {0, 1, 2, AND_GATE, 2, 0, 3, NOT_GATE};
+	write_binary_circuit("circuit.bin", 2, 4, 1, 1, 1, gates);
+	BinaryCircuit ok("circuit.bin");
+
+	write_binary_circuit("circuit.bin", 2, 4, 3, 2, 1, gates);
+	expect_rejected("circuit.bin");
+	write_binary_circuit("circuit.bin", 2, 4, 1, 1, 5, gates);
+	expect_rejected("circuit.bin");
+	for(int64_t num_gate : {3, 1, -1}) {
+		write_binary_circuit("circuit.bin", 2, 4, 1, 1, 1, gates);
+		FILE * f = fopen("circuit.bin", "r+b");
+		fseek(f, offsetof(BinaryCircuitHeader, num_gate), SEEK_SET);
+		fwrite(&num_gate, sizeof(num_gate), 1, f);
+		fclose(f);
+		expect_rejected("circuit.bin");
+	}
+	write_binary_circuit("circuit.bin", 2, 4, 1, 1, 1, gates);
+	if(truncate("circuit.bin", sizeof(BinaryCircuitHeader) + 20) != 0)
+		error("truncate");
+	expect_rejected("circuit.bin");
+
+	int bad_out[] = {0, 1, 4, AND_GATE, 2, 0, 3, NOT_GATE};
+	write_binary_circuit("circuit.bin", 2, 4, 1, 1, 1, bad_out);
+	expect_rejected("circuit.bin");
+	int bad_in[] = {0, -1, 2, XOR_GATE, 2, 0, 3, NOT_GATE};
+	write_binary_circuit("circuit.bin", 2, 4, 1, 1, 1, bad_in);
+	expect_rejected("circuit.bin");
+	remove("circuit.bin");
+}
+
+int main(void) {
+	test_malformed();
+	string dir = "./emp-tool/circuits/files/";
+	for(auto f : {"adder_32bit.txt", "AES-non-expanded.txt", "sha-1.txt", "sha-256.txt"})
+		test(dir + "bristol_format/" + f);
+	for(auto f : {"aes_128.txt", "sha256.txt"})
+		test_fashion(dir + "bristol_fashion/" + f);
+	return 0;
+}
@@ -120,6 +120,76 @@ void test_float(int func_id, double precision, double minimize, int runs = 1000)
 	cout << "function " << test_str[func_id] <<"\t\t\tDONE"<<"  -  accuracy : "<<(1.0-(float)rate_cnt/runs)<<endl;
 }
 
+void test_accumulator(float scale, int runs = 100, int len = 10) {
+	PRG prg;
+	for(int i = 0; i < runs; ++i) {
+		FloatAccumulator acc;
+		FloatAccumulator count(0, 0, 8);
+		long double sum = 0;
+		for(int j = 0; j < len; ++j) {
+			int ia = 0;
+			prg.random_data(&ia, 4);
+			float da = (float)(ia) / 10000000.0 * scale;
+			acc.add(Float(da, PUBLIC));
+			count.add(Bit(j % 2 == 0, PUBLIC));
+			sum += da;
+		}
+		if (not equal(acc.value(), (float)sum) or not equal(count.value(), (float)((len+1)/2)))
+			cout << "Inaccuracy:\taccumulator\t"<<(float)sum<<"\t"<<acc.value().reveal<double>(PUBLIC)<<endl;
+	}
+	FloatAccumulator acc;
+	acc.add(Float(3e38, PUBLIC));
+	acc.add(Float(3e38, PUBLIC));
+	if (not equal(acc.value(), INFINITY))
+		cout << "Inaccuracy:\taccumulator overflow\t"<<acc.value().reveal<double>(PUBLIC)<<endl;
+	cout << "accumulator "<<scale<<"\t\t\tDONE"<<endl;
+}
+
+void test_dot_product(int runs = 20, int len = 10) {
+	PRG prg;
+	for(int i = 0; i < runs; ++i) {
+		Float a[len], b[len];
+		double sum = 0;
+		for(int j = 0; j < len; ++j) {
+			int16_t ia = 0, ib = 0;
+			prg.random_data(&ia, 2);
+			prg.random_data(&ib, 2);
+			float da = ia / 256.0, db = ib / 256.0;
+			a[j] = Float(da, PUBLIC);
+			b[j] = Float(db, PUBLIC);
+			sum += (double)da * db;
+		}
+		Float res = dot_product(a, b, len);
+		if (not equal(res, (float)sum))
+			cout << "Inaccuracy:\tdot_product\t"<<(float)sum<<"\t"<<res.reveal<double>(PUBLIC)<<endl;
+	}
+	Float tiny[2] = {Float(1e-30, PUBLIC), Float(1e-20, PUBLIC)};
+	if (not equal(dot_product(tiny, tiny+1, 1), 1e-30f * 1e-20f))
+		cout << "Inaccuracy:\tdot_product subnormal\t"<<dot_product(tiny, tiny+1, 1).reveal<double>(PUBLIC)<<endl;
+	cout << "dot_product\t\t\tDONE"<<endl;
+}
+
+void bench_float(int runs = 2000) {
+	Float a(1.5, ALICE), b(-2.25, ALICE), c;
+	auto start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		c = a + b;
+	cout << "Benchmark: add " << runs/time_from(start)*1e6 << " operations/second" << endl;
+	start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		c = a * b;
+	cout << "Benchmark: mul " << runs/time_from(start)*1e6 << " operations/second" << endl;
+	start = clock_start();
+	for(int i = 0; i < runs; ++i)
+		c = a.exp();
+	cout << "Benchmark: exp " << runs/time_from(start)*1e6 << " operations/second" << endl;
+	start = clock_start();
+	Bit d;
+	for(int i = 0; i < runs; ++i)
+		d = a.less_than(b);
+	cout << "Benchmark: less_than " << runs/time_from(start)*1e6 << " operations/second" << endl;
+}
+
 void scratch_pad(double num) {
 	cout << "input: " << num << endl;
 	Float x(num, PUBLIC);
@@ -193,6 +263,13 @@ int main(int argc, char** argv) {
 	test_float(5, 1e-3, 1e18);
 	test_float(6, 1e-3, 1e12);
 	test_float(7, 1e-3, 1e12);
+	test_accumulator(1.0);
+	test_accumulator(1e-38);
+	test_accumulator(1e30);
+	test_dot_product();
+
+	cout << endl << "Benchmark:" << endl;
+	bench_float();
 
 	finalize_plain_prot();
 	return 0;
@@ -12,6 +12,104 @@ void printt(block a) {
 	printf("\n");
 }
 
+// Garbles with and_gate_batch and evaluates gate by gate, and the other way round
+void test_batch(bool batch_gen, size_t n = 1027) {
+	MemIO * io = new MemIO();
+	HalfGateGen<MemIO> * gen = new HalfGateGen<MemIO>(io);
+	HalfGateEva<MemIO> * eva = new HalfGateEva<MemIO>(io);
+	PRG prg;
+	vector<block> a(n), b(n), out(n), la(n), lb(n), lout(n);
+	bool * ba = new bool[n], * bb = new bool[n];
+	prg.random_block(a.data(), n);
+	prg.random_block(b.data(), n);
+	prg.random_bool(ba, n);
+	prg.random_bool(bb, n);
+	for(size_t i = 0; i < n; ++i) {
+		la[i] = ba[i] ? a[i] ^ gen->delta : a[i];
+		lb[i] = bb[i] ? b[i] ^ gen->delta : b[i];
+	}
+	// start off a MITCCRH batch boundary
+	out[0] = gen->and_gate(a[0], b[0]);
+	if(batch_gen)
+		gen->and_gate_batch(a.data()+1, b.data()+1, out.data()+1, n-1);
+	else for(size_t i = 1; i < n; ++i)
+		out[i] = gen->and_gate(a[i], b[i]);
+
+	lout[0] = eva->and_gate(la[0], lb[0]);
+	if(batch_gen) for(size_t i = 1; i < n; ++i)
+		lout[i] = eva->and_gate(la[i], lb[i]);
+	else
+		eva->and_gate_batch(la.data()+1, lb.data()+1, lout.data()+1, n-1);
+
+	for(size_t i = 0; i < n; ++i) {
+		block expected = (ba[i] and bb[i]) ? out[i] ^ gen->delta : out[i];
+		if(cmpBlock(&expected, &lout[i], 1) == false) {cout << "wrong batch" << endl; abort();}
+	}
+	delete gen;
+	delete eva;
+	delete io;
+	delete[] ba;
+	delete[] bb;
+}
+
+// Mixes public and private inputs; gates with a public input must not send a table
+void test_public(bool batch, size_t n = 1027) {
+	MemIO * io = new MemIO();
+	HalfGateGen<MemIO> * gen = new HalfGateGen<MemIO>(io);
+	HalfGateEva<MemIO> * eva = new HalfGateEva<MemIO>(io);
+	PRG prg;
+	vector<block> a(n), b(n), out(n), la(n), lb(n), lout(n);
+	bool * ba = new bool[n], * bb = new bool[n];
+	int * kind = new int[n];
+	prg.random_block(a.data(), n);
+	prg.random_block(b.data(), n);
+	prg.random_bool(ba, n);
+	prg.random_bool(bb, n);
+	prg.random_data(kind, n*sizeof(int));
+	size_t private_gates = 0;
+	for(size_t i = 0; i < n; ++i) {
+		// public a, public b, both or neither
+		kind[i] &= 3;
+		if(kind[i] & 1) {
+			a[i] = gen->public_label(ba[i]);
+			la[i] = eva->public_label(ba[i]);
+		} else la[i] = ba[i] ? a[i] ^ gen->delta : a[i];
+		if(kind[i] & 2) {
+			b[i] = gen->public_label(bb[i]);
+			lb[i] = eva->public_label(bb[i]);
+		} else lb[i] = bb[i] ? b[i] ^ gen->delta : b[i];
+		if(kind[i] == 0)
+			++private_gates;
+	}
+	int64_t before = io->size;
+	if(batch) {
+		gen->and_gate_batch(a.data(), b.data(), out.data(), n);
+		eva->and_gate_batch(la.data(), lb.data(), lout.data(), n);
+	} else for(size_t i = 0; i < n; ++i) {
+		out[i] = gen->and_gate(a[i], b[i]);
+		lout[i] = eva->and_gate(la[i], lb[i]);
+	}
+	if(io->size - before != (int64_t)(private_gates*2*sizeof(block))) {cout << "table sent for public gate" << endl; abort();}
+
+	for(size_t i = 0; i < n; ++i) {
+		block expected = (ba[i] and bb[i]) ? out[i] ^ gen->delta : out[i];
+		if(cmpBlock(&expected, &lout[i], 1) == false) {cout << "wrong public" << endl; abort();}
+		if(kind[i] == 3) {
+			block pub = eva->public_label(ba[i] and bb[i]);
+			if(cmpBlock(&pub, &lout[i], 1) == false) {cout << "public output not folded" << endl; abort();}
+		}
+	}
+	block x = gen->xor_gate(gen->public_label(true), gen->public_label(true));
+	block lx = eva->xor_gate(eva->public_label(true), eva->public_label(true));
+	if(!cmpBlock(&x, gen->constant, 1) or !cmpBlock(&lx, eva->constant, 1)) {cout << "public xor not folded" << endl; abort();}
+	delete gen;
+	delete eva;
+	delete io;
+	delete[] ba;
+	delete[] bb;
+	delete[] kind;
+}
+
 int main(void) {
 	// sender
 	block data[2], delta, table[2], w0, w1;
@@ -48,6 +146,16 @@ int main(void) {
 	}
 	cout << "check\n";
 
+	cout << "Batch correctness ... ";
+	test_batch(true);
+	test_batch(false);
+	cout << "check\n";
+
+	cout << "Public folding ... ";
+	test_public(true);
+	test_public(false);
+	cout << "check\n";
+
 	cout << "Efficiency: ";
 	auto start = clock_start();
 	for(int i = 0; i < 1024*1024*2; ++i) {
@@ -61,5 +169,27 @@ int main(void) {
 	}
 	cout << 1024*1024*128/(time_from(start))*1e6 << " gates/second" << endl;
 
+	cout << "Batch efficiency: ";
+	const int n = 1024;
+	MemIO * io = new MemIO(n*32+1024);
+	HalfGateGen<MemIO> gen(io);
+	vector<block> a(n), b(n), c(n);
+	prg.random_block(a.data(), n);
+	prg.random_block(b.data(), n);
+	start = clock_start();
+	for(int i = 0; i < 1024*2; ++i) {
+		io->clear();
+		gen.and_gate_batch(a.data(), b.data(), c.data(), n);
+	}
+	cout << 1024*2*n/(time_from(start))*1e6 << " garbled gates/second, ";
+	start = clock_start();
+	for(int i = 0; i < 1024*2; ++i) {
+		io->clear();
+		for(int j = 0; j < n; ++j)
+			c[j] = gen.and_gate(a[j], b[j]);
+	}
+	cout << 1024*2*n/(time_from(start))*1e6 << " without batching" << endl;
+	delete io;
+
 	return 0;
 }
@@ -34,6 +34,111 @@ void test_int(int party, int range1 = 1<<25, int range2 = 1<<25, int runs = 1000
 	cout << typeid(Op2).name()<<"\t\t\tDONE"<<endl;
 }
 
+void check_udiv(int size1, int size2, int quot_width, uint64_t ia, uint64_t ib) {
+	Integer a(size1, ia, ALICE);
+	Integer b(size2, ib, BOB);
+	uint64_t quot = a.udiv(b, quot_width).reveal<uint64_t>(PUBLIC);
+	uint64_t rem = a.umod(b).reveal<uint64_t>(PUBLIC);
+	if (quot != ia / ib or rem != ia % ib)
+		cout << ia <<"\t"<<ib<<"\t"<<quot<<"\t"<<rem<<endl;
+	assert(quot == ia / ib and rem == ia % ib);
+}
+
+// Largest size1-bit dividend whose quotient by ib fits in quot_width bits
+uint64_t max_dividend(int size1, int quot_width, uint64_t ib) {
+	uint64_t ones = size1 == 64 ? ~0ULL : (1ULL << size1) - 1;
+	unsigned __int128 bound = ((unsigned __int128)ib << quot_width) - 1;
+	return bound < ones ? (uint64_t)bound : ones;
+}
+
+void test_udiv(int size1, int size2, int quot_width, int runs = 1000) {
+	PRG prg;
+	for(int i = 0; i < runs; ++i) {
+		uint64_t ia, ib;
+		prg.random_data(&ia, 8);
+		prg.random_data(&ib, 8);
+		ib = (ib >> (64 - size2)) | 1;
+		ia = ia >> (64 - size1);
+		if(quot_width < size1)
+			ia = ia % (ib << quot_width);
+		check_udiv(size1, size2, quot_width, ia, ib);
+	}
+	// quotients that use all quot_width bits, by 1, the top bit alone and the all-ones divisor
+	uint64_t one = 1, ones2 = (one << size2) - 1;
+	for(uint64_t ib : {one, one << (size2 - 1), ones2}) {
+		uint64_t ia = max_dividend(size1, quot_width, ib);
+		check_udiv(size1, size2, quot_width, ia, ib);
+		check_udiv(size1, size2, quot_width, ia - ia % ib, ib);
+	}
+	cout << "udiv "<<size1<<"/"<<size2<<" ("<<quot_width<<")\t\t\tDONE"<<endl;
+}
+
+void test_dot_product(int frac_bits, int runs = 100, int len = 10) {
+	PRG prg;
+	for(int i = 0; i < runs; ++i) {
+		Integer a[len], b[len];
+		__int128 sum = 0;
+		for(int j = 0; j < len; ++j) {
+			int ia, ib;
+			prg.random_data(&ia, 4);
+			prg.random_data(&ib, 4);
+			a[j] = Integer(32, ia, ALICE);
+			b[j] = Integer(32, ib, BOB);
+			sum += (int64_t)ia * ib;
+		}
+		int res = dot_product(a, b, len, frac_bits).reveal<int>(PUBLIC);
+		if (res != (int)(sum >> frac_bits))
+			cout << (int64_t)(sum >> frac_bits) <<"\t"<<res<<endl;
+		assert(res == (int)(sum >> frac_bits));
+	}
+	try {
+		dot_product((Integer *)nullptr, (Integer *)nullptr, 0, frac_bits);
+		error("dot_product of no pairs did not throw");
+	} catch(const std::invalid_argument &) {
+	}
+	cout << "dot_product ("<<frac_bits<<")\t\t\tDONE"<<endl;
+}
+
+void test_integer_vec(int width = 32, size_t n = 37) {
+	PRG prg;
+	vector<int64_t> ia(n), ib(n);
+	for(size_t j = 0; j < n; ++j) {
+		int32_t x, y;
+		prg.random_data(&x, 4);
+		prg.random_data(&y, 4);
+		ia[j] = x >> (32 - width);
+		ib[j] = (j % 5 == 0) ? ia[j] : y >> (32 - width);
+	}
+	IntegerVec a(width, n, ia.data(), ALICE), b(width, n, ib.data(), BOB);
+	vector<int> r(n), s(n), p(n), m(n), lt(n), eq(n), sel(n);
+	(a + b).reveal(r.data());
+	(a - b).reveal(s.data());
+	(a * b).reveal(p.data());
+	((a & b) | (a ^ b)).reveal(m.data());
+	(a < b).reveal(lt.data());
+	(a == b).reveal(eq.data());
+	a.select(a >= b, b).reveal(sel.data());
+	int64_t total = 0, count = 0;
+	for(size_t j = 0; j < n; ++j) {
+		int64_t mask = (1LL << width) - 1;
+		auto wrap = [&](int64_t v) {v &= mask; return v >= (1LL << (width-1)) ? v - mask - 1 : v;};
+		if (r[j] != wrap(ia[j] + ib[j]) or s[j] != wrap(ia[j] - ib[j]) or p[j] != wrap(ia[j] * ib[j])
+				or m[j] != wrap(ia[j] | ib[j]) or lt[j] != -(ia[j] < ib[j]) or eq[j] != -(ia[j] == ib[j])
+				or sel[j] != min(ia[j], ib[j]) or a[j].reveal<int64_t>() != (ia[j] & mask)) {
+			cout << ia[j] <<"\t"<<ib[j]<<"\t"<<r[j]<<"\t"<<s[j]<<"\t"<<p[j]<<"\t"<<m[j]<<"\t"<<lt[j]<<"\t"<<eq[j]<<"\t"<<sel[j]<<endl;
+			error("IntegerVec");
+		}
+		total += ia[j];
+		count += (ia[j] < ib[j]);
+	}
+	int64_t vsum = a.sum(64).reveal<int64_t>(), vcount = (a < b).sum(16, false).reveal<int64_t>();
+	if (vsum != total or vcount != count) {
+		cout << total <<"\t"<<vsum<<"\t"<<count<<"\t"<<vcount<<endl;
+		error("IntegerVec sum");
+	}
+	cout << "IntegerVec ("<<width<<" x "<<n<<")\t\t\tDONE"<<endl;
+}
+
 void scratch_pad() {
 	Integer a(32, 19, ALICE);
 	Integer b(32, 11, ALICE);
@@ -52,6 +157,14 @@ int main(int argc, char** argv) {
 	test_int<std::multiplies<int>, std::multiplies<Integer>>(party);
 	test_int<std::divides<int>, std::divides<Integer>>(party);
 	test_int<std::modulus<int>, std::modulus<Integer>>(party);
+	test_udiv(32, 32, 32);
+	test_udiv(48, 20, 32);
+	test_udiv(32, 11, 16);
+	test_udiv(32, 11, 21);
+	test_dot_product(0);
+	test_dot_product(16);
+	test_integer_vec();
+	test_integer_vec(9, 1);
 
 	test_int<std::bit_and<int>, std::bit_and<Integer>>(party);
 	test_int<std::bit_or<int>, std::bit_or<Integer>>(party);
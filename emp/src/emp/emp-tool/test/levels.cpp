@@ -0,0 +1,91 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+const int lanes = 1024;
+
+// A wide circuit: one multiplication and comparison per lane
+void capture(CapturedCircuit * c) {
+	CircuitCapture cap;
+	cap.start(c);
+	for(int i = 0; i < lanes; ++i) {
+		Integer x(32, 0, ALICE), y(32, 0, BOB);
+		Integer r = x * y;
+		r = r.select(x > y, x - y);
+		r.reveal<int32_t>(PUBLIC);
+	}
+	cap.finish();
+}
+
+void eval_plain(const CapturedCircuit & c, const bool * in, vector<uint8_t> & w) {
+	w.assign(c.num_wire, 0);
+	w[CapturedCircuit::PUBLIC_ONE] = 1;
+	size_t pos = 0;
+	for(auto & s : c.inputs)
+		for(uint32_t j = 0; j < s.length; ++j)
+			w[s.begin + j] = in[pos++];
+	for(size_t i = 0; i < c.num_gate(); ++i) {
+		const uint32_t * g = c.gates.data() + 4*i;
+		if(g[3] == AND_GATE) w[g[2]] = w[g[0]] & w[g[1]];
+		else if(g[3] == XOR_GATE) w[g[2]] = w[g[0]] ^ w[g[1]];
+		else w[g[2]] = !w[g[0]];
+	}
+}
+
+// Garbles and evaluates the circuit by level, with or without threads on either side
+double test(const CapturedCircuit & c, const LeveledCircuit & l, WorkStealingPool * gen_pool, WorkStealingPool * eva_pool) {
+	MemIO * io = new MemIO();
+	HalfGateGen<MemIO> * gen = new HalfGateGen<MemIO>(io);
+	HalfGateEva<MemIO> * eva = new HalfGateEva<MemIO>(io);
+	PRG prg;
+	size_t n_in = c.input_size();
+	vector<uint8_t> in(n_in), plain;
+	prg.random_bool((bool*)in.data(), n_in);
+	eval_plain(c, (bool*)in.data(), plain);
+
+	vector<block> wg(c.num_wire), we(c.num_wire);
+	wg[0] = gen->public_label(false);
+	wg[1] = gen->public_label(true);
+	we[0] = eva->public_label(false);
+	we[1] = eva->public_label(true);
+	size_t pos = 0;
+	for(auto & s : c.inputs) {
+		prg.random_block(wg.data() + s.begin, s.length);
+		for(uint32_t j = 0; j < s.length; ++j)
+			we[s.begin + j] = in[pos++] ? wg[s.begin + j] ^ gen->delta : wg[s.begin + j];
+	}
+
+	auto start = clock_start();
+	l.compute(gen, wg.data(), gen_pool);
+	double t = time_from(start);
+	l.compute(eva, we.data(), eva_pool);
+	for(auto o : c.outputs) {
+		block expected = plain[o] ? wg[o] ^ gen->delta : wg[o];
+		if(!cmpBlock(&expected, &we[o], 1))
+			error("wrong output label");
+	}
+	delete gen;
+	delete eva;
+	delete io;
+	return t;
+}
+
+int main(void) {
+	CapturedCircuit c;
+	capture(&c);
+	LeveledCircuit l(c);
+	cout << c.num_and << " AND gates in " << l.levels.size() << " levels, up to " << l.max_width() << " per level" << endl;
+
+	WorkStealingPool pool(3);
+	cout << "Correctness ... ";
+	test(c, l, nullptr, nullptr);
+	test(c, l, &pool, nullptr);
+	test(c, l, nullptr, &pool);
+	test(c, l, &pool, &pool);
+	cout << "check" << endl;
+
+	double t1 = test(c, l, nullptr, nullptr), t4 = test(c, l, &pool, nullptr);
+	cout << "Garbling: " << t1/1000 << " ms on 1 thread, " << t4/1000 << " ms on 4 threads" << endl;
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "emp-tool/emp-tool.h"
+#include "emp-tool/circuits/circuit_optimizer.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+void eval(BristolFormat & c, const bool * in, bool * out) {
+	vector<bool> w(c.num_wire);
+	for(int i = 0; i < c.n1 + c.n2; ++i)
+		w[i] = in[i];
+	for(int i = 0; i < c.num_gate; ++i) {
+		const int * g = c.gates.data() + 4*i;
+		if(g[3] == AND_GATE) w[g[2]] = w[g[0]] and w[g[1]];
+		else if(g[3] == XOR_GATE) w[g[2]] = w[g[0]] != w[g[1]];
+		else w[g[2]] = !w[g[0]];
+	}
+	for(int i = 0; i < c.n3; ++i)
+		out[i] = w[c.num_wire - c.n3 + i];
+}
+
+// Optimizes c, checks it on random inputs and through a text round trip
+size_t test(const string & name, BristolFormat & c) {
+	CircuitOptimizer opt;
+	BristolFormat o = opt.optimize(c);
+	o.to_bristol("optimized.txt");
+	BristolFormat r("optimized.txt");
+	remove("optimized.txt");
+	if(o.n1 != c.n1 or o.n2 != c.n2 or o.n3 != c.n3 or r.num_gate != o.num_gate or r.gates != o.gates)
+		error("wrong optimized circuit");
+	PRG prg;
+	vector<uint8_t> in(c.n1 + c.n2), out(c.n3), out2(c.n3);
+	for(int k = 0; k < 20; ++k) {
+		prg.random_bool((bool*)in.data(), in.size());
+		eval(c, (bool*)in.data(), (bool*)out.data());
+		eval(r, (bool*)in.data(), (bool*)out2.data());
+		if(out != out2)
+			error("optimized circuit differs");
+	}
+	auto before = CircuitOptimizer::count(c), after = CircuitOptimizer::count(o);
+	cout << name << ": AND gates " << before.num_and << " -> " << after.num_and << endl;
+	return before.num_and - after.num_and;
+}
+
+// Sums of products over shared rows, as in the cross-tabulation example
+void program(Integer * a, Integer * b, int n) {
+	Integer s1(32, 0, PUBLIC), s2(32, 0, PUBLIC);
+	for(int i = 0; i < n; ++i) {
+		s1 = s1 + (a[i] & b[i]);
+		s2 = s2 + (a[i] & b[i]) + (b[i] & a[i]);
+		Bit c = a[i].bits[0] ^ a[i].bits[0];
+		s2 = s2 + a[i].select(c, b[i]);
+	}
+	s1.reveal<int32_t>(PUBLIC);
+	s2.reveal<int32_t>(PUBLIC);
+}
+
+int main(void) {
+	const char * files[] = {"adder_32bit.txt", "AES-non-expanded.txt", "sha-1.txt", "sha-256.txt"};
+	for(auto f : files) {
+		BristolFormat c((string("./emp-tool/circuits/files/bristol_format/") + f).c_str());
+		test(f, c);
+	}
+
+	CapturedCircuit captured;
+	CircuitCapture capture;
+	capture.start(&captured);
+	Integer a[8], b[8];
+	for(int i = 0; i < 8; ++i) {
+		a[i] = Integer(32, 0, ALICE);
+		b[i] = Integer(32, 0, BOB);
+	}
+	program(a, b, 8);
+	capture.finish();
+	BristolFormat c = captured.to_bristol();
+	if(test("captured", c) == 0)
+		error("no AND gate removed");
+	return 0;
+}
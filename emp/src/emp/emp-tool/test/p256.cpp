@@ -0,0 +1,200 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+#ifdef EMP_HAS_P256
+BigInt to_bn(const P256Scalar &k) {
+	unsigned char buf[32];
+	for(int i = 0; i < 32; ++i)
+		buf[i] = (unsigned char)(k.v[3 - i/8] >> (56 - 8*(i%8)));
+	BigInt r;
+	r.from_bin(buf, 32);
+	return r;
+}
+
+// Checks the encoding of a P-256 point against an OpenSSL one
+void check(const P256Point &p, Point &expected, const char * what) {
+	P256Affine a;
+	p256_normalize(&a, &p, 1);
+	unsigned char buf[P256_POINT_SIZE], ref[P256_POINT_SIZE];
+	size_t len = p256_encode(buf, a), ref_len = expected.size();
+	expected.to_bin(ref, ref_len);
+	if(len != ref_len or memcmp(buf, ref, len) != 0)
+		error(what);
+}
+
+P256Affine from_openssl(Point &p) {
+	unsigned char buf[P256_POINT_SIZE];
+	p.to_bin(buf, P256_POINT_SIZE);
+	P256Affine a;
+	if(!p256_decode(a, buf, P256_POINT_SIZE))
+		error("decode");
+	return a;
+}
+
+void test_correctness(Group &G, PRG &prg) {
+	vector<P256Scalar> ks;
+	P256Scalar k = {{1, 0, 0, 0}};
+	for(uint64_t small : {1, 2, 15, 16, 17, 31, 32, 33, 1000}) {
+		k.v[0] = small;
+		ks.push_back(k);
+	}
+	// n - 1, and scalars with long runs of digits 16 and -16
+	ks.push_back(P256Scalar{{p256_n.v[0] - 1, p256_n.v[1], p256_n.v[2], p256_n.v[3]}});
+	ks.push_back(P256Scalar{{0x8421084210842108ULL, 0x1084210842108421ULL, 0x4210842108421084ULL, 0x0842108421084210ULL}});
+	ks.push_back(P256Scalar{{0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL, 0x7fffffffffffffffULL}});
+	for(int i = 0; i < 100; ++i) {
+		p256_rand_scalar(k, prg);
+		ks.push_back(k);
+	}
+
+	BigInt r;
+	G.get_rand_bn(r);
+	Point base = G.mul_gen(r);
+	P256Affine base_aff = from_openssl(base);
+	P256Table base_table(base_aff);
+	vector<P256Affine> bases(20);
+	vector<Point> bases_ssl;
+	for(size_t i = 0; i < bases.size(); ++i) {
+		G.get_rand_bn(r);
+		bases_ssl.push_back(G.mul_gen(r));
+		bases[i] = from_openssl(bases_ssl.back());
+	}
+	vector<P256Point> out(bases.size()), batch(ks.size());
+	base_table.mul(batch.data(), ks.data(), ks.size());
+	for(size_t i = 0; i < ks.size(); ++i) {
+		Point expected = base.mul(to_bn(ks[i]));
+		check(batch[i], expected, "fixed-base batch");
+	}
+	for(auto & k : ks) {
+		BigInt kb = to_bn(k);
+		P256Point p;
+		p256_generator().mul(p, k);
+		Point expected = G.mul_gen(kb);
+		check(p, expected, "generator table");
+		base_table.mul(p, k);
+		expected = base.mul(kb);
+		check(p, expected, "fixed-base table");
+		p256_mul(out.data(), bases.data(), bases.size(), k);
+		for(size_t i = 0; i < bases.size(); ++i) {
+			expected = bases_ssl[i].mul(kb);
+			check(out[i], expected, "variable-base multiplication");
+		}
+	}
+
+	// Additions, including doubling and P - P
+	P256Point a, s;
+	p256_lift(a, bases[0]);
+	p256_dbl(a, a);
+	p256_add(s, a, bases[1]);
+	Point expected = bases_ssl[0].add(bases_ssl[0]);
+	expected = expected.add(bases_ssl[1]);
+	check(s, expected, "add");
+	p256_lift(a, bases[0]);
+	p256_add(s, a, bases[0]);
+	expected = bases_ssl[0].add(bases_ssl[0]);
+	check(s, expected, "add doubling");
+	Point neg = bases_ssl[0].inv();
+	p256_add(s, a, from_openssl(neg));
+	expected = bases_ssl[0].add(neg);
+	check(s, expected, "add to infinity");
+
+	// Normalization keeps infinity in the middle of a batch
+	vector<P256Point> mixed = {out[0], s, out[1]};
+	vector<P256Affine> aff(3);
+	p256_normalize(aff.data(), mixed.data(), 3);
+	unsigned char buf[P256_POINT_SIZE];
+	if(p256_encode(buf, aff[1]) != 1 or buf[0] != 0)
+		error("normalize infinity");
+	for(int i : {0, 2}) {
+		P256Affine single;
+		p256_normalize(&single, &mixed[i], 1);
+		if(memcmp(&single, &aff[i], sizeof(single)) != 0)
+			error("batch normalize");
+	}
+
+	// Decoding rejects points off the curve and coordinates not below p
+	p256_encode(buf, bases[0]);
+	P256Affine dec;
+	if(!p256_decode(dec, buf, P256_POINT_SIZE))
+		error("decode valid");
+	buf[40] ^= 1;
+	if(p256_decode(dec, buf, P256_POINT_SIZE))
+		error("decode off-curve");
+	buf[40] ^= 1;
+	buf[0] = 2;
+	if(p256_decode(dec, buf, P256_POINT_SIZE))
+		error("decode prefix");
+	memset(buf + 1, 0xff, 32);
+	buf[0] = 4;
+	if(p256_decode(dec, buf, P256_POINT_SIZE))
+		error("decode x >= p");
+	cout << "P-256 matches OpenSSL" << endl;
+}
+
+void bench(Group &G, PRG &prg, int n) {
+	vector<P256Scalar> ks(n);
+	vector<BigInt> kb(n);
+	for(int i = 0; i < n; ++i) {
+		p256_rand_scalar(ks[i], prg);
+		kb[i] = to_bn(ks[i]);
+	}
+	Point base = G.mul_gen(kb[0]), p;
+	P256Affine base_aff = from_openssl(base);
+	vector<P256Point> out(n);
+	vector<P256Affine> bases(n, base_aff);
+	p256_generator();
+
+	auto start = clock_start();
+	for(int i = 0; i < n; ++i)
+		p = G.mul_gen(kb[i]);
+	double ssl_gen = time_from(start) / n;
+	start = clock_start();
+	for(int i = 0; i < n; ++i)
+		p = base.mul(kb[i]);
+	double ssl_mul = time_from(start) / n;
+
+	start = clock_start();
+	p256_generator().mul(out.data(), ks.data(), n);
+	double gen = time_from(start) / n;
+	start = clock_start();
+	P256Table table(base_aff);
+	double table_build = time_from(start);
+	start = clock_start();
+	table.mul(out.data(), ks.data(), n);
+	double fixed = time_from(start) / n;
+	start = clock_start();
+	p256_mul(out.data(), bases.data(), n, ks[0]);
+	double var = time_from(start) / n;
+	vector<P256Affine> aff(n);
+	start = clock_start();
+	p256_normalize(aff.data(), out.data(), n);
+	double norm = time_from(start) / n;
+
+	cout << "generator mul\t" << ssl_gen << " us (OpenSSL)\t" << gen << " us\t" << ssl_gen / gen << "x" << endl;
+	cout << "fixed-base mul\t" << ssl_mul << " us (OpenSSL)\t" << fixed << " us\t" << ssl_mul / fixed << "x, table " << table_build << " us" << endl;
+	cout << "variable mul\t" << ssl_mul << " us (OpenSSL)\t" << var << " us\t" << ssl_mul / var << "x" << endl;
+	cout << "normalize\t" << norm << " us per point in a batch of " << n << endl;
+}
+#endif
+
+int main() {
+#ifdef EMP_HAS_P256
+	Group G;
+	PRG prg;
+	test_correctness(G, prg);
+	bench(G, prg, 128);
+#ifdef __x86_64__
+	if(p256_use_ifma()) {
+		p256_use_ifma() = false;
+		cout << "without AVX-512 IFMA:" << endl;
+		test_correctness(G, prg);
+		bench(G, prg, 128);
+	}
+#endif
+#else
+	cout << "P-256 code needs unsigned __int128" << endl;
+#endif
+	return 0;
+}
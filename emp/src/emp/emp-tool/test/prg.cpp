@@ -11,6 +11,7 @@ using namespace emp;
 #include <cmath>
 
 void test_unaligned();
+void test_vaes();
 
 int main() {
 	PRG gen;
@@ -33,24 +34,49 @@ int main() {
 	prg.reseed(&rand_block[1]);//reset the PRG with another seed
 
     test_unaligned();
+	test_vaes();
 
-	prg.reseed(&zero_block);
-	for (long long length = 2; length <= 8192; length*=2) {
-		long long times = 1024*1024*32/length;
-		block * data = new block[length+1];
-		char * data2 = (char *)data;
-		auto start = clock_start();
-		for (int i = 0; i < times; ++i) {
-			prg.random_data(data2, length*16);
-			//prg.random_data_unaligned(data2+1, length*16);
+	// AES-NI first, then VAES if the CPU has it
+	bool vaes = aes_use_vaes();
+	for (int v = 0; v <= (vaes ? 1 : 0); ++v) {
+		aes_use_vaes() = v;
+		prg.reseed(&zero_block);
+		for (long long length = 2; length <= 8192; length*=2) {
+			long long times = 1024*1024*32/length;
+			block * data = new block[length+1];
+			char * data2 = (char *)data;
+			auto start = clock_start();
+			for (int i = 0; i < times; ++i) {
+				prg.random_data(data2, length*16);
+				//prg.random_data_unaligned(data2+1, length*16);
+			}
+			double interval = time_from(start);
+			delete[] data;
+			cout << "PRG speed (" << (v ? "VAES" : "AES-NI") << ") with block size "<<length<<" :\t"<<(length*times*128)/(interval+0.0)*1e6*1e-9<<" Gbps\n";
 		}
-		double interval = time_from(start);
-		delete[] data;
-		cout << "PRG speed with block size "<<length<<" :\t"<<(length*times*128)/(interval+0.0)*1e6*1e-9<<" Gbps\n";
 	}
 	return 0;
 }
 
+// The VAES counter mode gives the same stream as AES-NI, in any chunks
+void test_vaes() {
+	if (!aes_use_vaes())
+		return;
+	block seed = makeBlock(123, 456);
+	block expected[200], data[200];
+	aes_use_vaes() = false;
+	PRG ni(&seed);
+	ni.random_block(expected, 200);
+	aes_use_vaes() = true;
+	PRG prg(&seed);
+	for (int i = 0, n = 0; i < 200; i += n, ++n) {
+		n = std::min(n, 200 - i);
+		prg.random_block(data + i, n);
+	}
+	if (!cmpBlock(data, expected, 200))
+		error("VAES PRG mismatch");
+}
+
 void test_unaligned() {
     block seed = makeBlock(123, 456);
 
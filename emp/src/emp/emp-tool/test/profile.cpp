@@ -0,0 +1,86 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+// Plaintext evaluation without folding, so that every gate reaches the counter
+class BitsliceExec: public CircuitExecution { public:
+	block and_gate(const block& a, const block& b) override {
+		return a & b;
+	}
+	block xor_gate(const block& a, const block& b) override {
+		return a ^ b;
+	}
+	block not_gate(const block& a) override {
+		return a ^ all_one_block;
+	}
+	block public_label(bool b) override {
+		return b ? all_one_block : zero_block;
+	}
+};
+
+size_t find(const GateProfile & p, size_t parent, const string & name) {
+	for(auto c : p.regions[parent].children)
+		if(p.regions[c].name == name)
+			return c;
+	error("missing region");
+	return 0;
+}
+
+int main() {
+	CircuitExecution::circ_exec = new BitsliceExec();
+	MemIO io;
+	Integer a(32, 5, PUBLIC), b(32, 7, PUBLIC);
+
+	// Gates of one multiplication and one addition, counted without scopes
+	GateCounter * counter = new GateCounter(CircuitExecution::circ_exec);
+	CircuitExecution::circ_exec = counter;
+	Integer c = a * b;
+	uint64_t mul_and = counter->and_gates, mul_xor = counter->xor_gates;
+	c = c + a;
+	uint64_t add_and = counter->and_gates - mul_and;
+	CircuitExecution::circ_exec = counter->exec;
+	delete counter;
+
+	GateProfile profile;
+	GateScope ignored("not profiled");
+	profile.start(&io);
+	{
+		GateScope s("loop");
+		for(int i = 0; i < 10; ++i) {
+			GateScope m("mul");
+			c = c * b;
+			GateScope t("add");
+			c = c + a;
+		}
+	}
+	{
+		GateScope s("io");
+		block data[4] = {zero_block, zero_block, zero_block, zero_block};
+		io.send_block(data, 4);
+		io.recv_block(data, 4);
+		GateScope t("send");
+		io.send_block(data, 2);
+	}
+	profile.finish();
+	profile.print();
+	cout << profile.to_json() << endl;
+
+	auto & r = profile.regions;
+	size_t loop = find(profile, 0, "loop"), mul = find(profile, loop, "mul");
+	size_t add = find(profile, mul, "add"), io_region = find(profile, 0, "io");
+	if(r.size() != 6 or r[loop].calls != 1 or r[mul].calls != 10 or r[add].calls != 10)
+		error("wrong regions");
+	if(r[mul].and_gates != 10 * (mul_and + add_and) or r[mul].xor_gates < 10 * mul_xor
+			or r[add].and_gates != 10 * add_and or r[loop].and_gates != r[mul].and_gates
+			or r[0].and_gates != r[loop].and_gates)
+		error("wrong gate counts");
+	if(r[io_region].sent != 6 * sizeof(block) or r[io_region].received != 4 * sizeof(block)
+			or r[find(profile, io_region, "send")].sent != 2 * sizeof(block) or r[io_region].and_gates != 0)
+		error("wrong byte counts");
+	if(CircuitExecution::circ_exec == nullptr or dynamic_cast<GateCounter*>(CircuitExecution::circ_exec) != nullptr)
+		error("counter not removed");
+	delete CircuitExecution::circ_exec;
+	cout << "profile\t\t\tDONE" << endl;
+	return 0;
+}
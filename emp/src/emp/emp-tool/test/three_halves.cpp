@@ -0,0 +1,86 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+// Garbles n gates and evaluates them on random inputs, optionally batched on either side
+void test_three_halves(bool batch_gen, bool batch_eva, size_t n = 4099) {
+	MemIO * io = new MemIO();
+	ThreeHalvesGen<MemIO> * gen = new ThreeHalvesGen<MemIO>(io);
+	ThreeHalvesEva<MemIO> * eva = new ThreeHalvesEva<MemIO>(io);
+	PRG prg;
+	vector<block> a(n), b(n), out(n), la(n), lb(n), lout(n);
+	bool * ba = new bool[n], * bb = new bool[n];
+	prg.random_block(a.data(), n);
+	prg.random_block(b.data(), n);
+	prg.random_bool(ba, n);
+	prg.random_bool(bb, n);
+	for(size_t i = 0; i < n; ++i) {
+		la[i] = ba[i] ? a[i] ^ gen->delta : a[i];
+		lb[i] = bb[i] ? b[i] ^ gen->delta : b[i];
+	}
+	// start off a MITCCRH batch boundary
+	out[0] = gen->and_gate(a[0], b[0]);
+	if(batch_gen)
+		gen->and_gate_batch(a.data()+1, b.data()+1, out.data()+1, n-1);
+	else for(size_t i = 1; i < n; ++i)
+		out[i] = gen->and_gate(a[i], b[i]);
+
+	lout[0] = eva->and_gate(la[0], lb[0]);
+	if(batch_eva)
+		eva->and_gate_batch(la.data()+1, lb.data()+1, lout.data()+1, n-1);
+	else for(size_t i = 1; i < n; ++i)
+		lout[i] = eva->and_gate(la[i], lb[i]);
+
+	for(size_t i = 0; i < n; ++i) {
+		block expected = (ba[i] and bb[i]) ? out[i] ^ gen->delta : out[i];
+		if(cmpBlock(&expected, &lout[i], 1) == false) {cout << "wrong" << endl; abort();}
+	}
+	delete gen;
+	delete eva;
+	delete io;
+	delete[] ba;
+	delete[] bb;
+}
+
+template<typename Gen, typename Eva>
+void bench(const char * name, int n = 1024, int runs = 1024) {
+	MemIO * io = new MemIO();
+	Gen gen(io);
+	Eva eva(io);
+	PRG prg;
+	vector<block> a(n), b(n), c(n), d(n);
+	prg.random_block(a.data(), n);
+	prg.random_block(b.data(), n);
+	double gen_time = 0, eva_time = 0;
+	int64_t bytes = 0;
+	for(int i = 0; i < runs; ++i) {
+		io->clear();
+		io->read_pos = 0;
+		auto start = clock_start();
+		gen.and_gate_batch(a.data(), b.data(), c.data(), n);
+		gen_time += time_from(start);
+		bytes += io->size;
+		start = clock_start();
+		eva.and_gate_batch(a.data(), b.data(), d.data(), n);
+		eva_time += time_from(start);
+	}
+	cout << name << ": " << (double)bytes/runs/n << " bytes/gate, "
+		<< (double)runs*n/gen_time*1e6 << " garbled gates/second, "
+		<< (double)runs*n/eva_time*1e6 << " evaluated gates/second" << endl;
+	delete io;
+}
+
+int main(void) {
+	cout << "Correctness ... ";
+	test_three_halves(false, false);
+	test_three_halves(true, false);
+	test_three_halves(false, true);
+	test_three_halves(true, true);
+	cout << "check\n";
+
+	cout << "Efficiency:" << endl;
+	bench<HalfGateGen<MemIO>, HalfGateEva<MemIO>>("half-gates");
+	bench<ThreeHalvesGen<MemIO>, ThreeHalvesEva<MemIO>>("three-halves");
+	return 0;
+}
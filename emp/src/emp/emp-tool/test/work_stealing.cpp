@@ -0,0 +1,153 @@
+#include "emp-tool/emp-tool.h"
+#include <algorithm>
+#include <iostream>
+using namespace std;
+using namespace emp;
+
+// Spins for about i iterations of the body
+inline uint64_t spin(uint64_t i, uint64_t x) {
+	for(uint64_t j = 0; j < i; ++j)
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+	return x;
+}
+
+// Every index once, for grains that do and do not divide n, and uneven work
+void test_cover(WorkStealingPool & pool) {
+	for(int64_t n : {1, 7, 100, 1000, 4099}) {
+		for(int64_t grain : {0, 1, 3, 64, 5000}) {
+			vector<atomic<int>> hit(n);
+			for(auto & h : hit)
+				h.store(0);
+			pool.parallel_for(n, grain, [&](int64_t b, int64_t e) {
+				if(b >= e or b < 0 or e > n or (grain > 0 and b % grain != 0))
+					error("parallel_for range");
+				for(int64_t i = b; i < e; ++i) {
+					spin(i % 97 == 0 ? 20000 : 10, i);
+					hit[i].fetch_add(1);
+				}
+			});
+			for(auto & h : hit)
+				if(h.load() != 1)
+					error("parallel_for coverage");
+		}
+	}
+}
+
+// parallel_for from inside one, and from two threads at once
+void test_nested(WorkStealingPool & pool) {
+	atomic<int64_t> sum(0);
+	pool.parallel_for(64, 1, [&](int64_t b, int64_t e) {
+		for(int64_t i = b; i < e; ++i)
+			pool.parallel_for(100, 7, [&](int64_t b2, int64_t e2) {
+				sum.fetch_add(e2 - b2);
+			});
+	});
+	if(sum.load() != 6400)
+		error("nested parallel_for");
+
+	sum.store(0);
+	auto loop = [&]() {
+		for(int r = 0; r < 50; ++r)
+			pool.parallel_for(1000, 10, [&](int64_t b, int64_t e) {
+				sum.fetch_add(e - b);
+			});
+	};
+	thread other(loop);
+	loop();
+	other.join();
+	if(sum.load() != 100000)
+		error("concurrent parallel_for");
+}
+
+// Futures of enqueue, also from tasks on the workers
+void test_enqueue(WorkStealingPool & pool) {
+	vector<future<int>> res;
+	for(int i = 0; i < 100; ++i)
+		res.push_back(pool.enqueue([&pool](int i) {
+			return i + pool.enqueue([i]() { return i; }).get();
+		}, i));
+	for(int i = 0; i < 100; ++i)
+		if(res[i].get() != 2*i)
+			error("enqueue");
+}
+
+// An exception of f reaches the caller, from a worker or not, and the pool stays usable
+void test_exception(WorkStealingPool & pool) {
+	for(int64_t at : {0, 500, 999}) {
+		atomic<int64_t> done(0);
+		bool caught = false;
+		try {
+			pool.parallel_for(1000, 1, [&](int64_t b, int64_t e) {
+				if(b <= at and at < e)
+					throw runtime_error("parallel_for body");
+				spin(1000, b);
+				done.fetch_add(e - b);
+			});
+		} catch(const runtime_error &) {
+			caught = true;
+		}
+		if(!caught or done.load() >= 1000)
+			error("parallel_for exception");
+	}
+	test_cover(pool);
+}
+
+void print_latency(const char * name, vector<double> & t) {
+	sort(t.begin(), t.end());
+	cout << name << ": p50 " << t[t.size()/2] << " us, p99 " << t[t.size()*99/100] << " us, max " << t.back() << " us" << endl;
+}
+
+/* Latency of a loop on the pool against the same loop cut in one task per
+ * thread on ThreadPool, as LpnF2 did; work(i) is the cost of index i
+ */
+template<typename W>
+void bench(const char * name, int threads, int64_t n, int reps, W work) {
+	WorkStealingPool ws(threads - 1, true);
+	ThreadPool tp(threads - 1);
+	vector<double> t_ws, t_tp;
+	atomic<uint64_t> sink(0);
+	auto body = [&](int64_t b, int64_t e) {
+		uint64_t x = 0;
+		for(int64_t i = b; i < e; ++i)
+			x = spin(work(i), x);
+		sink.fetch_add(x);
+	};
+	for(int r = 0; r < reps; ++r) {
+		auto t1 = clock_start();
+		ws.parallel_for(n, 0, body);
+		t_ws.push_back(time_from(t1));
+
+		t1 = clock_start();
+		vector<future<void>> fut;
+		int64_t width = n / threads;
+		for(int i = 0; i < threads - 1; ++i)
+			fut.push_back(tp.enqueue(body, i * width, (i + 1) * width));
+		body((threads - 1) * width, n);
+		for(auto & f : fut)
+			f.get();
+		t_tp.push_back(time_from(t1));
+	}
+	cout << name << ", " << threads << " threads" << endl;
+	print_latency("  work stealing", t_ws);
+	print_latency("  ThreadPool   ", t_tp);
+}
+
+int main(void) {
+	int threads = max(4u, thread::hardware_concurrency());
+	WorkStealingPool pool(3, true);
+	cout << "Correctness ... ";
+	test_cover(pool);
+	test_nested(pool);
+	test_enqueue(pool);
+	test_exception(pool);
+	WorkStealingPool none(0);
+	test_cover(none);
+	test_exception(none);
+	cout << "check" << endl;
+
+	bench("Small loop", threads, 256, 2000, [](int64_t) { return 10; });
+	bench("Uniform loop", threads, 1 << 14, 200, [](int64_t) { return 50; });
+	// the first quarter costs 8 times as much
+	bench("Skewed loop", threads, 1 << 14, 200, [](int64_t i) { return i < (1 << 12) ? 400 : 50; });
+	return 0;
+}
@@ -0,0 +1,28 @@
+#include "emp-tool/emp-tool.h"
+#include <iostream>
+#include <cstring>
+using namespace std;
+using namespace emp;
+
+// Converts a text Bristol (Fashion with -f) circuit to the binary format of BinaryCircuit
+int main(int argc, char** argv) {
+	bool fashion = argc == 4 and strcmp(argv[1], "-f") == 0;
+	if(argc != 3 and !fashion) {
+		cout << "Usage: " << argv[0] << " [-f] <input circuit> <output file>" << endl;
+		cout << "  -f  the input is in Bristol Fashion" << endl;
+		return 0;
+	}
+	const char * in = argv[argc-2], * out = argv[argc-1];
+	auto start = clock_start();
+	if(fashion) {
+		BristolFashion c(in);
+		to_binary_circuit(c, out);
+		cout << c.num_gate << " gates";
+	} else {
+		BristolFormat c(in);
+		to_binary_circuit(c, out);
+		cout << c.num_gate << " gates";
+	}
+	cout << " converted in " << time_from(start)/1000 << " ms" << endl;
+	return 0;
+}
@@ -0,0 +1,30 @@
+#include "emp-tool/emp-tool.h"
+#include "emp-tool/circuits/circuit_optimizer.h"
+#include <iostream>
+#include <iomanip>
+using namespace std;
+using namespace emp;
+
+// Optimizes a Bristol circuit and reports the gate counts before and after
+int main(int argc, char** argv) {
+	if(argc != 3) {
+		cout << "Usage: " << argv[0] << " <input circuit> <output circuit>" << endl;
+		return 0;
+	}
+	BristolFormat in(argv[1]);
+	auto start = clock_start();
+	CircuitOptimizer opt;
+	BristolFormat out = opt.optimize(in);
+	double t = time_from(start);
+	out.to_bristol(argv[2]);
+
+	CircuitOptimizer::Stats before = CircuitOptimizer::count(in), after = CircuitOptimizer::count(out);
+	cout << fixed << setprecision(1);
+	cout << "AND gates: " << before.num_and << " -> " << after.num_and
+		<< " (" << (before.num_and ? 100.0 * after.num_and / before.num_and : 100.0) << "%)" << endl;
+	cout << "XOR gates: " << before.num_xor << " -> " << after.num_xor << endl;
+	cout << "NOT gates: " << before.num_not << " -> " << after.num_not << endl;
+	cout << "Wires: " << in.num_wire << " -> " << out.num_wire << endl;
+	cout << "Optimized in " << t/1000 << " ms" << endl;
+	return 0;
+}
@@ -45,28 +45,42 @@ void initialize_edges(T * bin_edges_x, T * bin_edges_y, int num_edges_x, int num
 
 /**
  * Although the naming is borrowed from np.digitize, the functionality is slightly different. This function
- * takes bin edges as input and "returns" an index adjusted for zero-indexing.
+ * takes bin edges as input and "returns" an index adjusted for zero-indexing, one lane per value.
  */
-void digitize(Integer val, Integer * bins, Integer * bin_edges, int num_edges, Integer & bin_to_index) {
+IntegerVec digitize(const Integer * vals, int n, Integer * bins, Integer * bin_edges, int num_edges) {
+	GateScope scope("digitize");
+	IntegerVec val(vals, n);
+	IntegerVec bin_to_index(BITSIZE, n, 0);
 	for (int i = num_edges - 1; i > 0; --i) {
-		bin_to_index = bin_to_index.select(val <= bin_edges[i], bins[i - 1]);	// i - 1 since num_bins = num_edges - 1
+		bin_to_index = bin_to_index.select(val <= IntegerVec(bin_edges[i], n), IntegerVec(bins[i - 1], n));	// i - 1 since num_bins = num_edges - 1
 	}
+	return bin_to_index;
 }
 
 /**
  * Although the naming is borrowed from np.digitize, the functionality is slightly different. This function
- * takes bin edges as input and "returns" an index adjusted for zero-indexing.
+ * takes bin edges as input and "returns" an index adjusted for zero-indexing, one lane per value.
  */
-void digitize(Float val, Integer * bins, Float * bin_edges, int num_edges, Integer & bin_to_index) {
-	for (int i = num_edges - 1; i > 0; --i) {
-		bin_to_index = bin_to_index.select(val.less_equal(bin_edges[i]), bins[i - 1]);	// i - 1 since num_bins = num_edges - 1
+IntegerVec digitize(const Float * vals, int n, Integer * bins, Float * bin_edges, int num_edges) {
+	GateScope scope("digitize");
+	IntegerVec bin_to_index(BITSIZE, n, 0);
+	for (int j = 0; j < n; ++j) {
+		Integer index(BITSIZE, 0, PUBLIC);
+		for (int i = num_edges - 1; i > 0; --i) {
+			index = index.select(vals[j].less_equal(bin_edges[i]), bins[i - 1]);	// i - 1 since num_bins = num_edges - 1
+		}
+		bin_to_index.set(j, index);
 	}
+	return bin_to_index;
 }
 
 void reveal_hist2d(Integer* hist2d, int num_bins_x, int num_bins_y) {
+	GateScope scope("reveal");
+	vector<int> counts(num_bins_x * num_bins_y);
+	reveal_batch(counts.data(), hist2d, counts.size());	// All the cells in one round trip
 	for (int y = 0; y < num_bins_y; ++y) {
 		for (int x = 0; x < num_bins_x; ++x) {
-			cout << "Hist2d (" << x << ", " << y << "): " << hist2d[y * num_bins_x + x].reveal<int>() << endl;
+			cout << "Hist2d (" << x << ", " << y << "): " << counts[y * num_bins_x + x] << endl;
 		}
 	}
 }
@@ -89,7 +103,10 @@ void test_hist2d(int party, int input_size, int num_edges_x, int num_edges_y) {
 	Integer bins_y[num_bins_y];
 	Integer hist2d[num_bins_y * num_bins_x];
 
-	utils::initialize_parties<T>(party, a, b, input_size);
+	{
+		GateScope scope("inputs");
+		utils::initialize_parties<T>(party, a, b, input_size);
+	}
 
 	for (int i = 0; i < num_bins_x; ++i) {
 		bins_x[i] = Integer(BITSIZE, i , PUBLIC);
@@ -99,33 +116,21 @@ void test_hist2d(int party, int input_size, int num_edges_x, int num_edges_y) {
 		bins_y[i] = Integer(BITSIZE, i , PUBLIC);
 	}
 
-	for (int y = 0; y < num_bins_y; ++y) {
-		for (int x = 0; x < num_bins_x; ++x) {
-			hist2d[y * num_bins_x + x] = Integer(BITSIZE, 0);
-		}
-	}
-	
 	initialize_edges<T>(bin_edges_x, bin_edges_y, num_edges_x, num_edges_y);
 
-	Integer zero(BITSIZE, 0);
-	for (int i = 0; i < input_size; ++i) {
-		Integer x_bin(BITSIZE, 0, PUBLIC);
-		Integer y_bin(BITSIZE, 0 , PUBLIC);
-
-		digitize(a[i], bins_x, bin_edges_x, num_edges_x, x_bin);
-		digitize(b[i], bins_y, bin_edges_y, num_edges_y, y_bin);
+	// All rows run the same circuit, so they are processed as lanes of an IntegerVec
+	IntegerVec x_bin = digitize(a, input_size, bins_x, bin_edges_x, num_edges_x);
+	IntegerVec y_bin = digitize(b, input_size, bins_y, bin_edges_y, num_edges_y);
 
-		// Update histogram
-		for (int y = 0; y < num_bins_y; ++y) {
-			Bit eq_y = y_bin.equal(bins_y[y]);
-
-			for (int x = 0; x < num_bins_x; ++x) {
-				int hist_index = y * num_bins_x + x;
-				Bit eq_bin = x_bin.equal(bins_x[x]) & eq_y;
-				// hist2d[hist_index] = hist2d[hist_index] + 1;
-				emp::add_full(hist2d[hist_index].bits.data(), nullptr, hist2d[hist_index].bits.data(), zero.bits.data(), &eq_bin, hist2d[hist_index].size());
+	// Update histogram
+	for (int y = 0; y < num_bins_y; ++y) {
+		GateScope scope("count");
+		IntegerVec eq_y = y_bin.equal(IntegerVec(bins_y[y], input_size));
 
-			}
+		for (int x = 0; x < num_bins_x; ++x) {
+			int hist_index = y * num_bins_x + x;
+			IntegerVec eq_bin = x_bin.equal(IntegerVec(bins_x[x], input_size)) & eq_y;
+			hist2d[hist_index] = eq_bin.sum(BITSIZE, false);	// Count of the rows that fall into this bin
 		}
 	}
 
@@ -165,8 +170,12 @@ int main(int argc, char **argv) {
 	utils::set_directory(argv[argc - 1]);
 
 	HighSpeedNetIO * io = new HighSpeedNetIO(ip, port, port + 1);
-	auto ctx = setup_semi_honest(io, party);
-	ctx->set_batch_size(1024*1024);
+	NetIO * ot_io = utils::get_ot_channel(ip, port + 2);
+	NetIO * pre_io = utils::get_precompute_channel(ip, port + 3);
+	SemiHonestParty<HighSpeedNetIO> * sh = setup_semi_honest(io, party, 1024*16, utils::get_garble_scheme(), utils::get_ot_scheme(), 1, &ot_io,
+		utils::get_ot_store(party, port));
+	utils::start_precompute(sh, pre_io);
+	utils::start_profile(io);
 
 	cout << "Party: " << (party == ALICE ? "Alice" : "Bob") << endl;
 	cout << "Input size: " << input_size << endl;
@@ -177,15 +186,21 @@ int main(int argc, char **argv) {
 
 	if (mode[0] == 'i') {
 		cout << "Running integer mode..." << endl;
+		utils::dump_circuit(test_hist2d<Integer>, party, input_size, num_edges_x, num_edges_y);
 		utils::time_it(test_hist2d<Integer>, party, input_size, num_edges_x, num_edges_y);
 	} else {
 		cout << "Running float mode..." << endl;
+		utils::dump_circuit(test_hist2d<Float>, party, input_size, num_edges_x, num_edges_y);
 		utils::time_it(test_hist2d<Float>, party, input_size, num_edges_x, num_edges_y);
 	}
 
+	utils::finish_profile(party);
+	utils::print_gate_stats();
 	finalize_semi_honest();
 
-	utils::print_io_stats(*io, party);
+	utils::print_io_stats(*io, party, {ot_io, pre_io});
+	delete pre_io;
+	delete ot_io;
 	delete io;
 	
     return 0;
@@ -19,22 +19,22 @@ void test_linreg(int party, int input_size) {
 	Float *b = new Float[input_size];
 
 	Float secure_input_size = Float(input_size, PUBLIC);
-	Float sum_x = Float();	// This value will be the least precise among the sums, even though it still leads to correct result
-	Float sum_y = Float();
-	Float sum_xy = Float();
-	Float sum_x2 = Float();
+	FloatAccumulator sum_x;		// Exact sums, rounded only once after the loop
+	FloatAccumulator sum_y;
 
 	utils::initialize_parties<Float>(party, a, b, input_size);
 
 	for (int i = 0; i < input_size; ++i) {
-		sum_x = sum_x + a[i];
-		sum_y = sum_y + b[i];
-		sum_xy = sum_xy + (a[i] * b[i]);
-		sum_x2 = sum_x2 + (a[i] * a[i]);
+		sum_x.add(a[i]);
+		sum_y.add(b[i]);
 	}
 	
-	Float beta_1 = (secure_input_size * sum_xy - sum_x * sum_y) / (secure_input_size * sum_x2 - sum_x * sum_x);
-	Float beta_0 = (sum_y - beta_1 * sum_x) / secure_input_size;
+	Float sum_xy = dot_product(a, b, input_size);		// Products are not rounded before being summed
+	Float sum_x2 = dot_product(a, a, input_size);
+	Float sum_x_value = sum_x.value();
+	Float sum_y_value = sum_y.value();
+	Float beta_1 = (secure_input_size * sum_xy - sum_x_value * sum_y_value) / (secure_input_size * sum_x2 - sum_x_value * sum_x_value);
+	Float beta_0 = (sum_y_value - beta_1 * sum_x_value) / secure_input_size;
 
     cout << "Intercept (beta_0): " << beta_0.reveal<double>() << endl;
 	cout << "Slope (beta_1): " << beta_1.reveal<double>() << endl;
@@ -60,18 +60,27 @@ int main(int argc, char **argv) {
 	utils::set_directory(argv[argc - 1]);
 	
 	HighSpeedNetIO * io = new HighSpeedNetIO(ip, port, port + 1);
-	auto ctx = setup_semi_honest(io, party);
-	ctx->set_batch_size(1024*1024);
+	NetIO * ot_io = utils::get_ot_channel(ip, port + 2);
+	NetIO * pre_io = utils::get_precompute_channel(ip, port + 3);
+	SemiHonestParty<HighSpeedNetIO> * sh = setup_semi_honest(io, party, 1024*16, utils::get_garble_scheme(), utils::get_ot_scheme(), 1, &ot_io,
+		utils::get_ot_store(party, port));
+	utils::start_precompute(sh, pre_io);
+	utils::start_profile(io);
 
 	cout << "Party: " << (party == ALICE ? "Alice" : "Bob") << endl;
 	cout << "Input size: " << input_size << endl;
 	cout << "Input directory: " << utils::get_directory() << endl;
 
+	utils::dump_circuit(test_linreg, party, input_size);
 	utils::time_it(test_linreg, party, input_size);
 
+	utils::finish_profile(party);
+	utils::print_gate_stats();
 	finalize_semi_honest();
 
-	utils::print_io_stats(*io, party);
+	utils::print_io_stats(*io, party, {ot_io, pre_io});
+	delete pre_io;
+	delete ot_io;
 	delete io;
 	
     return 0;
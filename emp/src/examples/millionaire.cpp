@@ -29,13 +29,20 @@ int main(int argc, char** argv) {
 	int num = atoi(argv[argc - 1]);		// number is the last argument
 
 	HighSpeedNetIO * io = new HighSpeedNetIO(ip, port, port + 1);
-	setup_semi_honest(io, party);
+	NetIO * ot_io = utils::get_ot_channel(ip, port + 2);
+	NetIO * pre_io = utils::get_precompute_channel(ip, port + 3);
+	SemiHonestParty<HighSpeedNetIO> * sh = setup_semi_honest(io, party, 1024*16, utils::get_garble_scheme(), utils::get_ot_scheme(), 1, &ot_io,
+		utils::get_ot_store(party, port));
+	utils::start_precompute(sh, pre_io);
 	test_millionaire(party, num);
 
+	utils::print_gate_stats();
 	finalize_semi_honest();
 
-	utils::print_io_stats(*io, party);
+	utils::print_io_stats(*io, party, {ot_io, pre_io});
 
+	delete pre_io;
+	delete ot_io;
 	delete io;
 	return 0;
 }
@@ -20,6 +20,7 @@ using namespace emp;
 using namespace std;
 
 void initialize_groupby_inputs(int party, Integer *group_by, int input_size, char* agg_cols) {
+	GateScope scope("inputs");
 	int agg_cols_len = strlen(agg_cols);	// Number of characters in the string (NOT THE ACTUAL NUMBER OF COLUMNS)
 	const int STEP = 2;	// Each column is represented by two characters (e.g. a0, b1, etc.)
 	char party_char;
@@ -35,27 +36,27 @@ void initialize_groupby_inputs(int party, Integer *group_by, int input_size, cha
 	}
 
 	for (int i = 0; i < agg_cols_len; i += STEP) {
+		Integer *column = group_by + i / STEP * input_size;
 		if (agg_cols[i] == party_char) {
 			ifstream infile = utils::get_input_file(agg_cols[i + 1]);
 			string line;
+			vector<int64_t> inputs(input_size);
 
 			for (int j = 0; j < input_size; ++j) {
-				int group_by_index = i / STEP * input_size + j;
 				getline(infile, line);
-				group_by[group_by_index] = Integer(BITSIZE, stoi(line), party);	// Only the respective party will have the input value
+				inputs[j] = stoi(line);
 			}
+			feed_batch(column, input_size, BITSIZE, inputs.data(), party);	// Only the respective party will have the input value
 		}
 
 		else  {
-			for (int j = 0; j < input_size; ++j) {
-				int group_by_index = i / STEP * input_size + j;
-				group_by[group_by_index] = Integer(BITSIZE, 0, other_party);
-			}	
+			feed_batch(column, input_size, BITSIZE, nullptr, other_party);
 		}
 	}
 }
 
 void initialize_values(int party, Integer *values, int input_size, char* value_col) {
+	GateScope scope("inputs");
 	char party_char;
 	int other_party;
 	
@@ -71,20 +72,21 @@ void initialize_values(int party, Integer *values, int input_size, char* value_c
 	if (value_col[0] == party_char) {
 		ifstream infile = utils::get_input_file(value_col[1]);
 		string line;
+		vector<int64_t> inputs(input_size);
 		
 		for (int j = 0; j < input_size; ++j) {
 			getline(infile, line);
-			values[j] = Integer(BITSIZE, stoi(line), party);
+			inputs[j] = stoi(line);
 		}
+		feed_batch(values, input_size, BITSIZE, inputs.data(), party);
 	}
 	else {
-		for (int j = 0; j < input_size; ++j) {
-			values[j] = Integer(BITSIZE, 0, other_party);
-		}	
+		feed_batch(values, input_size, BITSIZE, nullptr, other_party);
 	}
 }
 
 void initialize_values(int party, Float *values, int input_size, char* value_col) {
+	GateScope scope("inputs");
 	char party_char;
 	int other_party;
 	
@@ -100,16 +102,27 @@ void initialize_values(int party, Float *values, int input_size, char* value_col
 	if (value_col[0] == party_char) {
 		ifstream infile = utils::get_input_file(value_col[1]);
 		string line;
+		vector<float> inputs(input_size);
 		
 		for (int j = 0; j < input_size; ++j) {
 			getline(infile, line);
-			values[j] = Float(stof(line), party);
+			inputs[j] = stof(line);
 		}
+		feed_batch(values, input_size, inputs.data(), party);
 	}
 	else {
-		for (int j = 0; j < input_size; ++j) {
-			values[j] = Float(0, other_party);
-		}	
+		feed_batch(values, input_size, nullptr, other_party);
+	}
+}
+
+/**
+ * Compares the group_by column against every category at once: lane i of eq[j] is set if group_by[i] == categories[j].
+ */
+void equal_categories(IntegerVec *eq, Integer *group_by, int input_size, Integer *categories, int cat_len) {
+	GateScope scope("equal_categories");
+	IntegerVec group_by_vec(group_by, input_size);
+	for (int j = 0; j < cat_len; ++j) {
+		eq[j] = group_by_vec.equal(IntegerVec(categories[j], input_size));
 	}
 }
 
@@ -123,25 +136,24 @@ void test_sum1(int party, int input_size, char* agg_cols, char* value_col, int c
 	initialize_values(party, values, input_size, value_col);
 
 	for (int i = 0; i < cat_len; ++i) {
-		sums[i] = Integer(BITSIZE, 0, PUBLIC);
 		categories[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
-	Integer zero(BITSIZE, 0);	// Default party is PUBLIC
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < cat_len; ++j) {
-			// This compares the given category against the category of the current element
-			// The category of the element must be mapped to an integer to have less of a headache
-			// if a[i] == j then result = b[i] else result = 0
-			Bit eqcat = group_by[i].equal(categories[j]);
-			Integer result = zero.select(eqcat, values[i]);	
-		
-			sums[j] = sums[j] + result;
-		}	
+	// Every row runs the same circuit, so the rows are processed together as the lanes of an IntegerVec
+	// The category of the element must be mapped to an integer to have less of a headache
+	IntegerVec eqcat[cat_len];
+	equal_categories(eqcat, group_by, input_size, categories, cat_len);
+	IntegerVec values_vec(values, input_size);
+	IntegerVec zero(BITSIZE, input_size, 0);	// Public
+	for (int j = 0; j < cat_len; ++j) {
+		// if a[i] == j then result = b[i] else result = 0
+		sums[j] = zero.select(eqcat[j], values_vec).sum(BITSIZE);
 	}
 
+    int revealed[cat_len];
+    reveal_batch(revealed, sums, cat_len);
     for (int i = 0; i < cat_len; ++i) {
-        cout << "sum " << i << ": " << sums[i].reveal<int>() << endl;
+        cout << "sum " << i << ": " << revealed[i] << endl;
    }
 
    delete[] group_by;
@@ -162,12 +174,6 @@ void test_sum2(int party, int input_size, char* agg_cols, char* value_col, int f
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 	initialize_values(party, values, input_size, value_col);
 
-	for (int i = 0; i < first_cat_len; ++i) {
-		for (int j = 0; j < second_cat_len; ++j) {
-			sums[i][j] = Integer(BITSIZE, 0, PUBLIC);
-		}
-	}
-
 	for (int i = 0; i < first_cat_len; ++i) {
 		categories_1[i] = Integer(BITSIZE, i, PUBLIC);
 	}
@@ -176,24 +182,23 @@ void test_sum2(int party, int input_size, char* agg_cols, char* value_col, int f
 		categories_2[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
-	Integer zero(BITSIZE, 0);
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < first_cat_len; ++j) {
-			Bit eq_first_cat = group_by[i].equal(categories_1[j]);
-			
-			for (int k = 0; k < second_cat_len; ++k) {
-				Bit eq_second_cat = group_by[input_size + i].equal(categories_2[k]);
-				Bit match = eq_first_cat & eq_second_cat;
-				Integer result_val = zero.select(match, values[i]);
-
-				sums[j][k] = sums[j][k] + result_val;	// Only if both categories match do we add the value (otherwise adds 0)
-			}	
-		}	
+	IntegerVec eq_first_cat[first_cat_len], eq_second_cat[second_cat_len];
+	equal_categories(eq_first_cat, group_by, input_size, categories_1, first_cat_len);
+	equal_categories(eq_second_cat, group_by + input_size, input_size, categories_2, second_cat_len);
+	IntegerVec values_vec(values, input_size);
+	IntegerVec zero(BITSIZE, input_size, 0);
+	for (int j = 0; j < first_cat_len; ++j) {
+		for (int k = 0; k < second_cat_len; ++k) {
+			IntegerVec match = eq_first_cat[j] & eq_second_cat[k];
+			sums[j][k] = zero.select(match, values_vec).sum(BITSIZE);	// Only rows where both categories match add their value (otherwise add 0)
+		}
 	}
 
+	int revealed[first_cat_len][second_cat_len];
+	reveal_batch(&revealed[0][0], &sums[0][0], first_cat_len * second_cat_len);
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			cout << "Sum (" << i << ", " << j << "): " << sums[i][j].reveal<int>() << endl;
+			cout << "Sum (" << i << ", " << j << "): " << revealed[i][j] << endl;
 		}
 	}
 
@@ -202,6 +207,14 @@ void test_sum2(int party, int input_size, char* agg_cols, char* value_col, int f
 }
 
 
+// Counts never exceed input_size, so they only need enough bits for it plus a zero sign bit
+int count_bitsize(int input_size) {
+	int bits = 1;
+	while ((input_size >> bits) > 0)
+		++bits;
+	return bits + 1;
+}
+
 /**
  * For the average function, we need to use emp::Float types instead of emp::Integer types for the final results if we want precision in the 
  * averages (otherwise we can use just integer division ig).
@@ -210,34 +223,37 @@ void test_average1(int party, int input_size, char* agg_cols, char* value_col, i
 	Integer *group_by = new Integer[input_size];		//  May contain inputs of both parties
 	Float *values = new Float[input_size];
 	
-	Float sums[cat_len];
-	Float counts [cat_len];
+	FloatAccumulator sums[cat_len];
+	FloatAccumulator counts [cat_len];
 	Integer categories[cat_len];
 
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 	initialize_values(party, values, input_size, value_col);
 
 	for (int i = 0; i < cat_len; ++i) {
-		sums[i] = Float();
-		counts[i] = Float();
+		counts[i] = FloatAccumulator(0, 0, count_bitsize(input_size));
 		categories[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
 	Float zero = Float();
-	Float one = Float(1, PUBLIC);
 	for (int i = 0; i < input_size; ++i) {
 		for (int j = 0; j < cat_len; ++j) {
 			Bit eqcat = group_by[i].equal(categories[j]);
 			Float result_sum = zero.If(eqcat, values[i]);
-			Float result_count = zero.If(eqcat, one);	// I do not know how to optimize the sum of a bit to a float like in the fast variant
 		
-			sums[j] = sums[j] + result_sum;
-			counts[j] = counts[j] + result_count;
+			sums[j].add(result_sum);
+			counts[j].add(eqcat);
 		}	
 	}
 
+	Float averages[cat_len];
+	double revealed[cat_len];
+	for (int i = 0; i < cat_len; ++i) {
+		averages[i] = sums[i].value() / counts[i].value();
+	}
+	reveal_batch(revealed, averages, cat_len);
     for (int i = 0; i < cat_len; ++i) {
-		float average = (sums[i] / counts[i]).reveal<double>();
+		float average = revealed[i];
         cout << "Average (" << i << "): " << average << endl;
 	}
 
@@ -251,8 +267,8 @@ void test_average2(int party, int input_size, char* agg_cols, char* value_col, i
 	Integer *group_by = new Integer[input_size * 2];		//  May contain inputs of both parties
 	Float *values = new Float[input_size];
 	
-	Float sums[first_cat_len][second_cat_len];
-	Float counts[first_cat_len][second_cat_len];
+	FloatAccumulator sums[first_cat_len][second_cat_len];
+	FloatAccumulator counts[first_cat_len][second_cat_len];
 	Integer categories_1[first_cat_len];
 	Integer categories_2[second_cat_len];
 
@@ -261,8 +277,7 @@ void test_average2(int party, int input_size, char* agg_cols, char* value_col, i
 
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			sums[i][j] = Float();
-			counts[i][j] = Float();
+			counts[i][j] = FloatAccumulator(0, 0, count_bitsize(input_size));
 		}
 	}
 
@@ -275,7 +290,6 @@ void test_average2(int party, int input_size, char* agg_cols, char* value_col, i
 	}
 
 	Float zero = Float();
-	Float one = Float(1, PUBLIC);
 	for (int i = 0; i < input_size; ++i) {
 		for (int j = 0; j < first_cat_len; ++j) {
 			Bit eq_first_cat = group_by[i].equal(categories_1[j]);
@@ -285,17 +299,24 @@ void test_average2(int party, int input_size, char* agg_cols, char* value_col, i
 				Bit match = eq_first_cat & eq_second_cat;
 				
 				Float result_sum = zero.If(match, values[i]);
-				Float result_count = zero.If(match, one);	// I do not know how to optimize the sum of a bit to a float like in the fast variant
 
-				sums[j][k] = sums[j][k] + result_sum;
-				counts[j][k] = counts[j][k] + result_count;	
+				sums[j][k].add(result_sum);
+				counts[j][k].add(match);
 			}	
 		}	
 	}
 	
+	Float averages[first_cat_len][second_cat_len];
+	double revealed[first_cat_len][second_cat_len];
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			cout << "Average (" << i << ", " << j << "): " << (sums[i][j] / counts[i][j]).reveal<double>() << endl;
+			averages[i][j] = sums[i][j].value() / counts[i][j].value();
+		}
+	}
+	reveal_batch(&revealed[0][0], &averages[0][0], first_cat_len * second_cat_len);
+	for (int i = 0; i < first_cat_len; ++i) {
+		for (int j = 0; j < second_cat_len; ++j) {
+			cout << "Average (" << i << ", " << j << "): " << revealed[i][j] << endl;
 		}
 	}
 
@@ -304,6 +325,15 @@ void test_average2(int party, int input_size, char* agg_cols, char* value_col, i
 }
 
 
+// Signed average without the double abs/condNeg of Integer::operator/, since counts are non-negative. Dividing by the narrow count
+// makes every quotient bit cost count_bitsize ANDs instead of BITSIZE
+Integer average(const Integer &sum, const Integer &count) {
+	Bit negative = sum[sum.size() - 1];
+	Integer quotient = sum.abs().udiv(count);
+	emp::condNeg(negative, quotient.bits.data(), quotient.bits.data(), quotient.size());
+	return quotient;
+}
+
 void test_average1_fast(int party, int input_size, char* agg_cols, char* value_col, int cat_len, bool float_precision=false) {
 	Integer *group_by = new Integer[input_size];		//  May contain inputs of both parties
 	Integer *values = new Integer[input_size];
@@ -316,30 +346,39 @@ void test_average1_fast(int party, int input_size, char* agg_cols, char* value_c
 	initialize_values(party, values, input_size, value_col);
 
 	for (int i = 0; i < cat_len; ++i) {
-		sums[i] = Integer(BITSIZE, 0, PUBLIC);
-		counts[i] = Integer(BITSIZE, 0, PUBLIC);
 		categories[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
-	Integer zero(BITSIZE, 0);
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < cat_len; ++j) {
-			Bit eq_cat = group_by[i].equal(categories[j]);
-			Integer result_sum = zero.select(eq_cat, values[i]);
-
-			sums[j] = sums[j] + result_sum;
-			emp::add_full(counts[j].bits.data(), nullptr, counts[j].bits.data(), zero.bits.data(), &eq_cat, counts[j].size());	// counts[j] = counts[j] + eq_cat
-		}	
+	IntegerVec eq_cat[cat_len];
+	equal_categories(eq_cat, group_by, input_size, categories, cat_len);
+	IntegerVec values_vec(values, input_size);
+	IntegerVec zero(BITSIZE, input_size, 0);
+	for (int j = 0; j < cat_len; ++j) {
+		sums[j] = zero.select(eq_cat[j], values_vec).sum(BITSIZE);
+		counts[j] = eq_cat[j].sum(count_bitsize(input_size), false);	// Number of rows in category j
 	}
 
 	if (float_precision) {
+		int revealed[2 * cat_len];	// The sums, then the counts
+		Integer outputs[2 * cat_len];
 		for (int i = 0; i < cat_len; ++i) {
-			cout << "Average float (" << i << "): " <<  ((float) sums[i].reveal<int>() / counts[i].reveal<int>()) << endl;
+			outputs[i] = sums[i];
+			outputs[cat_len + i] = counts[i];
+		}
+		reveal_batch(revealed, outputs, 2 * cat_len);
+		for (int i = 0; i < cat_len; ++i) {
+			cout << "Average float (" << i << "): " <<  ((float) revealed[i] / revealed[cat_len + i]) << endl;
 		}
 	}
 	else {
+		Integer averages[cat_len];
+		int revealed[cat_len];
+		for (int i = 0; i < cat_len; ++i) {
+			averages[i] = average(sums[i], counts[i]);
+		}
+		reveal_batch(revealed, averages, cat_len);
 		for (int i = 0; i < cat_len; ++i) {
-			cout << "Average int (" << i << "): " << (sums[i] / counts[i]).reveal<int>() << endl;
+			cout << "Average int (" << i << "): " << revealed[i] << endl;
 		}
 	}
 
@@ -360,13 +399,6 @@ void test_average2_fast(int party, int input_size, char* agg_cols, char* value_c
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 	initialize_values(party, values, input_size, value_col);
 
-	for (int i = 0; i < first_cat_len; ++i) {
-		for (int j = 0; j < second_cat_len; ++j) {
-			sums[i][j] = Integer(BITSIZE, 0, PUBLIC);
-			counts[i][j] = Integer(BITSIZE, 0, PUBLIC);
-		}
-	}
-
 	for (int i = 0; i < first_cat_len; ++i) {
 		categories_1[i] = Integer(BITSIZE, i, PUBLIC);
 	}
@@ -375,35 +407,48 @@ void test_average2_fast(int party, int input_size, char* agg_cols, char* value_c
 		categories_2[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
-	Integer zero(BITSIZE, 0);	// Default party is PUBLIC
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < first_cat_len; ++j) {
-			Bit eq_first_cat = group_by[i].equal(categories_1[j]);
-			
-			for (int k = 0; k < second_cat_len; ++k) {
-				Bit eq_second_cat = group_by[input_size + i].equal(categories_2[k]);
-				Bit match = eq_first_cat & eq_second_cat;
-				Integer result_sum = zero.select(match, values[i]);
-
-				sums[j][k] = sums[j][k] + result_sum;
-				emp::add_full(counts[j][k].bits.data(), nullptr, counts[j][k].bits.data(), zero.bits.data(), &match, counts[j][k].size());	// counts[j][k] = counts[j][k] + match
-
-			}	
-		}	
+	IntegerVec eq_first_cat[first_cat_len], eq_second_cat[second_cat_len];
+	equal_categories(eq_first_cat, group_by, input_size, categories_1, first_cat_len);
+	equal_categories(eq_second_cat, group_by + input_size, input_size, categories_2, second_cat_len);
+	IntegerVec values_vec(values, input_size);
+	IntegerVec zero(BITSIZE, input_size, 0);	// Public
+	for (int j = 0; j < first_cat_len; ++j) {
+		for (int k = 0; k < second_cat_len; ++k) {
+			IntegerVec match = eq_first_cat[j] & eq_second_cat[k];
+			sums[j][k] = zero.select(match, values_vec).sum(BITSIZE);
+			counts[j][k] = match.sum(count_bitsize(input_size), false);	// Number of rows matching both categories
+		}
 	}
 	
 
+	int num_cells = first_cat_len * second_cat_len;
 	if (float_precision) {
+		int revealed[2 * num_cells];	// The sums, then the counts
+		Integer outputs[2 * num_cells];
+		for (int c = 0; c < num_cells; ++c) {
+			outputs[c] = sums[c / second_cat_len][c % second_cat_len];
+			outputs[num_cells + c] = counts[c / second_cat_len][c % second_cat_len];
+		}
+		reveal_batch(revealed, outputs, 2 * num_cells);
 		for (int i = 0; i < first_cat_len; ++i) {
 			for (int j = 0; j < second_cat_len; ++j) {
-				cout << "Average float (" << i << "): " <<  ((float) sums[i][j].reveal<int>() / counts[i][j].reveal<int>()) << endl;
+				int c = i * second_cat_len + j;
+				cout << "Average float (" << i << "): " <<  ((float) revealed[c] / revealed[num_cells + c]) << endl;
 			}
 		}
 	}
 	else {
+		Integer averages[first_cat_len][second_cat_len];
+		int revealed[first_cat_len][second_cat_len];
 		for (int i = 0; i < first_cat_len; ++i) {
 			for (int j = 0; j < second_cat_len; ++j) {
-				cout << "Average int (" << i << "): " << (sums[i][j] / counts[i][j]).reveal<int>() << endl;
+				averages[i][j] = average(sums[i][j], counts[i][j]);
+			}
+		}
+		reveal_batch(&revealed[0][0], &averages[0][0], num_cells);
+		for (int i = 0; i < first_cat_len; ++i) {
+			for (int j = 0; j < second_cat_len; ++j) {
+				cout << "Average int (" << i << "): " << revealed[i][j] << endl;
 			}
 		}
 	}
@@ -424,11 +469,6 @@ void test_mode(int party, int input_size, char* agg_cols, int first_cat_len, int
 
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 
-	for(int i = 0; i < first_cat_len; ++i) {
-		for (int j = 0; j < second_cat_len; ++j)
-			frequencies[i][j] = Integer(BITSIZE, 0);
-	}
-
 	for(int i = 0; i < first_cat_len; ++i) 
 		categories_1[i] = Integer(BITSIZE, i, PUBLIC);
 
@@ -436,18 +476,14 @@ void test_mode(int party, int input_size, char* agg_cols, int first_cat_len, int
 	for (int i = 0; i < second_cat_len; ++i)
 		categories_2[i] = Integer(BITSIZE, i, PUBLIC);
 
-	Integer zero(BITSIZE, 0);	// Default party is PUBLIC
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < first_cat_len; ++j) {
-			Bit eq_first_cat = group_by[i].equal(categories_1[j]);
-			
-			for (int k = 0; k < second_cat_len; ++k) {
-				Bit eq_second_cat = group_by[input_size + i].equal(categories_2[k]);
-				Bit match = eq_first_cat & eq_second_cat;
-
-				emp::add_full(frequencies[j][k].bits.data(), nullptr, frequencies[j][k].bits.data(), zero.bits.data(), &match, frequencies[j][k].size());	// counts[j][k] = counts[j][k] + match
-			}	
-		}	
+	IntegerVec eq_first_cat[first_cat_len], eq_second_cat[second_cat_len];
+	equal_categories(eq_first_cat, group_by, input_size, categories_1, first_cat_len);
+	equal_categories(eq_second_cat, group_by + input_size, input_size, categories_2, second_cat_len);
+	for (int j = 0; j < first_cat_len; ++j) {
+		for (int k = 0; k < second_cat_len; ++k) {
+			IntegerVec match = eq_first_cat[j] & eq_second_cat[k];
+			frequencies[j][k] = match.sum(BITSIZE, false);	// Number of rows matching both categories
+		}
 	}
 
 	// With the frequencies calculated, find the mode for each group
@@ -469,12 +505,14 @@ void test_mode(int party, int input_size, char* agg_cols, int first_cat_len, int
 	}
 
 	// Frequencies are not revealed, only the mode
+	int revealed[first_cat_len];
+	reveal_batch(revealed, modes, first_cat_len);
 	for (int i = 0; i < first_cat_len; ++i) {
 		cout << "Group " << i << endl;
 		//for (int j = 0; j < second_cat_len; ++j) {
 		//	cout <<  "Frequency of the value " << j << ": " << frequencies[i][j].reveal<int>() << endl;
 		//}
-		cout << "Mode: " << modes[i].reveal<int>() << endl;
+		cout << "Mode: " << revealed[i] << endl;
 	}
 
 	delete[] group_by;
@@ -490,11 +528,6 @@ void test_freq(int party, int input_size, char* agg_cols, int first_cat_len, int
 
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 
-	for(int i = 0; i < first_cat_len; ++i) {
-		for (int j = 0; j < second_cat_len; ++j)
-			frequencies[i][j] = Integer(BITSIZE, 0);
-	}
-
 	for(int i = 0; i < first_cat_len; ++i) 
 		categories_1[i] = Integer(BITSIZE, i, PUBLIC);
 
@@ -503,24 +536,22 @@ void test_freq(int party, int input_size, char* agg_cols, int first_cat_len, int
 		categories_2[i] = Integer(BITSIZE, i, PUBLIC);
 
 	// Calculate frequencies of each item by group
-	Integer zero(BITSIZE, 0);	// Default party is PUBLIC
-	for (int i = 0; i < input_size; ++i) {
-		for (int j = 0; j < first_cat_len; ++j) {
-			Bit eq_first_cat = group_by[i].equal(categories_1[j]);
-			
-			for (int k = 0; k < second_cat_len; ++k) {
-				Bit eq_second_cat = group_by[input_size + i].equal(categories_2[k]);
-				Bit match = eq_first_cat & eq_second_cat;
-
-				emp::add_full(frequencies[j][k].bits.data(), nullptr, frequencies[j][k].bits.data(), zero.bits.data(), &match, frequencies[j][k].size());	// counts[j][k] = counts[j][k] + match
-			}	
-		}	
+	IntegerVec eq_first_cat[first_cat_len], eq_second_cat[second_cat_len];
+	equal_categories(eq_first_cat, group_by, input_size, categories_1, first_cat_len);
+	equal_categories(eq_second_cat, group_by + input_size, input_size, categories_2, second_cat_len);
+	for (int j = 0; j < first_cat_len; ++j) {
+		for (int k = 0; k < second_cat_len; ++k) {
+			IntegerVec match = eq_first_cat[j] & eq_second_cat[k];
+			frequencies[j][k] = match.sum(BITSIZE, false);	// Number of rows matching both categories
+		}
 	}
 
+	int revealed[first_cat_len][second_cat_len];
+	reveal_batch(&revealed[0][0], &frequencies[0][0], first_cat_len * second_cat_len);
 	for (int i = 0; i < first_cat_len; ++i) {
 		cout << "Group " << i << endl;
 		for (int j = 0; j < second_cat_len; ++j) {
-			cout <<  "Frequency of the value " << j << ": " << frequencies[i][j].reveal<int>() << endl;
+			cout <<  "Frequency of the value " << j << ": " << revealed[i][j] << endl;
 		}
 	}
 
@@ -531,20 +562,18 @@ void test_std1(int party, int input_size, char* agg_cols, char* value_col, int c
 	Integer *group_by = new Integer[input_size];		//  May contain inputs of both parties
 	Float *values = new Float[input_size];
 	
-	Float sums[cat_len];
-	Float counts [cat_len];
+	FloatAccumulator sums[cat_len];
+	FloatAccumulator counts [cat_len];
 	Float averages[cat_len];
-	Float variances[cat_len];
+	FloatAccumulator variances[cat_len];
 	Integer categories[cat_len];
 
 	initialize_groupby_inputs(party, group_by, input_size, agg_cols);
 	initialize_values(party, values, input_size, value_col);
 
 	for (int i = 0; i < cat_len; ++i) {
-		sums[i] = Float();
-		counts[i] = Float();
+		counts[i] = FloatAccumulator(0, 0, count_bitsize(input_size));
 		averages[i] = Float();
-		variances[i] = Float();
 		categories[i] = Integer(BITSIZE, i, PUBLIC);
 	}
 
@@ -554,15 +583,14 @@ void test_std1(int party, int input_size, char* agg_cols, char* value_col, int c
 		for (int j = 0; j < cat_len; ++j) {
 			Bit eqcat = group_by[i].equal(categories[j]);
 			Float result_sum = zero.If(eqcat, values[i]);
-			Float result_count = zero.If(eqcat, one);
 		
-			sums[j] = sums[j] + result_sum;
-			counts[j] = counts[j] + result_count;
+			sums[j].add(result_sum);
+			counts[j].add(eqcat);
 		}	
 	}
 	// Calculate averages
 	for (int i = 0; i < cat_len; ++i) {
-		averages[i] = (sums[i] / counts[i]);
+		averages[i] = (sums[i].value() / counts[i].value());
 	}
 
 	// Calculate variances
@@ -571,17 +599,19 @@ void test_std1(int party, int input_size, char* agg_cols, char* value_col, int c
 			Bit eqcat = group_by[i].equal(categories[j]);
 			Float result = zero.If(eqcat, values[i] - averages[j]);
 
-			variances[j] = variances[j] + result.sqr();
+			variances[j].add(result.sqr());
 		}	
 	}
 
 	Float ddof_secure = ddof == 0 ? zero : one;
+	Float variance[cat_len];
+	double revealed[cat_len];
 	for (int i = 0; i < cat_len; ++i) {
-		variances[i] = variances[i] / (counts[i] - ddof_secure);
+		variance[i] = variances[i].value() / (counts[i].value() - ddof_secure);
 	}
-
+	reveal_batch(revealed, variance, cat_len);
     for (int i = 0; i < cat_len; ++i) {
-		float std = sqrt(variances[i].reveal<double>());
+		float std = sqrt(revealed[i]);
         cout << "Standard Deviation (" << i << "): " << std << endl;
 	}
 
@@ -594,10 +624,10 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 	Integer *group_by = new Integer[input_size * 2];		//  May contain inputs of both parties
 	Float *values = new Float[input_size];
 	
-	Float sums[first_cat_len][second_cat_len];
-	Float counts[first_cat_len][second_cat_len];
+	FloatAccumulator sums[first_cat_len][second_cat_len];
+	FloatAccumulator counts[first_cat_len][second_cat_len];
 	Float averages[first_cat_len][second_cat_len];
-	Float variances[first_cat_len][second_cat_len];
+	FloatAccumulator variances[first_cat_len][second_cat_len];
 	Integer categories_1[first_cat_len];
 	Integer categories_2[second_cat_len];
 
@@ -606,10 +636,8 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			sums[i][j] = Float();
-			counts[i][j] = Float();
+			counts[i][j] = FloatAccumulator(0, 0, count_bitsize(input_size));
 			averages[i][j] = Float();
-			variances[i][j] = Float();
 		}
 	}
 
@@ -632,10 +660,9 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 				Bit match = eq_first_cat & eq_second_cat;
 				
 				Float result_sum = zero.If(match, values[i]);
-				Float result_count = zero.If(match, one);
 
-				sums[j][k] = sums[j][k] + result_sum;
-				counts[j][k] = counts[j][k] + result_count;	
+				sums[j][k].add(result_sum);
+				counts[j][k].add(match);
 			}	
 		}	
 	}
@@ -643,7 +670,7 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 	// Calculate averages
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			averages[i][j] = (sums[i][j] / counts[i][j]);
+			averages[i][j] = (sums[i][j].value() / counts[i][j].value());
 		}
 	}
 
@@ -657,21 +684,23 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 
 				Float result = zero.If(match, values[i] - averages[j][k]);
 
-				variances[j][k] = variances[j][k] + result.sqr();
+				variances[j][k].add(result.sqr());
 			}	
 		}	
 	}
 
 	Float ddof_secure = ddof == 0 ? zero : one;
+	Float variance[first_cat_len][second_cat_len];
+	double revealed[first_cat_len][second_cat_len];
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			variances[i][j] = variances[i][j] / (counts[i][j] - ddof_secure);
+			variance[i][j] = variances[i][j].value() / (counts[i][j].value() - ddof_secure);
 		}
 	}
-	
+	reveal_batch(&revealed[0][0], &variance[0][0], first_cat_len * second_cat_len);
 	for (int i = 0; i < first_cat_len; ++i) {
 		for (int j = 0; j < second_cat_len; ++j) {
-			float std = sqrt(variances[i][j].reveal<double>());
+			float std = sqrt(revealed[i][j]);
         	cout << "Standard Deviation (" << i << ", " << j << "): " << std << endl;
 		}
 	}
@@ -682,16 +711,23 @@ void test_std2(int party, int input_size, char* agg_cols, char* value_col, int f
 
 
 
+// Dumps the circuit of func if EMP_DUMP_CIRCUIT is set, then runs and times it
+template <typename Func, typename... Args>
+void dump_and_time(Func&& func, Args&&... args) {
+	utils::dump_circuit(func, args...);
+	utils::time_it(func, args...);
+}
+
 void xtabs_1(int party, int input_size, char aggregation, int n_categories, char* agg_cols, char* value_col) {
 	switch (aggregation) {
 		case 's':
-			utils::time_it(test_sum1, party, input_size, agg_cols, value_col, n_categories);
+			dump_and_time(test_sum1, party, input_size, agg_cols, value_col, n_categories);
 			break;
 		case 'a':
-			utils::time_it(test_average1, party, input_size, agg_cols, value_col, n_categories);
+			dump_and_time(test_average1, party, input_size, agg_cols, value_col, n_categories);
 			break;
 		case 'v':
-			utils::time_it(test_average1_fast, party, input_size, agg_cols, value_col, n_categories, false);
+			dump_and_time(test_average1_fast, party, input_size, agg_cols, value_col, n_categories, false);
 			break;
 		case 'm':
 			cout << "Mode is not available when grouping by one column only" << endl;
@@ -700,7 +736,7 @@ void xtabs_1(int party, int input_size, char aggregation, int n_categories, char
 			cout << "Frequency counts are not available when grouping by one column only" << endl;
 			break;
 		case 'd':
-			utils::time_it(test_std1, party, input_size, agg_cols, value_col, n_categories, 0);
+			dump_and_time(test_std1, party, input_size, agg_cols, value_col, n_categories, 0);
 			break;
 		default:
 			cout << "Invalid aggregation type" << endl;
@@ -712,22 +748,22 @@ void xtabs_1(int party, int input_size, char aggregation, int n_categories, char
 void xtabs_2(int party, int input_size, char aggregation, int n_categories_1, int n_categories_2, char* agg_cols, char* value_col) {
 	switch (aggregation) {
 		case 's':
-			utils::time_it(test_sum2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2);
+			dump_and_time(test_sum2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2);
 			break;
 		case 'a':
-			utils::time_it(test_average2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2);
+			dump_and_time(test_average2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2);
 			break;
 		case 'v':
-			utils::time_it(test_average2_fast, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2, false);
+			dump_and_time(test_average2_fast, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2, false);
 			break;
 		case 'm':
-			utils::time_it(test_mode, party, input_size, agg_cols, n_categories_1, n_categories_2);
+			dump_and_time(test_mode, party, input_size, agg_cols, n_categories_1, n_categories_2);
 			break;
 		case 'f':
-			utils::time_it(test_freq, party, input_size, agg_cols, n_categories_1, n_categories_2);
+			dump_and_time(test_freq, party, input_size, agg_cols, n_categories_1, n_categories_2);
 			break;
 		case 'd':
-			utils::time_it(test_std2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2, 0);
+			dump_and_time(test_std2, party, input_size, agg_cols, value_col, n_categories_1, n_categories_2, 0);
 			break;
 		default:
 			cout << "Invalid aggregation type" << endl;
@@ -786,8 +822,12 @@ int main(int argc, char **argv) {
 	utils::set_directory(argv[argc - 1]);
 	
 	HighSpeedNetIO * io = new HighSpeedNetIO(ip, port, port + 1);
-	auto ctx = setup_semi_honest(io, party);
-	ctx->set_batch_size(1024*1024);
+	NetIO * ot_io = utils::get_ot_channel(ip, port + 2);
+	NetIO * pre_io = utils::get_precompute_channel(ip, port + 3);
+	SemiHonestParty<HighSpeedNetIO> * sh = setup_semi_honest(io, party, 1024*16, utils::get_garble_scheme(), utils::get_ot_scheme(), 1, &ot_io,
+		utils::get_ot_store(party, port));
+	utils::start_precompute(sh, pre_io);
+	utils::start_profile(io);
 
 	cout << "Party: " << (party == ALICE ? "Alice" : "Bob") << endl;
 	cout << "Input size: " << input_size << endl;
@@ -800,8 +840,12 @@ int main(int argc, char **argv) {
 
 	test_xtabs(party, input_size, aggregation[0], n_categories_1, n_categories_2, agg_cols, value_col);
 
+	utils::finish_profile(party);
+	utils::print_gate_stats();
 	finalize_semi_honest();
-	utils::print_io_stats(*io, party);
+	utils::print_io_stats(*io, party, {ot_io, pre_io});
+	delete pre_io;
+	delete ot_io;
 	delete io;
 
     return 0;
@@ -7,6 +7,7 @@
 
 #include "emp/emp-sh2pc/emp-sh2pc/emp-sh2pc.h"
 #include <chrono>
+#include <initializer_list>
 #include <iostream>
 #include <utility>
 using namespace std;
@@ -15,6 +16,30 @@ const int BITSIZE = 32;
 
 namespace utils {
 
+    /**
+     * @brief If EMP_DUMP_CIRCUIT is set, captures the circuit of a function without running the protocol and
+     * Alice writes it to that file in Bristol format, e.g. for the optimize_circuit tool. Output is silenced.
+     */
+    template <typename Func, typename... Args>
+    void dump_circuit(Func&& func, Args&&... args) {
+        const char* filename = getenv("EMP_DUMP_CIRCUIT");
+        if (filename == nullptr) {
+            return;
+        }
+        int party = ProtocolExecution::prot_exec->cur_party;
+        CapturedCircuit circuit;
+        CircuitCapture capture;
+        streambuf* out = cout.rdbuf(nullptr);
+        capture.start(&circuit);
+        func(std::forward<Args>(args)...);
+        capture.finish();
+        cout.rdbuf(out);
+        if (party == ALICE) {
+            circuit.to_bristol().to_bristol(filename);
+        }
+        cout << "Circuit with " << circuit.num_and << " AND gates dumped to " << filename << endl;
+    }
+
     /**
      * @brief Measures the execution time of a function. Default arguments will need to be passed explicitly.
      */
@@ -35,11 +60,17 @@ namespace utils {
     }
 
     /**
-     * @brief Prints the information about communication
+     * @brief Prints the information about communication, including the OT channels that are not nullptr
      */
-    void print_io_stats(const HighSpeedNetIO& io, int party) {
+    void print_io_stats(const HighSpeedNetIO& io, int party, std::initializer_list<const NetIO*> ot_ios = {}) {
         double sent_mb = (double) io.schannel->counter / (1024 * 1024.0);
         double recv_mb = (double) io.rchannel->counter / (1024 * 1024.0);
+        for (const NetIO* ot_io : ot_ios) {
+            if (ot_io != nullptr) {
+                sent_mb += ot_io->counter / (1024 * 1024.0);
+                recv_mb += ot_io->recv_counter / (1024 * 1024.0);
+            }
+        }
 
         /* After switching to either sending or receiving (marking the end of one round of communication) a flush is added to the respective channel, meaning
         we can track communication rounds with the help of number of flushes. We still add one more because the last round is not counted properly as the respective channel (and the other one)
@@ -56,6 +87,130 @@ namespace utils {
 
     }
 
+    GateProfile& get_profile() {
+        static GateProfile profile;
+        return profile;
+    }
+
+    /**
+     * @brief If EMP_PROFILE is set, profiles the gates, communication and time of every GateScope region until
+     * finish_profile. Call after setup_semi_honest.
+     */
+    void start_profile(const HighSpeedNetIO* io) {
+        if (getenv("EMP_PROFILE") != nullptr) {
+            get_profile().start(io);
+        }
+    }
+
+    /**
+     * @brief Prints the regions of the profile and Alice writes them as JSON to the EMP_PROFILE file, call before
+     * finalize_semi_honest
+     */
+    void finish_profile(int party) {
+        const char* filename = getenv("EMP_PROFILE");
+        if (filename == nullptr) {
+            return;
+        }
+        GateProfile& profile = get_profile();
+        profile.finish();
+        profile.print();
+        if (party == ALICE) {
+            ofstream out(filename);
+            out << profile.to_json() << endl;
+        }
+    }
+
+    /**
+     * @brief Garbling scheme selected by the EMP_GARBLING environment variable (halfgates or threehalves)
+     */
+    GarbleScheme get_garble_scheme() {
+        const char* scheme = getenv("EMP_GARBLING");
+        if (scheme == nullptr || string(scheme) == "halfgates") {
+            return HALF_GATES;
+        }
+        if (string(scheme) == "threehalves") {
+            return THREE_HALVES;
+        }
+        cerr << "Unknown garbling scheme: " << scheme << endl;
+        exit(1);
+    }
+
+    /**
+     * @brief COT extension for Bob's inputs selected by the EMP_OT environment variable (iknp or ferret)
+     */
+    OTScheme get_ot_scheme() {
+        const char* scheme = getenv("EMP_OT");
+        if (scheme == nullptr || string(scheme) == "iknp") {
+            return IKNP_OT;
+        }
+        if (string(scheme) == "ferret") {
+            return FERRET_OT;
+        }
+        cerr << "Unknown OT scheme: " << scheme << endl;
+        exit(1);
+    }
+
+    /**
+     * @brief Channel for Ferret, which needs a NetIO as it does not flush HighSpeedNetIO symmetrically. nullptr unless
+     * EMP_OT is ferret.
+     */
+    NetIO* get_ot_channel(const char* ip, int port) {
+        if (get_ot_scheme() != FERRET_OT) {
+            return nullptr;
+        }
+        return new NetIO(ip, port, true);
+    }
+
+    /**
+     * @brief File in the EMP_OT_STORE directory with the OT state kept for the peer on port, empty if EMP_OT_STORE is
+     * not set
+     */
+    string get_ot_store(int party, int port) {
+        const char* dir = getenv("EMP_OT_STORE");
+        if (dir == nullptr || string(dir).empty()) {
+            return "";
+        }
+        return string(dir) + "/" + (party == ALICE ? "alice" : "bob") + "_" + to_string(port) + ".ots";
+    }
+
+    /**
+     * @brief Whether the EMP_PRECOMPUTE environment variable is 1, to precompute the COTs for Bob's inputs in the
+     * background
+     */
+    bool get_precompute() {
+        const char* precompute = getenv("EMP_PRECOMPUTE");
+        return precompute != nullptr && string(precompute) == "1";
+    }
+
+    /**
+     * @brief Channel for the background COTs of IKNP, opened before setup_semi_honest as its last OT extension may
+     * wait for a flush. nullptr unless precomputing with IKNP.
+     */
+    NetIO* get_precompute_channel(const char* ip, int port) {
+        if (!get_precompute() || get_ot_scheme() == FERRET_OT) {
+            return nullptr;
+        }
+        return new NetIO(ip, port, true);
+    }
+
+    /**
+     * @brief Starts precomputing COTs in the background if EMP_PRECOMPUTE is 1, on the channel for IKNP or on
+     * Ferret's own channel
+     */
+    template <typename IO>
+    void start_precompute(SemiHonestParty<IO>* sh, NetIO* channel) {
+        if (get_precompute()) {
+            sh->precompute(channel);
+        }
+    }
+
+    /**
+     * @brief Prints the number of garbled AND gates, call before finalize_semi_honest
+     */
+    void print_gate_stats() {
+        cout << "AND gates: " << CircuitExecution::circ_exec->num_and() << endl;
+    }
+
     const std::string& get_directory() {
         static std::string directory;
         return directory;
@@ -80,24 +235,27 @@ namespace utils {
         return infile;
     }
 
+    /**
+     * @brief Reads input_size values of the party and feeds both columns, each in a single call
+     */
     void initialize_values(int party, int other_party, Integer * party_values, Integer * other_party_values, int input_size, ifstream & infile, string & line) {
+        vector<int64_t> values(input_size);
         for (int i = 0; i < input_size; ++i) {
             getline(infile, line);
-            party_values[i] = Integer(BITSIZE, stoi(line), party);
-        }
-        for (int i = 0; i < input_size; ++i) {
-            other_party_values[i] = Integer(BITSIZE, 0, other_party);
+            values[i] = stoi(line);
         }
+        feed_batch(party_values, input_size, BITSIZE, values.data(), party);
+        feed_batch(other_party_values, input_size, BITSIZE, nullptr, other_party);
     }
 
     void initialize_values(int party, int other_party, Float * party_values, Float * other_party_values, int input_size, ifstream & infile, string & line) {
+        vector<float> values(input_size);
         for (int i = 0; i < input_size; ++i) {
             getline(infile, line);
-            party_values[i] = Float(stof(line), party);
-        }
-        for (int i = 0; i < input_size; ++i) {
-            other_party_values[i] = Float(0, other_party);
+            values[i] = stof(line);
         }
+        feed_batch(party_values, input_size, values.data(), party);
+        feed_batch(other_party_values, input_size, nullptr, other_party);
     }
 
     template <typename T>